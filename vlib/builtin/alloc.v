@@ -0,0 +1,447 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+Allocators. `malloc()`, `calloc()`, `v_realloc()` and `free()` use the one
+a program was built with, `v -allocator=libc|pool|arena`:
+
+libc   C's malloc (the default).
+
+pool   Blocks of up to 32 KB are rounded up to one of 24 size classes, and
+       freed blocks are kept in a list per class to be reused. Each thread
+       has its own lists, so most calls take no lock; they are refilled from
+       and flushed to lists shared by all threads a batch at a time. Larger
+       blocks come from C's malloc.
+
+arena  Blocks are cut one after another from 1 MB chunks of each thread,
+       and `free()` does nothing. For programs that allocate a lot and
+       don't run for long, like the compiler.
+
+The blocks of the pool and arena allocators start with a `BlockHeader`, so
+`free()` and `v_realloc()` know what they are. Memory from C functions
+(e.g. `strdup()`) can't be given to them then.
+
+`Arena` can also be used on its own, to free many blocks at once.
+*/
+
+const (
+	allocator_libc  = 0
+	allocator_pool  = 1
+	allocator_arena = 2
+)
+
+// Set by `init()` in the generated C code, before the first allocation
+__global v_allocator int
+
+struct BlockHeader {
+mut:
+	size  int // what fits in the block
+	class int // the size class in the pool, or `block_big` or `block_arena`
+}
+
+const (
+	block_header_size = 16 // keeps the blocks 16 byte aligned
+	pool_classes      = 24
+	block_big         = 24 // the classes after those of the pool
+	block_arena       = 25
+	pool_max_size     = 32768
+	arena_chunk_size  = 1048576
+)
+
+// The free blocks of each size class, of a thread or shared by all of them,
+// what is left of the arena chunk of a thread, its `print()` buffer, and
+// its free task blocks and worker for `go`
+struct AllocLists {
+mut:
+	free       &byteptr // linked through their first 8 bytes
+	nr_free    &int
+	arena_pos  byteptr
+	arena_left int
+	out        &PrintBuf // see print.v
+	tasks      &GoTask // see sched.v
+	nr_tasks   int
+	worker     voidptr // a `&GoWorker` on the workers of the pool
+}
+
+__global alloc_shared &AllocLists
+__global alloc_ready bool
+
+fn new_alloc_lists() &AllocLists {
+	mut l := &AllocLists(C.calloc(1, sizeof(AllocLists)))
+	l.free = &byteptr(C.calloc(pool_classes, sizeof(byteptr)))
+	l.nr_free = &int(C.calloc(pool_classes, sizeof(int)))
+	return l
+}
+
+// The first block is allocated before any thread is started, so this needs
+// no lock
+fn alloc_init() {
+	alloc_sync.init(alloc_thread_exit)
+	alloc_shared = new_alloc_lists()
+	alloc_ready = true
+}
+
+fn thread_alloc_lists() &AllocLists {
+	if !alloc_ready {
+		alloc_init()
+	}
+	mut l := &AllocLists(alloc_sync.thread_data())
+	if isnil(l) {
+		l = new_alloc_lists()
+		alloc_sync.set_thread_data(l)
+	}
+	return l
+}
+
+// Flushes the `print()` buffer of a thread that exits, and gives its free
+// blocks to the other threads
+fn alloc_thread_exit(l &AllocLists) {
+	if !isnil(l.out) {
+		print_buf_exit(l.out)
+	}
+	go_free_cache(l)
+	alloc_sync.lock()
+	for c := 0; c < pool_classes; c++ {
+		if l.nr_free[c] > 0 {
+			move_blocks(l, alloc_shared, c, l.nr_free[c])
+		}
+	}
+	alloc_sync.unlock()
+	C.free(l.free)
+	C.free(l.nr_free)
+	C.free(l)
+}
+
+fn next_block(b byteptr) byteptr {
+	link := &byteptr(b)
+	return link[0]
+}
+
+fn set_next_block(b byteptr, next byteptr) {
+	mut link := &byteptr(b)
+	link[0] = next
+}
+
+// Moves the first `n` free blocks of class `c` from `from` to `to`
+fn move_blocks(from, to &AllocLists, c, n int) {
+	mut from_free := from.free
+	mut to_free := to.free
+	mut from_nr := from.nr_free
+	mut to_nr := to.nr_free
+	first := from_free[c]
+	mut last := first
+	for i := 1; i < n; i++ {
+		last = next_block(last)
+	}
+	from_free[c] = next_block(last)
+	set_next_block(last, to_free[c])
+	to_free[c] = first
+	from_nr[c] -= n
+	to_nr[c] += n
+}
+
+// 16 to 128 bytes in steps of 16, then 192, 256, 384, 512, ... 32768
+fn pool_class_size(c int) int {
+	if c < 8 {
+		return (c + 1) * 16
+	}
+	base := 128 << ((c - 8) / 2)
+	if c % 2 == 0 {
+		return base + base / 2
+	}
+	return base * 2
+}
+
+// The smallest size class `n` bytes fit in
+fn pool_class(n int) int {
+	if n <= 128 {
+		if n <= 16 {
+			return 0
+		}
+		return (n + 15) / 16 - 1
+	}
+	mut b := 0
+	for (256 << b) < n {
+		b++
+	}
+	if n <= (128 << b) + (64 << b) {
+		return 8 + 2 * b
+	}
+	return 9 + 2 * b
+}
+
+// How many blocks of class `c` are moved from or to the shared lists at once
+fn pool_batch(c int) int {
+	n := 32 * 1024 / (pool_class_size(c) + block_header_size)
+	if n < 8 {
+		return 8
+	}
+	if n > 128 {
+		return 128
+	}
+	return n
+}
+
+fn pool_alloc(n int) byteptr {
+	if n > pool_max_size {
+		return big_alloc(n)
+	}
+	c := pool_class(n)
+	l := thread_alloc_lists()
+	mut free := l.free
+	if free[c] == 0 {
+		pool_refill(l, c)
+	}
+	b := free[c]
+	free[c] = next_block(b)
+	mut nr := l.nr_free
+	nr[c]--
+	return b
+}
+
+// Takes a batch of free blocks of class `c` from the shared lists, or cuts
+// new ones if there are none
+fn pool_refill(l &AllocLists, c int) {
+	batch := pool_batch(c)
+	alloc_sync.lock()
+	mut n := alloc_shared.nr_free[c]
+	if n > 0 {
+		if n > batch {
+			n = batch
+		}
+		move_blocks(alloc_shared, l, c, n)
+		alloc_sync.unlock()
+		return
+	}
+	alloc_sync.unlock()
+	size := pool_class_size(c)
+	step := size + block_header_size
+	mem := &byte(C.malloc(batch * step))
+	if isnil(mem) {
+		panic('malloc(${batch * step}) failed')
+	}
+	mut free := l.free
+	// Linked in address order
+	for i := batch - 1; i >= 0; i-- {
+		start := mem + i * step
+		mut h := &BlockHeader(start)
+		h.size = size
+		h.class = c
+		b := start + block_header_size
+		set_next_block(b, free[c])
+		free[c] = b
+	}
+	mut nr := l.nr_free
+	nr[c] += batch
+}
+
+fn pool_free(b byteptr, c int) {
+	l := thread_alloc_lists()
+	mut free := l.free
+	mut nr := l.nr_free
+	set_next_block(b, free[c])
+	free[c] = b
+	nr[c]++
+	batch := pool_batch(c)
+	if nr[c] > 2 * batch {
+		alloc_sync.lock()
+		move_blocks(l, alloc_shared, c, batch)
+		alloc_sync.unlock()
+	}
+}
+
+fn big_alloc(n int) byteptr {
+	mem := &byte(C.malloc(n + block_header_size))
+	if isnil(mem) {
+		panic('malloc($n) failed')
+	}
+	mut h := &BlockHeader(mem)
+	h.size = n
+	h.class = block_big
+	return mem + block_header_size
+}
+
+fn arena_alloc(n int) byteptr {
+	size := (n + 15) / 16 * 16 + block_header_size
+	mut l := thread_alloc_lists()
+	if size > l.arena_left {
+		// The rest of the chunk is lost
+		mut chunk := arena_chunk_size
+		if size > chunk {
+			chunk = size
+		}
+		l.arena_pos = &byte(C.malloc(chunk))
+		if isnil(l.arena_pos) {
+			panic('malloc($chunk) failed')
+		}
+		l.arena_left = chunk
+	}
+	mut h := &BlockHeader(l.arena_pos)
+	h.size = size - block_header_size
+	h.class = block_arena
+	b := l.arena_pos + block_header_size
+	l.arena_pos += size
+	l.arena_left -= size
+	return b
+}
+
+// Allocators other than C's
+fn alloc_block(n int) byteptr {
+	if v_allocator == allocator_arena {
+		return arena_alloc(n)
+	}
+	return pool_alloc(n)
+}
+
+fn free_block(b byteptr) {
+	h := &BlockHeader(b - block_header_size)
+	if h.class < pool_classes {
+		pool_free(b, h.class)
+	}
+	else if h.class == block_big {
+		C.free(h)
+	}
+	// Arena blocks are never freed
+}
+
+fn realloc_block(b byteptr, n int) byteptr {
+	if isnil(b) {
+		return alloc_block(n)
+	}
+	mut h := &BlockHeader(b - block_header_size)
+	if n <= h.size {
+		return b
+	}
+	if h.class == block_big {
+		mem := &byte(C.realloc(h, n + block_header_size))
+		if isnil(mem) {
+			panic('realloc($n) failed')
+		}
+		h = &BlockHeader(mem)
+		h.size = n
+		return mem + block_header_size
+	}
+	if h.class == block_arena {
+		// The last block of the chunk grows in place
+		mut l := thread_alloc_lists()
+		grow := (n + 15) / 16 * 16 - h.size
+		if b + h.size == l.arena_pos && grow <= l.arena_left {
+			l.arena_pos += grow
+			l.arena_left -= grow
+			h.size += grow
+			return b
+		}
+	}
+	res := alloc_block(n)
+	C.memcpy(res, b, h.size)
+	free_block(b)
+	return res
+}
+
+// ===== Arena =====
+
+// A group of blocks that are freed all at once:
+//
+//	mut a := new_arena(64 * 1024)
+//	defer { a.free() }
+//	buf := a.alloc(100)
+//
+// Its blocks must not be given to `free()` or `v_realloc()`.
+struct Arena {
+	chunk_size int
+mut:
+	chunks     byteptr // each starts with an `ArenaChunk`
+	cur        byteptr // the chunk blocks are cut from
+	pos        int // in `cur`
+	end        int
+}
+
+struct ArenaChunk {
+mut:
+	next byteptr
+	size int
+}
+
+// Blocks are cut from chunks of `chunk_size` bytes, or larger for larger
+// blocks
+pub fn new_arena(chunk_size int) &Arena {
+	return &Arena{
+		chunk_size: chunk_size
+		chunks: 0
+		cur: 0
+	}
+}
+
+// `n` bytes, 16 byte aligned and not zeroed. Like `malloc(0)`, `alloc(0)`
+// returns a block of its own.
+pub fn (a mut Arena) alloc(n int) byteptr {
+	if n < 0 {
+		panic('Arena.alloc(<0)')
+	}
+	mut size := (n + 15) / 16 * 16
+	if size == 0 {
+		size = 16
+	}
+	if a.pos + size > a.end {
+		a.add_chunk(size)
+	}
+	b := a.cur + a.pos
+	a.pos += size
+	return b
+}
+
+fn (a mut Arena) add_chunk(size int) {
+	mut chunk_size := a.chunk_size
+	if size + block_header_size > chunk_size {
+		chunk_size = size + block_header_size
+	}
+	mem := &byte(C.malloc(chunk_size))
+	if isnil(mem) {
+		panic('malloc($chunk_size) failed')
+	}
+	mut chunk := &ArenaChunk(mem)
+	chunk.next = 0
+	chunk.size = chunk_size
+	if isnil(a.cur) {
+		a.chunks = mem
+	}
+	else {
+		mut cur := &ArenaChunk(a.cur)
+		cur.next = mem
+	}
+	a.cur = mem
+	a.pos = block_header_size
+	a.end = chunk_size
+}
+
+fn free_arena_chunks(first byteptr) {
+	mut mem := first
+	for !isnil(mem) {
+		chunk := &ArenaChunk(mem)
+		next := chunk.next
+		C.free(mem)
+		mem = next
+	}
+}
+
+// Frees all the blocks. The first chunk is kept for the next ones.
+pub fn (a mut Arena) reset() {
+	if isnil(a.chunks) {
+		return
+	}
+	mut first := &ArenaChunk(a.chunks)
+	free_arena_chunks(first.next)
+	first.next = 0
+	a.cur = a.chunks
+	a.pos = block_header_size
+	a.end = first.size
+}
+
+// Frees all the blocks and the arena
+pub fn (a mut Arena) free() {
+	free_arena_chunks(a.chunks)
+	free(a)
+}
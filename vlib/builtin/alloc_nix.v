@@ -0,0 +1,41 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+struct C.pthread_mutex_t {}
+struct C.pthread_key_t {}
+// For the parallel and sync modules, C structs can only be declared once
+struct C.pthread_cond_t {}
+
+// The lock of the shared lists of the pool allocator, and the key of the
+// state of each thread
+struct AllocSync {
+	mutex C.pthread_mutex_t
+	key   C.pthread_key_t
+}
+
+__global alloc_sync AllocSync
+
+// `on_thread_exit(data)` is called when a thread that has data exits
+fn (s mut AllocSync) init(on_thread_exit voidptr) {
+	C.pthread_mutex_init(&s.mutex, 0)
+	C.pthread_key_create(&s.key, on_thread_exit)
+}
+
+fn (s &AllocSync) lock() {
+	C.pthread_mutex_lock(&s.mutex)
+}
+
+fn (s &AllocSync) unlock() {
+	C.pthread_mutex_unlock(&s.mutex)
+}
+
+fn (s &AllocSync) thread_data() voidptr {
+	return C.pthread_getspecific(s.key)
+}
+
+fn (s &AllocSync) set_thread_data(data voidptr) {
+	C.pthread_setspecific(s.key, data)
+}
@@ -0,0 +1,230 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+The allocation profiler of `v -profile_alloc`. The compiler stores the number
+of each statement of the program in `v_alloc_site` before it runs, and passes
+their `file:line` to `alloc_prof_init()`. `malloc()`, `calloc()`,
+`v_realloc()` and `free()` then count the allocations, their bytes and the
+bytes still in use of each statement, and the peak of the heap.
+
+The statements of builtin have no number, so what they allocate (strings,
+arrays, maps) is counted for the statement that called them. With threads,
+it can be counted for a statement another thread has just run.
+
+At exit, and on SIGUSR1 (`kill -USR1 <pid>`), a report of the statements
+that allocate the most bytes and the most often is written to
+alloc_profile.txt. The signal handler only sets a flag, the report is
+written by the next allocation or free, of any thread.
+
+The counters are updated with atomic adds, so that threads that allocate
+don't wait for each other.
+
+Each block starts with an `AllocProfHeader`, on top of the one of the pool
+and arena allocators.
+*/
+
+const (
+	alloc_prof_top = 30 // statements in each list of the report
+)
+
+// Set by `init()` in the generated C code, before the first allocation
+__global v_alloc_prof bool
+// The statement that is running, 0 before the first one
+__global v_alloc_site int
+
+// Set by the SIGUSR1 handler. V has no volatile types, it's only used
+// through these macros.
+__global alloc_prof_signal C.AllocProfSignal
+
+#define AllocProfSignal volatile sig_atomic_t
+#define ALLOC_PROF_SIGNAL() alloc_prof_signal
+#define SET_ALLOC_PROF_SIGNAL(v) (alloc_prof_signal = (v))
+
+fn C.ALLOC_PROF_SIGNAL() int
+fn C.SET_ALLOC_PROF_SIGNAL(int)
+
+struct AllocProfHeader {
+mut:
+	size int
+	site int
+}
+
+struct AllocProf {
+mut:
+	names    &byteptr // "file:line" of each statement
+	nr_sites int
+	counts   &i64 // of each statement
+	bytes    &i64
+	live     &i64
+	live_bytes    i64 // of the whole program
+	peak_bytes    i64
+}
+
+__global alloc_prof AllocProf
+
+fn alloc_prof_init(nr_sites int, names voidptr) {
+	if !alloc_ready {
+		alloc_init()
+	}
+	alloc_prof.names = &byteptr(names)
+	alloc_prof.nr_sites = nr_sites
+	alloc_prof.counts = &i64(C.calloc(nr_sites, sizeof(i64)))
+	alloc_prof.bytes = &i64(C.calloc(nr_sites, sizeof(i64)))
+	alloc_prof.live = &i64(C.calloc(nr_sites, sizeof(i64)))
+	v_alloc_prof = true
+	C.atexit(alloc_prof_report)
+	$if !windows {
+		C.signal(C.SIGUSR1, alloc_prof_on_signal)
+	}
+}
+
+fn (p mut AllocProf) add(site, n int) {
+	go_add_i64(&p.counts[site], i64(1))
+	go_add_i64(&p.bytes[site], i64(n))
+	go_add_i64(&p.live[site], i64(n))
+	live_bytes := go_add_i64(&p.live_bytes, i64(n)) + i64(n)
+	for {
+		peak := go_load_i64(&p.peak_bytes)
+		if live_bytes <= peak || go_cas_i64(&p.peak_bytes, peak, live_bytes) {
+			break
+		}
+	}
+}
+
+fn (p mut AllocProf) remove(site, n int) {
+	go_add_i64(&p.live[site], i64(-n))
+	go_add_i64(&p.live_bytes, i64(-n))
+}
+
+fn alloc_prof_site() int {
+	site := v_alloc_site
+	if site < 0 || site >= alloc_prof.nr_sites {
+		return 0
+	}
+	return site
+}
+
+fn prof_alloc(n int) byteptr {
+	if C.ALLOC_PROF_SIGNAL() != 0 {
+		alloc_prof_signaled()
+	}
+	mem := raw_malloc(n + block_header_size)
+	mut h := &AllocProfHeader(mem)
+	h.size = n
+	h.site = alloc_prof_site()
+	alloc_prof.add(h.site, n)
+	return mem + block_header_size
+}
+
+fn prof_free(ptr voidptr) {
+	if C.ALLOC_PROF_SIGNAL() != 0 {
+		alloc_prof_signaled()
+	}
+	if isnil(ptr) {
+		return
+	}
+	h := &AllocProfHeader(&byte(ptr) - block_header_size)
+	alloc_prof.remove(h.site, h.size)
+	raw_free(h)
+}
+
+// A resized block counts as freed and allocated again by the statement that
+// resizes it
+fn prof_realloc(ptr voidptr, n int) byteptr {
+	if isnil(ptr) {
+		return prof_alloc(n)
+	}
+	old := &AllocProfHeader(&byte(ptr) - block_header_size)
+	alloc_prof.remove(old.site, old.size)
+	mem := raw_realloc(old, n + block_header_size)
+	mut h := &AllocProfHeader(mem)
+	h.size = n
+	h.site = alloc_prof_site()
+	alloc_prof.add(h.site, n)
+	return mem + block_header_size
+}
+
+// ===== Report =====
+
+fn (p &AllocProf) key(site int, by_bytes bool) i64 {
+	if by_bytes {
+		return p.bytes[site]
+	}
+	return p.counts[site]
+}
+
+// Writes the statements with the most bytes, or allocations, to `f`. It
+// allocates nothing, so that it can run at any time.
+fn (p &AllocProf) write_top(f voidptr, by_bytes bool) {
+	mut top := [30]int // alloc_prof_top
+	mut n := 0
+	for site := 0; site < p.nr_sites; site++ {
+		key := p.key(site, by_bytes)
+		if key == 0 {
+			continue
+		}
+		mut i := n
+		if n < alloc_prof_top {
+			n++
+		}
+		else if key <= p.key(top[n - 1], by_bytes) {
+			continue
+		}
+		else {
+			i = n - 1
+		}
+		for i > 0 && p.key(top[i - 1], by_bytes) < key {
+			top[i] = top[i - 1]
+			i--
+		}
+		top[i] = site
+	}
+	C.fprintf(f, '%14s %12s %14s  %s\n', 'bytes', 'allocations', 'live bytes', 'statement')
+	for i := 0; i < n; i++ {
+		site := top[i]
+		C.fprintf(f, '%14lld %12lld %14lld  %s\n', p.bytes[site], p.counts[site], p.live[site],
+			p.names[site])
+	}
+}
+
+fn alloc_prof_report() {
+	f := C.fopen('alloc_profile.txt', 'w')
+	if isnil(f) {
+		C.fprintf(stderr, 'failed to write alloc_profile.txt\n')
+		return
+	}
+	p := &alloc_prof
+	mut nr_allocs := i64(0)
+	mut total_bytes := i64(0)
+	for site := 0; site < p.nr_sites; site++ {
+		nr_allocs += p.counts[site]
+		total_bytes += p.bytes[site]
+	}
+	C.fprintf(f, '%lld allocations, %lld bytes, peak heap %lld bytes, %lld bytes in use\n',
+		nr_allocs, total_bytes, p.peak_bytes, p.live_bytes)
+	C.fprintf(f, '\nBy bytes:\n')
+	p.write_top(f, true)
+	C.fprintf(f, '\nBy allocations:\n')
+	p.write_top(f, false)
+	C.fclose(f)
+}
+
+// Writing the report isn't async-signal-safe, and the signal can come while
+// the counters are updated
+fn alloc_prof_on_signal(sig int) {
+	C.SET_ALLOC_PROF_SIGNAL(1)
+}
+
+// Only one thread writes the report for a signal
+fn alloc_prof_signaled() {
+	alloc_sync.lock()
+	if C.ALLOC_PROF_SIGNAL() != 0 {
+		C.SET_ALLOC_PROF_SIGNAL(0)
+		alloc_prof_report()
+	}
+	alloc_sync.unlock()
+}
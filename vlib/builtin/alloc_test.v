@@ -0,0 +1,62 @@
+fn test_realloc() {
+	mut p := malloc(10)
+	for i := 0; i < 10; i++ {
+		p[i] = byte(i)
+	}
+	p = v_realloc(p, 100000)
+	for i := 0; i < 10; i++ {
+		assert p[i] == byte(i)
+	}
+	p[99999] = 7
+	p = v_realloc(p, 5)
+	assert p[4] == 4
+	free(p)
+	q := v_realloc(0, 16)
+	assert q != 0
+	free(q)
+	free(0)
+}
+
+fn test_calloc() {
+	// Reuses freed memory with some allocators
+	mut p := malloc(1000)
+	C.memset(p, 0xff, 1000)
+	free(p)
+	p = calloc(1000)
+	for i := 0; i < 1000; i++ {
+		assert p[i] == 0
+	}
+	free(p)
+}
+
+fn test_arena() {
+	mut a := new_arena(1024)
+	mut blocks := []u64 // the addresses
+	for i := 0; i < 1000; i++ {
+		n := i % 100 + 1
+		b := a.alloc(n)
+		assert u64(b) % u64(16) == u64(0)
+		C.memset(b, i % 200, n)
+		blocks << u64(b)
+	}
+	// Larger than a chunk
+	big := a.alloc(10000)
+	C.memset(big, 1, 10000)
+	for i := 0; i < blocks.len; i++ {
+		b := &byte(blocks[i])
+		assert b[0] == byte(i % 200)
+		assert b[i % 100] == byte(i % 200)
+	}
+	a.reset()
+	b := a.alloc(100)
+	assert u64(b) == blocks[0]
+	a.free()
+}
+
+fn test_arena_alloc_zero() {
+	mut a := new_arena(1024)
+	b := a.alloc(0)
+	assert !isnil(b)
+	assert a.alloc(0) != b
+	a.free()
+}
@@ -0,0 +1,40 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+struct C.SRWLOCK {}
+
+// The lock of the shared lists of the pool allocator, and the key of the
+// state of each thread
+struct AllocSync {
+	mutex C.SRWLOCK
+mut:
+	key   u32
+}
+
+__global alloc_sync AllocSync
+
+// There are no thread exit callbacks for TLS slots, the free blocks of a
+// thread that exits aren't reused
+fn (s mut AllocSync) init(on_thread_exit voidptr) {
+	C.InitializeSRWLock(&s.mutex)
+	s.key = C.TlsAlloc()
+}
+
+fn (s &AllocSync) lock() {
+	C.AcquireSRWLockExclusive(&s.mutex)
+}
+
+fn (s &AllocSync) unlock() {
+	C.ReleaseSRWLockExclusive(&s.mutex)
+}
+
+fn (s &AllocSync) thread_data() voidptr {
+	return C.TlsGetValue(s.key)
+}
+
+fn (s &AllocSync) set_thread_data(data voidptr) {
+	C.TlsSetValue(s.key, data)
+}
@@ -14,15 +14,24 @@ pub:
 	len          int
 	cap          int
 	element_size int
+	is_slice     bool // `data` points into another array, see `slice()`
 }
 
+const (
+	// The capacity of an array after its first push. Empty arrays have no
+	// memory at all.
+	array_min_cap = 4
+)
+
 // Private function, used by V (`nums := []int`)
 fn new_array(mylen, cap, elm_size int) array {
-	arr := array {
+	mut arr := array {
 		len: mylen
 		cap: cap
 		element_size: elm_size
-		data: calloc(cap * elm_size)
+	}
+	if cap > 0 {
+		arr.data = calloc(cap * elm_size)
 	}
 	return arr
 }
@@ -36,6 +45,9 @@ pub fn make(len, cap, elm_size int) array {
 
 // Private function, used by V (`nums := [1, 2, 3]`)
 fn new_array_from_c_array(len, cap, elm_size int, c_array voidptr) array {
+	if cap == 0 {
+		return new_array(0, 0, elm_size)
+	}
 	arr := array {
 		len: len
 		cap: cap
@@ -86,17 +98,13 @@ pub fn (a array) repeat(nr_repeats int) array {
 	return arr
 }
 
-pub fn (a mut array) sort_with_compare(compare voidptr) {
-	C.qsort(a.data, a.len, a.element_size, compare)
-}
-
 pub fn (a mut array) insert(i int, val voidptr) {
 	if i >= a.len {
 		panic('array.insert: index larger than length')
 	}
 	a.push(val)
 	size := a.element_size
-	C.memmove(a.data + (i + 1) * size, a.data + i * size, (a.len - i) * size)
+	C.memmove(a.data + (i + 1) * size, a.data + i * size, (a.len - i - 1) * size)
 	a.set(i, val)
 }
 
@@ -106,9 +114,8 @@ pub fn (a mut array) prepend(val voidptr) {
 
 pub fn (a mut array) delete(idx int) {
 	size := a.element_size
-	C.memmove(a.data + idx * size, a.data + (idx + 1) * size, (a.len - idx) * size)
+	C.memmove(a.data + idx * size, a.data + (idx + 1) * size, (a.len - idx - 1) * size)
 	a.len--
-	a.cap--
 }
 
 fn (a array) get(i int) voidptr {
@@ -146,6 +153,9 @@ pub fn (s array) right(n int) array {
 	return s.slice(n, s.len)
 }
 
+// slice returns a view into the elements of `s`, without copying them.
+// Growing it (with `<<`) copies it first, use `clone()` to get a copy
+// that outlives `s`.
 pub fn (s array) slice(start, _end int) array {
 	mut end := _end
 	if start > end {
@@ -163,7 +173,7 @@ pub fn (s array) slice(start, _end int) array {
 		data: s.data + start * s.element_size
 		len: l
 		cap: l
-		//is_slice: true
+		is_slice: true
 	}
 	return res
 }
@@ -176,46 +186,90 @@ fn (a mut array) set(idx int, val voidptr) {
 }
 
 fn (arr mut array) push(val voidptr) {
-	if arr.len >= arr.cap - 1 {
-		cap := (arr.len + 1) * 2
-		// println('_push: realloc, new cap=$cap')
-		if arr.cap == 0 {
-			arr.data = calloc(cap * arr.element_size)
+	if arr.len >= arr.cap {
+		if arr.cap < array_min_cap {
+			arr.grow(array_min_cap)
 		}
 		else {
-			arr.data = C.realloc(arr.data, cap * arr.element_size)
+			arr.grow(arr.cap * 2)
 		}
-		arr.cap = cap
 	}
 	C.memcpy(arr.data + arr.element_size * arr.len, val, arr.element_size)
 	arr.len++
 }
 
+// A slice gets its own copy of the elements, it can't realloc the
+// memory of the array it's in
+fn (arr mut array) grow(cap int) {
+	// println('_push: realloc, new cap=$cap')
+	if arr.cap == 0 {
+		arr.data = calloc(cap * arr.element_size)
+		arr.is_slice = false
+	}
+	else if arr.is_slice {
+		data := calloc(cap * arr.element_size)
+		C.memcpy(data, arr.data, arr.len * arr.element_size)
+		arr.data = data
+		arr.is_slice = false
+	}
+	else {
+		arr.data = v_realloc(arr.data, cap * arr.element_size)
+	}
+	arr.cap = cap
+}
+
 // `val` is array.data
 // TODO make private, right now it's used by strings.Builder
 pub fn (arr mut array) push_many(val voidptr, size int) {
-	if arr.len >= arr.cap - size {
-		cap := (arr.len + size) * 2
-		// println('_push: realloc, new cap=$cap')
-		if arr.cap == 0 {
-			arr.data = calloc(cap * arr.element_size)
-		}
-		else {
-			arr.data = C.realloc(arr.data, cap * arr.element_size)
-		}
-		arr.cap = cap
+	if arr.len + size > arr.cap {
+		arr.reserve(size)
 	}
 	C.memcpy(arr.data + arr.element_size * arr.len, val, arr.element_size * size)
 	arr.len += size
 }
 
-pub fn (a array) reverse() array {
-	arr := array {
-		len: a.len
-		cap: a.cap
-		element_size: a.element_size
-		data: calloc(a.cap * a.element_size)
+// Makes room for `n` more elements. The capacity at least doubles, so that
+// many small pushes take linear time.
+pub fn (arr mut array) reserve(n int) {
+	if arr.len + n <= arr.cap {
+		return
+	}
+	mut cap := arr.cap * 2
+	if cap < arr.len + n {
+		cap = arr.len + n
+	}
+	arr.grow(cap)
+}
+
+// Drops the elements from `n` on, and keeps the capacity
+pub fn (arr mut array) truncate(n int) {
+	if n < arr.len {
+		arr.len = n
 	}
+}
+
+// Drops all the elements, and keeps the capacity for new ones
+pub fn (arr mut array) clear() {
+	arr.len = 0
+}
+
+// Gives back the memory past the last element
+pub fn (arr mut array) shrink_to_fit() {
+	if arr.is_slice || arr.cap == arr.len {
+		return
+	}
+	if arr.len == 0 {
+		free(arr.data)
+		arr.data = 0
+	}
+	else {
+		arr.data = v_realloc(arr.data, arr.len * arr.element_size)
+	}
+	arr.cap = arr.len
+}
+
+pub fn (a array) reverse() array {
+	arr := new_array(a.len, a.len, a.element_size)
 	for i := 0; i < a.len; i++ {
 		C.memcpy(arr.data + i * arr.element_size, &a[a.len-1-i], arr.element_size)
 	}
@@ -223,22 +277,17 @@ pub fn (a array) reverse() array {
 }
 
 pub fn (a array) clone() array {
-	arr := array {
-		len: a.len
-		cap: a.cap
-		element_size: a.element_size
-		data: calloc(a.cap * a.element_size)
-	}
-	C.memcpy(arr.data, a.data, a.cap * a.element_size)
+	arr := new_array(a.len, a.len, a.element_size)
+	C.memcpy(arr.data, a.data, a.len * a.element_size)
 	return arr
 }
 
 //pub fn (a []int) free() {
 pub fn (a array) free() {
-	//if a.is_slice {
-		//return
-	//}
-	C.free(a.data)
+	if a.is_slice {
+		return
+	}
+	free(a.data)
 }
 
 // "[ 'a', 'b', 'c' ]"
@@ -277,20 +326,6 @@ pub fn copy(dst, src []byte) int {
 	return 0
 }
 
-fn compare_ints(a, b &int) int {
-	if a < b {
-		return -1
-	}
-	if a > b {
-		return 1
-	}
-	return 0
-}
-
-pub fn (a mut []int) sort() {
-	a.sort_with_compare(compare_ints)
-}
-
 // Looking for an array index based on value.
 // If there is, it will return the index and if not, it will return `-1`
 pub fn (a []string) index(v string) int {
@@ -136,6 +136,16 @@ fn test_slice() {
 	assert a.len == 4
 }
 
+fn test_push_to_slice() {
+	mut a := [1, 2, 3, 4]
+	mut b := a.slice(1, 3)
+	// The slice gets its own copy, `a` isn't overwritten
+	b << 7
+	b[0] = 9
+	assert b.str() == '[9, 3, 7]'
+	assert a.str() == '[1, 2, 3, 4]'
+}
+
 fn test_push_many() {
 	mut a := [1, 2, 3]
 	b := [4, 5, 6]
@@ -338,3 +348,175 @@ fn test_reduce() {
 	assert f == -6
 	assert g == -7
 }
+
+// An LCG, so the tests always sort the same numbers
+fn next_rand(seed u32) u32 {
+	return seed * u32(1103515245) + u32(12345)
+}
+
+fn test_sort_ints() {
+	mut a := [5, -1, 3, 2147483647, 0, -2147483647, 3]
+	a.sort()
+	assert a.str() == '[-2147483647, -1, 0, 3, 3, 5, 2147483647]'
+	// Enough for the radix sort, with random, sorted, reversed and equal numbers
+	mut seed := u32(1)
+	mut b := []int
+	mut sum := 0
+	for i := 0; i < 1000; i++ {
+		seed = next_rand(seed)
+		b << int(seed) % 1000
+		sum += b[i]
+	}
+	b.sort()
+	for i := 1; i < b.len; i++ {
+		assert b[i - 1] <= b[i]
+		sum -= b[i]
+	}
+	assert sum == b[0]
+	b.sort()
+	assert b[0] <= b[1]
+	mut c := []int
+	for i := 0; i < 1000; i++ {
+		c << 1000 - i % 500
+	}
+	c.sort()
+	assert c[0] == 501
+	assert c[1] == 501
+	assert c[999] == 1000
+	mut d := [7].repeat(100)
+	d.sort()
+	assert d[50] == 7
+}
+
+fn test_sort_u64_f64() {
+	mut a := [u64(3), 18446744073709551615, 0, u64(1) << u64(40), 2]
+	a.sort()
+	assert a[0] == 0
+	assert a[1] == 2
+	assert a[3] == u64(1) << u64(40)
+	assert a[4] == 18446744073709551615
+	mut seed := u32(2)
+	mut f := []f64
+	for i := 0; i < 500; i++ {
+		seed = next_rand(seed)
+		f << f64(int(seed)) / 1000.0
+	}
+	f << -0.5
+	f << 0.25
+	f.sort()
+	for i := 1; i < f.len; i++ {
+		assert f[i - 1] <= f[i]
+	}
+	mut g := [f64(2.5), -1.0, 0.0, -3.5, 1000000.0, -0.001]
+	g.sort()
+	assert g[0] == -3.5
+	assert g[1] == -1.0
+	assert g[2] == -0.001
+	assert g[5] == 1000000.0
+}
+
+struct Person {
+	name string
+	age  int
+}
+
+fn compare_people(a, b &Person) int {
+	return a.age - b.age
+}
+
+fn person_age(p &Person) i64 {
+	return i64(p.age)
+}
+
+fn test_sort_with_compare() {
+	mut seed := u32(3)
+	mut people := []Person
+	for i := 0; i < 1000; i++ {
+		seed = next_rand(seed)
+		people << Person{ name: 'p$i', age: int(seed % u32(100)) }
+	}
+	people.sort_with_compare(compare_people)
+	for i := 1; i < people.len; i++ {
+		assert people[i - 1].age <= people[i].age
+	}
+	// Already sorted, and reversed
+	people.sort_with_compare(compare_people)
+	assert people[0].age <= people[1].age
+	mut rev := []Person
+	for i := 0; i < 200; i++ {
+		rev << Person{ name: 'r$i', age: 200 - i }
+	}
+	rev.sort_with_compare(compare_people)
+	assert rev[0].age == 1
+	assert rev[199].age == 200
+}
+
+fn test_sort_by_key() {
+	mut people := [Person{'c', 30}, Person{'a', 20}, Person{'d', 30}, Person{'b', 20},
+		Person{'e', -5}]
+	people.sort_by_key(person_age)
+	mut names := ''
+	for p in people {
+		names += p.name
+	}
+	// Stable: the people of the same age stay in the same order
+	assert names == 'eabcd'
+}
+
+fn test_capacity() {
+	mut a := [1, 2, 3]
+	a.reserve(101)
+	assert a.cap >= 104
+	assert a.len == 3
+	cap := a.cap
+	for i := 0; i < 101; i++ {
+		a << i
+	}
+	assert a.cap == cap
+	a.truncate(2)
+	assert a.len == 2
+	a << 7
+	assert a[2] == 7
+	a.shrink_to_fit()
+	assert a.cap == 3
+	assert a[2] == 7
+	a.clear()
+	assert a.len == 0
+	assert a.cap == 3
+	a.shrink_to_fit()
+	assert a.cap == 0
+	a << 5
+	assert a[0] == 5
+	mut b := []byte
+	for i := 0; i < 1000; i++ {
+		b.push_many('ab'.str, 2)
+	}
+	assert b.len == 2000
+	assert b.cap < 4000
+}
+
+fn test_small_arrays() {
+	// No memory until the first push, then room for a few elements
+	mut a := []int
+	assert a.cap == 0
+	a << 1
+	assert a.cap == 4
+	a << 2
+	a << 3
+	a << 4
+	assert a.cap == 4
+	a << 5
+	assert a.cap == 8
+	b := a.clone()
+	assert b.len == 5
+	assert b.cap == 5
+	assert b[4] == 5
+	mut c := [1, 2, 3, 4]
+	c.delete(3)
+	nine := 9
+	c.insert(1, &nine)
+	assert c.len == 4
+	assert c[1] == 9
+	assert c[3] == 3
+	assert c.cap == 4
+}
@@ -14,11 +14,16 @@ fn init() {
 		C._setmode(C._fileno(C.stdout), C._O_U8TEXT)
 		C.SetConsoleMode(C.GetStdHandle(C.STD_OUTPUT_HANDLE), C.ENABLE_PROCESSED_OUTPUT | 0x0004) // ENABLE_VIRTUAL_TERMINAL_PROCESSING
 		C.setbuf(C.stdout,0)
+	} $else {
+		print_init()
 	}
 }
 
 fn C.memcpy(byteptr, byteptr, int)
 fn C.memmove(byteptr, byteptr, int)
+fn C.memcmp(byteptr, byteptr, int) int
+fn C.memchr(byteptr, int, int) voidptr
+fn C.tolower(int) int
 //fn C.malloc(int) byteptr
 fn C.realloc(byteptr, int) byteptr
 
@@ -95,6 +100,7 @@ pub fn print_backtrace(){
 }
 
 // replaces panic when -debug arg is passed
+[cold]
 fn panic_debug(line_no int, file,  mod, fn_name, s string) {
 	println('================ V panic ================')
 	println('   module: $mod')
@@ -103,12 +109,15 @@ fn panic_debug(line_no int, file,  mod, fn_name, s string) {
 	println('     line: ' + line_no.str())
 	println('  message: $s')
 	println('=========================================')
+	print_flush()
 	print_backtrace_skipping_top_frames(1)
 	C.exit(1)
 }
 
+[cold]
 pub fn panic(s string) {
 	println('V panic: $s')
+	print_flush()
 	print_backtrace()
 	C.exit(1)
 }
@@ -121,7 +130,10 @@ pub fn println(s string) {
 	$if windows {
 		C._putws(s.to_wide())
 	} $else {
-		C.printf('%.*s\n', s.len, s.str)
+		mut b := thread_print_buf()
+		b.write(s.str, s.len)
+		b.write('\n'.str, 1)
+		b.done()
 	}
 }
 
@@ -147,7 +159,9 @@ pub fn print(s string) {
 	$if windows {
 		C.wprintf(s.to_wide())
 	} $else {
-		C.printf('%.*s', s.len, s.str)
+		mut b := thread_print_buf()
+		b.write(s.str, s.len)
+		b.done()
 	}
 }
 
@@ -171,6 +185,17 @@ TODO
 	print_backtrace()
 #endif
 */
+	if v_alloc_prof {
+		return prof_alloc(n)
+	}
+	return raw_malloc(n)
+}
+
+// The allocator without the profiler
+fn raw_malloc(n int) byteptr {
+	if v_allocator != allocator_libc {
+		return alloc_block(n)
+	}
 	ptr := C.malloc(n)
 	if isnil(ptr) {
 		panic('malloc($n) failed')
@@ -182,10 +207,57 @@ pub fn calloc(n int) byteptr {
 	if n < 0 {
 		panic('calloc(<0)')
 	}
+	if v_alloc_prof {
+		ptr := prof_alloc(n)
+		C.memset(ptr, 0, n)
+		return ptr
+	}
+	if v_allocator != allocator_libc {
+		ptr := alloc_block(n)
+		C.memset(ptr, 0, n)
+		return ptr
+	}
 	return C.calloc(n, 1)
 }
 
+// Resizes a block from `malloc()` or `calloc()` (or allocates one if `ptr`
+// is 0) like C's realloc
+pub fn v_realloc(ptr voidptr, n int) byteptr {
+	if n < 0 {
+		panic('v_realloc(<0)')
+	}
+	if v_alloc_prof {
+		return prof_realloc(ptr, n)
+	}
+	return raw_realloc(ptr, n)
+}
+
+fn raw_realloc(ptr voidptr, n int) byteptr {
+	if v_allocator != allocator_libc {
+		return realloc_block(ptr, n)
+	}
+	res := C.realloc(ptr, n)
+	if isnil(res) {
+		panic('v_realloc($n) failed')
+	}
+	return res
+}
+
 pub fn free(ptr voidptr) {
+	if v_alloc_prof {
+		prof_free(ptr)
+		return
+	}
+	raw_free(ptr)
+}
+
+fn raw_free(ptr voidptr) {
+	if v_allocator != allocator_libc {
+		if !isnil(ptr) {
+			free_block(ptr)
+		}
+		return
+	}
 	C.free(ptr)
 }
 
@@ -195,7 +267,7 @@ fn memdup(src voidptr, sz int) voidptr {
 }
 
 fn v_ptr_free(ptr voidptr) {
-	C.free(ptr)
+	free(ptr)
 }
 
 pub fn is_atty(fd int) bool {
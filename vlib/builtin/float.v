@@ -6,16 +6,332 @@ module builtin
 
 #include <float.h>
 
+// The shortest decimal that reads back as `d`: `1.5`, `0.1`, `100.0`,
+// `1e+16`, `2.5e-05`, `nan`, `-inf`. Like Python's `repr()`, the exponent is
+// used below 1e-4 and from 1e16 on.
 pub fn (d f64) str() string {
-	buf := malloc(sizeof(double) * 5 + 1)// TODO
-	C.sprintf(*char(buf), '%f', d)
-	return tos(buf, vstrlen(buf))
+	mut buf := [32]byte
+	n := d.write_str(&buf[0])
+	mut res := malloc(n + 1)
+	C.memcpy(res, &buf[0], n)
+	res[n] = `\0`
+	return tos(res, n)
 }
 
+// Writes `d.str()` to `buf`, which has room for 32 bytes, without
+// allocating, and returns its length
+pub fn (d f64) write_str(buf byteptr) int {
+	mut bits := u64(0)
+	C.memcpy(&bits, &d, 8)
+	neg := u64(bits >> u64(63)) != u64(0)
+	mant := bits & u64(0xfffffffffffff)
+	exp := int(u64(bits >> u64(52)) & u64(0x7ff))
+	if exp == 0x7ff || (exp == 0 && mant == u64(0)) {
+		mut s := if neg { '-0.0' } else { '0.0' }
+		if exp == 0x7ff {
+			s = special_float_str(neg, mant != u64(0))
+		}
+		C.memcpy(buf, s.str, s.len)
+		return s.len
+	}
+	digits, e10 := float_to_decimal(mant, exp, 52, 1023)
+	return write_decimal(buf, neg, digits, e10)
+}
+
+// Like `f64.str()`, with the shortest decimal that reads back as the f32
 pub fn (d f32) str() string {
-	buf := malloc(sizeof(double) * 5 + 1)// TODO
-	C.sprintf(*char(buf), '%f', d)
-	return tos(buf, vstrlen(buf))
+	mut bits := u32(0)
+	C.memcpy(&bits, &d, 4)
+	neg := u32(bits >> u32(31)) != u32(0)
+	mant := u64(bits & u32(0x7fffff))
+	exp := int(u32(bits >> u32(23)) & u32(0xff))
+	if exp == 0xff {
+		return special_float_str(neg, mant != u64(0))
+	}
+	if exp == 0 && mant == u64(0) {
+		return if neg { '-0.0' } else { '0.0' }
+	}
+	digits, e10 := float_to_decimal(mant, exp, 23, 127)
+	return decimal_str(neg, digits, e10)
+}
+
+fn special_float_str(neg, is_nan bool) string {
+	if is_nan {
+		return 'nan'
+	}
+	return if neg { '-inf' } else { 'inf' }
+}
+
+// ===== Shortest decimals =====
+
+/*
+Ryu (Ulf Adams, 2018): the interval of the numbers that round to a float is
+scaled by a power of 10, with a 128 bit approximation of it from
+float_tables.v, so that its bounds fit in a u64. Digits are then removed
+from the end as long as the bounds still differ; what is left is the
+shortest decimal in the interval, and the closest one to the float.
+*/
+
+// floor(log10(2^e))
+fn log10_pow2(e int) int {
+	return (e * 78913) >> 18
+}
+
+// floor(log10(5^e))
+fn log10_pow5(e int) int {
+	return (e * 732923) >> 20
+}
+
+// The number of bits of 5^e
+fn pow5_bits(e int) int {
+	return ((e * 1217359) >> 19) + 1
+}
+
+fn pow5_factor(v u64) int {
+	mut n := 0
+	mut x := v
+	for x % u64(5) == u64(0) {
+		x = x / u64(5)
+		n++
+	}
+	return n
+}
+
+// (m * mul) >> j, with the 128 bit `mul` and 64 < j < 128. `wymum()` is a
+// full 64 x 64 -> 128 bit multiplication.
+fn mul_shift64(m, mul_lo, mul_hi u64, j int) u64 {
+	_, b0_hi := wymum(m, mul_lo)
+	b2_lo, b2_hi := wymum(m, mul_hi)
+	lo := b0_hi + b2_lo
+	mut hi := b2_hi
+	if lo < b0_hi {
+		hi += u64(1)
+	}
+	s := j - 64
+	return u64(hi << u64(64 - s)) | u64(lo >> u64(s))
+}
+
+// The shortest decimal `digits * 10^e10` that reads back as the float with
+// the bits `ieee_mant` and `ieee_exp`, of a format with `mant_bits` and
+// `bias`
+fn float_to_decimal(ieee_mant u64, ieee_exp, mant_bits, bias int) (u64, int) {
+	mut e2 := 0
+	mut m2 := u64(0)
+	if ieee_exp == 0 {
+		e2 = 1 - bias - mant_bits - 2
+		m2 = ieee_mant
+	}
+	else {
+		e2 = ieee_exp - bias - mant_bits - 2
+		m2 = u64(u64(1) << u64(mant_bits)) | ieee_mant
+	}
+	accept_bounds := m2 % u64(2) == u64(0)
+	// The float is mv / 4 * 2^e2, the numbers that round to it are
+	// between mm and mp
+	mv := u64(4) * m2
+	mut mm_shift := u64(0)
+	if ieee_mant != u64(0) || ieee_exp <= 1 {
+		mm_shift = u64(1)
+	}
+	mut vr := u64(0)
+	mut vp := u64(0)
+	mut vm := u64(0)
+	mut e10 := 0
+	mut vm_trailing_zeros := false
+	mut vr_trailing_zeros := false
+	if e2 >= 0 {
+		mut q := log10_pow2(e2)
+		if e2 > 3 {
+			q--
+		}
+		e10 = q
+		k := 125 + pow5_bits(q) - 1
+		i := -e2 + q + k
+		t := &u64(pow5_inv_split.data)
+		vr = mul_shift64(mv, t[2 * q], t[2 * q + 1], i)
+		vp = mul_shift64(mv + u64(2), t[2 * q], t[2 * q + 1], i)
+		vm = mul_shift64(mv - u64(1) - mm_shift, t[2 * q], t[2 * q + 1], i)
+		if q <= 21 {
+			// Only one of mp, mv and mm can be a multiple of 5
+			if mv % u64(5) == u64(0) {
+				vr_trailing_zeros = pow5_factor(mv) >= q
+			}
+			else if accept_bounds {
+				vm_trailing_zeros = pow5_factor(mv - u64(1) - mm_shift) >= q
+			}
+			else if pow5_factor(mv + u64(2)) >= q {
+				vp -= u64(1)
+			}
+		}
+	}
+	else {
+		mut q := log10_pow5(-e2)
+		if -e2 > 1 {
+			q--
+		}
+		e10 = q + e2
+		i := -e2 - q
+		k := pow5_bits(i) - 125
+		j := q - k
+		t := &u64(pow5_split.data)
+		vr = mul_shift64(mv, t[2 * i], t[2 * i + 1], j)
+		vp = mul_shift64(mv + u64(2), t[2 * i], t[2 * i + 1], j)
+		vm = mul_shift64(mv - u64(1) - mm_shift, t[2 * i], t[2 * i + 1], j)
+		if q <= 1 {
+			// mv has at least q trailing zero bits
+			vr_trailing_zeros = true
+			if accept_bounds {
+				vm_trailing_zeros = mm_shift == u64(1)
+			}
+			else {
+				vp -= u64(1)
+			}
+		}
+		else if q < 63 {
+			vr_trailing_zeros = (mv & u64(u64(u64(1) << u64(q)) - u64(1))) == u64(0)
+		}
+	}
+	// Removes the digits
+	mut removed := 0
+	mut last := u64(0)
+	mut out := u64(0)
+	if vm_trailing_zeros || vr_trailing_zeros {
+		// Rare
+		for vp / u64(10) > vm / u64(10) {
+			vm_trailing_zeros = vm_trailing_zeros && vm % u64(10) == u64(0)
+			vr_trailing_zeros = vr_trailing_zeros && last == u64(0)
+			last = vr % u64(10)
+			vr = vr / u64(10)
+			vp = vp / u64(10)
+			vm = vm / u64(10)
+			removed++
+		}
+		if vm_trailing_zeros {
+			for vm % u64(10) == u64(0) {
+				vr_trailing_zeros = vr_trailing_zeros && last == u64(0)
+				last = vr % u64(10)
+				vr = vr / u64(10)
+				vp = vp / u64(10)
+				vm = vm / u64(10)
+				removed++
+			}
+		}
+		if vr_trailing_zeros && last == u64(5) && vr % u64(2) == u64(0) {
+			// Exactly in the middle, round to even
+			last = u64(4)
+		}
+		out = vr
+		if (vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last >= u64(5) {
+			out += u64(1)
+		}
+	}
+	else {
+		mut round_up := false
+		for vp / u64(10) > vm / u64(10) {
+			round_up = vr % u64(10) >= u64(5)
+			vr = vr / u64(10)
+			vp = vp / u64(10)
+			vm = vm / u64(10)
+			removed++
+		}
+		out = vr
+		if vr == vm || round_up {
+			out += u64(1)
+		}
+	}
+	return out, e10 + removed
+}
+
+// Writes `digits * 10^e10`
+fn decimal_str(neg bool, digits u64, e10 int) string {
+	mut buf := [32]byte
+	n := write_decimal(&buf[0], neg, digits, e10)
+	mut res := malloc(n + 1)
+	C.memcpy(res, &buf[0], n)
+	res[n] = `\0`
+	return tos(res, n)
+}
+
+// Writes `digits * 10^e10` like `f64.str()` to `buf`, at most 24 bytes, and
+// returns their number
+fn write_decimal(buf_ byteptr, neg bool, digits u64, e10 int) int {
+	mut buf := buf_
+	mut n := 0
+	if neg {
+		buf[0] = `-`
+		n = 1
+	}
+	nr_digits := dec_digits(digits)
+	mut ds := [20]byte
+	write_dec(&ds[0], 20, digits)
+	d := &ds[20 - nr_digits]
+	// The exponent of the first digit
+	exp := e10 + nr_digits - 1
+	if exp >= -4 && exp < 16 {
+		if exp < 0 {
+			// 0.00ddd
+			buf[n] = `0`
+			buf[n + 1] = `.`
+			n += 2
+			for i := 0; i < -exp - 1; i++ {
+				buf[n] = `0`
+				n++
+			}
+			C.memcpy(&buf[n], d, nr_digits)
+			n += nr_digits
+		}
+		else if exp >= nr_digits - 1 {
+			// ddd00.0
+			C.memcpy(&buf[n], d, nr_digits)
+			n += nr_digits
+			for i := 0; i < exp - nr_digits + 1; i++ {
+				buf[n] = `0`
+				n++
+			}
+			buf[n] = `.`
+			buf[n + 1] = `0`
+			n += 2
+		}
+		else {
+			// dd.ddd
+			C.memcpy(&buf[n], d, exp + 1)
+			n += exp + 1
+			buf[n] = `.`
+			n++
+			C.memcpy(&buf[n], d + exp + 1, nr_digits - exp - 1)
+			n += nr_digits - exp - 1
+		}
+	}
+	else {
+		// d.ddde+XX
+		buf[n] = d[0]
+		n++
+		if nr_digits > 1 {
+			buf[n] = `.`
+			n++
+			C.memcpy(&buf[n], d + 1, nr_digits - 1)
+			n += nr_digits - 1
+		}
+		buf[n] = `e`
+		n++
+		mut e := exp
+		if e < 0 {
+			buf[n] = `-`
+			e = -e
+		}
+		else {
+			buf[n] = `+`
+		}
+		n++
+		if e < 10 {
+			buf[n] = `0`
+			n++
+		}
+		nr_e := dec_digits(u64(e))
+		write_dec(&buf[n], nr_e, u64(e))
+		n += nr_e
+	}
+	return n
 }
 
 fn f32_abs(a f32) f32 {	return if a < 0 { -a } else { a } }
@@ -0,0 +1,133 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+#include <time.h>
+
+/*
+The string hash used by `map` and `string.hash()`.
+
+It's wyhash (final version 4, by Wang Yi, public domain): keys are read 8 or
+16 bytes at a time (48 bytes per round for long keys, in 3 independent
+lanes), and each block is mixed with a 64x64->128 bit multiply, folded by
+xoring the two halves. The multiply is done on 32 bit halves, so it works
+with every C compiler V supports, not only the ones with `__int128`.
+
+The seed is random per process, so the slots of the keys of a map can't be
+predicted, and input from the network (e.g. HTTP headers and form fields)
+can't be crafted to collide. Don't store hashes or rely on their values
+between runs.
+*/
+
+// The wyhash primes are written as literals in `wyhash()`, so that the C
+// compiler can see them (consts of type u64 are globals)
+const (
+	wyp0 = u64(0xa0761d6478bd642f)
+	wyp1 = u64(0xe7037ed1a0b428db)
+	wyp2 = u64(0x8ebc6af09c88c6e3)
+	wyp3 = u64(0x589965cc75374cc3)
+)
+
+// The time, and the addresses of the stack and the heap, which are
+// randomized by the OS (ASLR).
+// The first step of wyhash only depends on the seed, so it's done here,
+// once, instead of for every key.
+fn new_hash_seed() u64 {
+	p := malloc(1)
+	t := i64(0)
+	C.time(&t)
+	mut seed := u64(t)
+	seed = wymix(seed ^ wyp0, u64(p) ^ wyp1)
+	seed = wymix(seed ^ wyp2, u64(&t) ^ wyp3)
+	free(p)
+	return seed ^ wymix(seed ^ wyp0, wyp1)
+}
+
+// The 128 bit product of `a` and `b` as (low, high)
+[inline] fn wymum(a, b u64) (u64, u64) {
+	a_lo := a & u64(0xffffffff)
+	a_hi := u64(a >> u64(32))
+	b_lo := b & u64(0xffffffff)
+	b_hi := u64(b >> u64(32))
+	lo_lo := a_lo * b_lo
+	hi_lo := a_hi * b_lo
+	lo_hi := a_lo * b_hi
+	hi_hi := a_hi * b_hi
+	cross := u64(lo_lo >> u64(32)) + (hi_lo & u64(0xffffffff)) + lo_hi
+	hi := hi_hi + u64(hi_lo >> u64(32)) + u64(cross >> u64(32))
+	lo := u64(cross << u64(32)) | (lo_lo & u64(0xffffffff))
+	return lo, hi
+}
+
+[inline] fn wymix(a, b u64) u64 {
+	lo, hi := wymum(a, b)
+	return lo ^ hi
+}
+
+// Unaligned little endian loads (a single `mov` with optimizations on)
+[inline] fn wyr8(p byteptr) u64 {
+	v := u64(0)
+	C.memcpy(&v, p, 8)
+	return v
+}
+
+[inline] fn wyr4(p byteptr) u64 {
+	v := u32(0)
+	C.memcpy(&v, p, 4)
+	return u64(v)
+}
+
+// 1-3 bytes: the first, middle and last ones
+[inline] fn wyr3(p byteptr, k int) u64 {
+	return u64(p[k - 1]) | u64(u64(p[0]) << u64(16)) | u64(u64(p[k >> 1]) << u64(8))
+}
+
+// `seed` is a seed returned by `new_hash_seed()`
+fn wyhash(key byteptr, len int, seed_ u64) u64 {
+	mut p := key
+	mut seed := seed_
+	mut a := u64(0)
+	mut b := u64(0)
+	if len <= 16 {
+		if len >= 4 {
+			// Two overlapping 4 byte reads from each end
+			off := (len >> 3) << 2
+			a = wyr4(p + off) | u64(wyr4(p) << u64(32))
+			b = wyr4(p + len - 4 - off) | u64(wyr4(p + len - 4) << u64(32))
+		}
+		else if len > 0 {
+			a = wyr3(p, len)
+		}
+	}
+	else {
+		mut i := len
+		if i > 48 {
+			mut see1 := seed
+			mut see2 := seed
+			for i > 48 {
+				seed = wymix(wyr8(p) ^ u64(0xe7037ed1a0b428db), wyr8(p + 8) ^ seed)
+				see1 = wymix(wyr8(p + 16) ^ u64(0x8ebc6af09c88c6e3), wyr8(p + 24) ^ see1)
+				see2 = wymix(wyr8(p + 32) ^ u64(0x589965cc75374cc3), wyr8(p + 40) ^ see2)
+				p += 48
+				i -= 48
+			}
+			seed ^= see1 ^ see2
+		}
+		for i > 16 {
+			seed = wymix(wyr8(p) ^ u64(0xe7037ed1a0b428db), wyr8(p + 8) ^ seed)
+			p += 16
+			i -= 16
+		}
+		// The last 16 bytes, overlapping the previous block
+		a = wyr8(p + i - 16)
+		b = wyr8(p + i - 8)
+	}
+	lo, hi := wymum(a ^ u64(0xe7037ed1a0b428db), b ^ seed)
+	return wymix(lo ^ u64(0xa0761d6478bd642f) ^ u64(len), hi ^ u64(0xe7037ed1a0b428db))
+}
+
+const (
+	hash_seed = new_hash_seed()
+)
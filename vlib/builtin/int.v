@@ -4,59 +4,107 @@
 
 module builtin
 
-pub fn ptr_str(ptr voidptr) string {
-	buf := malloc(sizeof(double) * 5 + 1)// TODO
-	C.sprintf(*char(buf), '%p', ptr)
-	return tos(buf, vstrlen(buf))
-}
+// The two digits of 0 to 99
+const (
+	digit_pairs = '00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899'
+)
 
-// fn (nn i32) str() string {
-// return i
-// }
-pub fn (nn int) str() string {
-	mut n := nn
-	if n == 0 {
-		return '0'
+// The number of decimal digits of `n`
+fn dec_digits(n u64) int {
+	mut d := 1
+	mut x := n
+	for x >= u64(10000) {
+		x = x / u64(10000)
+		d += 4
 	}
-	max := 16
-	mut buf := calloc(max)
-	mut len := 0
-	mut is_neg := false
-	if n < 0 {
-		n = -n
-		is_neg = true
+	if x >= u64(1000) {
+		return d + 3
 	}
-	// Fill the string from the end
-	for n > 0 {
-		d := n % 10
-		buf[max - len - 1] = d + int(`0`)
-		len++
-		n = n / 10
+	if x >= u64(100) {
+		return d + 2
 	}
-	// Prepend - if it's negative
-	if is_neg {
-		buf[max - len - 1] = `-`
-		len++
+	if x >= u64(10) {
+		return d + 1
 	}
-	return tos(buf + max - len, len)
+	return d
 }
 
-pub fn (nn u32) str() string {
-	 mut n := nn
-	if n == u32(0) {
-		return '0'
+// Writes the digits of `n` so that they end at `buf[end]`, two at a time,
+// and returns where they start
+pub fn write_dec(buf_ byteptr, end int, n u64) int {
+	mut buf := buf_
+	pairs := digit_pairs.str
+	mut i := end
+	mut x := n
+	for x >= u64(100) {
+		r := int(x % u64(100)) * 2
+		x = x / u64(100)
+		i -= 2
+		buf[i] = pairs[r]
+		buf[i + 1] = pairs[r + 1]
+	}
+	if x >= u64(10) {
+		r := int(x) * 2
+		i -= 2
+		buf[i] = pairs[r]
+		buf[i + 1] = pairs[r + 1]
+	}
+	else {
+		i--
+		buf[i] = byte(x) + `0`
+	}
+	return i
+}
+
+// `-n` if `neg`, in a string of the exact size
+fn dec_str(n u64, neg bool) string {
+	mut len := dec_digits(n)
+	if neg {
+		len++
 	}
-	max := 16
-	mut buf := malloc(max)
-	mut len := 0
-	// Fill the string from the end
-	for n > u32(0) {
-		d := n % u32(10)
-		buf[max - len - 1] = d + u32(`0`)
+	mut buf := malloc(len + 1)
+	if neg {
+		buf[0] = `-`
+	}
+	write_dec(buf, len, n)
+	buf[len] = `\0`
+	return tos(buf, len)
+}
+
+pub fn ptr_str(ptr voidptr) string {
+	// Through byteptr: `u64(ptr)` would read a u64 at `ptr`
+	addr := u64(byteptr(ptr))
+	mut n := addr
+	mut len := 3
+	for n >= u64(16) {
+		n = u64(n >> u64(4))
 		len++
-		n = n / u32(10)
 	}
-	return tos(buf + max - len, len)
+	mut buf := malloc(len + 1)
+	buf[0] = `0`
+	buf[1] = `x`
+	n = addr
+	hex := '0123456789abcdef'
+	for i := len - 1; i >= 2; i-- {
+		buf[i] = hex[int(n & u64(15))]
+		n = u64(n >> u64(4))
+	}
+	buf[len] = `\0`
+	return tos(buf, len)
+}
+
+// fn (nn i32) str() string {
+// return i
+// }
+pub fn (n int) str() string {
+	if n < 0 {
+		return dec_str(u64(0) - u64(i64(n)), true)
+	}
+	return dec_str(u64(n), false)
+}
+
+pub fn (n u32) str() string {
+	return dec_str(u64(n), false)
 }
 
 /*
@@ -79,50 +127,15 @@ pub fn (nn byte) str() string {
 }
 */
 
-pub fn (nn i64) str() string {
-	mut n := nn
-	if n == i64(0) {
-		return '0'
-	}
-	max := 32
-	mut buf := malloc(max)
-	mut len := 0
-	mut is_neg := false
+pub fn (n i64) str() string {
 	if n < i64(0) {
-		n = -n
-		is_neg = true
-	}
-	// Fill the string from the end
-	for n > i64(0) {
-		d := int(n % i64(10))
-		buf[max - len - 1] = d + int(`0`)
-		len++
-		n = n / i64(10)
-	}
-	// Prepend - if it's negative
-	if is_neg {
-		buf[max - len - 1] = `-`
-		len++
+		return dec_str(u64(0) - u64(n), true)
 	}
-	return tos(buf + max - len, len)
+	return dec_str(u64(n), false)
 }
 
-pub fn (nn u64) str() string {
-	 mut n := nn
-	if n == u64(0) {
-		return '0'
-	}
-	max := 32
-	mut buf := malloc(max)
-	mut len := 0
-	// Fill the string from the end
-	for n > u64(0) {
-		d := n % u64(10)
-		buf[max - len - 1] = d + u64(`0`)
-		len++
-		n = n / u64(10)
-	}
-	return tos(buf + max - len, len)
+pub fn (n u64) str() string {
+	return dec_str(n, false)
 }
 
 pub fn (b bool) str() string {
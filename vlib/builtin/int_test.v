@@ -66,6 +66,58 @@ fn test_str_methods() {
 	assert u64(-1).str() == '18446744073709551615'
 }
 
+fn test_int_str_edges() {
+	assert int(0).str() == '0'
+	assert int(-2147483648).str() == '-2147483648'
+	assert i64(-9223372036854775807 - 1).str() == '-9223372036854775808'
+	assert u64(10000000000000000000).str() == '10000000000000000000'
+	assert int(99).str() == '99'
+	assert int(100).str() == '100'
+}
+
+fn test_ptr_str() {
+	x := 1
+	p := voidptr(&x)
+	buf := malloc(32)
+	C.sprintf(*char(buf), '%p', p)
+	assert ptr_str(p) == tos2(buf)
+	// glibc prints `(nil)` for a null `%p`
+	assert ptr_str(voidptr(0)) == '0x0'
+}
+
+fn test_float_str() {
+	assert f64(0.1).str() == '0.1'
+	assert f64(1.5).str() == '1.5'
+	assert f64(100).str() == '100.0'
+	assert f64(-0.0).str() == '-0.0'
+	assert (f64(0.1) + f64(0.2)).str() == '0.30000000000000004'
+	assert '1e16'.f64().str() == '1e+16'
+	assert '1.5e-5'.f64().str() == '1.5e-05'
+	assert '5e-324'.f64().str() == '5e-324'
+	assert '1.7976931348623157e308'.f64().str() == '1.7976931348623157e+308'
+	assert f32(0.1).str() == '0.1'
+	assert '3.4028235e38'.f32().str() == '3.4028235e+38'
+	assert '1e-45'.f32().str() == '1e-45'
+	assert f64(1) / f64(3) == (f64(1) / f64(3)).str().f64()
+}
+
+fn test_parse() {
+	assert ' -12a'.int() == -12
+	assert '+7'.int() == 7
+	assert ''.int() == 0
+	assert '-9223372036854775808'.i64() == i64(-9223372036854775807 - 1)
+	assert '0x1F'.u64() == u64(31)
+	assert '017'.u32() == u32(15)
+	assert '18446744073709551615'.u64() == u64(-1)
+	assert '1.5'.f64() == f64(1.5)
+	assert '-.5e1'.f64() == f64(-5)
+	assert '1e23'.f64().str() == '1e+23'
+	assert '2.2250738585072014e-308'.f64().str() == '2.2250738585072014e-308'
+	assert '123456789012345678901234567890'.f64().str() == '1.2345678901234568e+29'
+	assert 'inf'.f64().str() == 'inf'
+	assert '0.1'.f32() == f32(0.1)
+}
+
 /*
 fn test_cmp() {
 	assert 1 ≠ 2
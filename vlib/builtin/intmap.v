@@ -0,0 +1,236 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+`map[int]T`, `map[u64]T`, `map[voidptr]T` etc.
+
+The same insertion ordered Robin Hood table as `map` (see map.v), with u64
+keys instead of strings. The generated code converts keys of all integer
+and pointer types to u64, so `m[key]` doesn't allocate, and comparing two
+keys is a single `==`.
+*/
+
+struct intmap {
+	element_size int
+	key_size     int            // sizeof() the V key type, for `keys()`
+	table        &intmaptable   // shared by all copies of the map
+pub:
+	size int
+}
+
+struct intmaptable {
+mut:
+	element_size int
+	index        mapindex
+	len          int     // number of entries
+	entries_cap  int
+	entry_keys   &u64    // entries in insertion order
+	entry_vals   byteptr // `element_size` bytes per entry
+}
+
+fn new_intmap(key_size, elm_size int) intmap {
+	res := intmap {
+		element_size: elm_size
+		key_size: key_size
+		table: new_intmaptable(elm_size)
+	}
+	return res
+}
+
+fn new_intmaptable(elm_size int) &intmaptable {
+	return &intmaptable {
+		element_size: elm_size
+		index: new_mapindex()
+		entry_keys: 0
+		entry_vals: 0
+	}
+}
+
+// The murmur3 finalizer, so that sequential keys and pointers (with
+// zero low bits) are spread over all slots. Never 0, that marks an empty slot.
+[inline] fn intmap_hash(key u64) u32 {
+	mut h := key
+	h = (h ^ (h >> u64(33))) * u64(0xff51afd7ed558ccd)
+	h = (h ^ (h >> u64(33))) * u64(0xc4ceb9fe1a85ec53)
+	res := u32(h ^ (h >> u64(33)))
+	if res == 0 {
+		return 1
+	}
+	return res
+}
+
+// Returns the index slot of `key`, or -1 if it's not in the map.
+fn (t &intmaptable) find_slot(key u64, hash u32) int {
+	if t.index.cap == 0 {
+		return -1
+	}
+	mask := t.index.cap - 1
+	mut slot := int(hash) & mask
+	mut dist := 0
+	for {
+		s := t.index.slots[slot]
+		h := u32(s)
+		if h == 0 || ((slot - (int(h) & mask)) & mask) < dist {
+			return -1
+		}
+		if h == hash && t.entry_keys[int(s >> u64(32))] == key {
+			return slot
+		}
+		slot = (slot + 1) & mask
+		dist++
+	}
+	return -1
+}
+
+// Rebuilds the index with `cap` slots. Hashing a key is cheaper than
+// storing the hashes.
+fn (t mut intmaptable) rehash(cap int) {
+	t.index.reset(cap)
+	for i := 0; i < t.len; i++ {
+		t.index.insert(intmap_hash(t.entry_keys[i]), i)
+	}
+}
+
+fn (t mut intmaptable) resize_entries(cap int) {
+	t.entries_cap = cap
+	t.entry_keys = &u64(v_realloc(t.entry_keys, cap * sizeof(u64)))
+	t.entry_vals = v_realloc(t.entry_vals, cap * t.element_size + 1)
+}
+
+fn (t mut intmaptable) set(key u64, val voidptr) {
+	hash := intmap_hash(key)
+	slot := t.find_slot(key, hash)
+	if slot >= 0 {
+		C.memcpy(t.entry_vals + t.index.idx(slot) * t.element_size, val, t.element_size)
+		return
+	}
+	if t.len == t.entries_cap {
+		if t.entries_cap == 0 {
+			t.resize_entries(map_min_cap)
+		}
+		else {
+			t.resize_entries(t.entries_cap * 2)
+		}
+	}
+	idx := t.len
+	t.entry_keys[idx] = key
+	C.memcpy(t.entry_vals + idx * t.element_size, val, t.element_size)
+	t.len++
+	if t.len * 8 > t.index.cap * 7 {
+		if t.index.cap == 0 {
+			t.rehash(map_min_cap)
+		}
+		else {
+			t.rehash(t.index.cap * 2)
+		}
+		return
+	}
+	t.index.insert(hash, idx)
+}
+
+fn (t mut intmaptable) delete(key u64) {
+	slot := t.find_slot(key, intmap_hash(key))
+	if slot < 0 {
+		return
+	}
+	idx := t.index.idx(slot)
+	t.index.remove(slot)
+	// Move the last entry into the hole
+	last := t.len - 1
+	if idx != last {
+		t.entry_keys[idx] = t.entry_keys[last]
+		C.memcpy(t.entry_vals + idx * t.element_size, t.entry_vals + last * t.element_size, t.element_size)
+		t.index.move(intmap_hash(t.entry_keys[idx]), last, idx)
+	}
+	t.len--
+	if t.index.cap > map_min_cap && t.len * 8 < t.index.cap {
+		t.rehash(t.index.cap / 2)
+		if t.entries_cap / 2 >= t.len * 2 {
+			t.resize_entries(t.entries_cap / 2)
+		}
+	}
+}
+
+fn (t mut intmaptable) free() {
+	t.index.free()
+	free(t.entry_keys)
+	free(t.entry_vals)
+	free(t)
+}
+
+fn (m mut intmap) set(key u64, val voidptr) {
+	if isnil(m.table) {
+		m.table = new_intmaptable(m.element_size)
+	}
+	m.table.set(key, val)
+	m.size = m.table.len
+}
+
+fn (m intmap) get(key u64, out voidptr) bool {
+	if isnil(m.table) {
+		return false
+	}
+	t := m.table
+	slot := t.find_slot(key, intmap_hash(key))
+	if slot < 0 {
+		return false
+	}
+	C.memcpy(out, t.entry_vals + t.index.idx(slot) * t.element_size, t.element_size)
+	return true
+}
+
+fn (m intmap) exists(key u64) bool {
+	return !isnil(m.table) && m.table.find_slot(key, intmap_hash(key)) >= 0
+}
+
+// Returns the keys in insertion order, as an array of the map's key type
+// (`[]int` for `map[int]T`).
+fn (m &intmap) keys() array {
+	if isnil(m.table) {
+		return new_array(0, 0, m.key_size)
+	}
+	n := m.table.len
+	mut res := new_array(n, n, m.key_size)
+	src := m.table.entry_keys
+	// Keys were converted with `(u64)key`, truncating converts them back
+	switch m.key_size {
+	case 1:
+		mut dst := &byte(res.data)
+		for i := 0; i < n; i++ {
+			dst[i] = byte(src[i])
+		}
+	case 2:
+		mut dst := &u16(res.data)
+		for i := 0; i < n; i++ {
+			dst[i] = u16(src[i])
+		}
+	case 4:
+		mut dst := &u32(res.data)
+		for i := 0; i < n; i++ {
+			dst[i] = u32(src[i])
+		}
+	default:
+		C.memcpy(res.data, src, n * sizeof(u64))
+	}
+	return res
+}
+
+fn (m mut intmap) delete(key u64) {
+	if isnil(m.table) {
+		return
+	}
+	m.table.delete(key)
+	m.size = m.table.len
+}
+
+pub fn (m mut intmap) free() {
+	if isnil(m.table) {
+		return
+	}
+	m.table.free()
+	m.table = 0
+	m.size = 0
+}
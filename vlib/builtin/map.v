@@ -6,252 +6,332 @@ module builtin
 
 import strings
 
+/*
+`map[string]T` is an insertion ordered hash table.
+
+The entries (keys, values and key hashes) are stored in dense arrays in
+insertion order, values inline, so `for key, val in m` and `keys()` are
+a linear scan. A key is hashed once, when it's inserted: growing, shrinking
+and deleting use the stored hashes.
+
+Lookups go through a separate open addressing index: `cap` slots, each
+holding the hash of a key and the position of its entry (packed in a u64,
+so a probe is one load), probed linearly.
+It uses Robin Hood hashing: an inserted key takes the slot of a key that
+is closer to its own ideal slot, so no key is much further away than the
+others. This keeps the probe sequences short even at 7/8 load, and a lookup
+of a missing key can stop as soon as it's further than the key in the slot.
+
+`delete()` removes the slot by shifting the following displaced slots back
+(no tombstones) and moves the last entry into the hole, so the entries stay
+dense. The index grows at 7/8 load and shrinks below 1/8.
+
+The table is allocated once and shared by all copies of a `map` value, like
+the nodes of the tree that used to implement it, so a copy (e.g. the one
+made by `for key, val in m`) stays valid while the map grows.
+*/
+
 struct map {
 	element_size int
-	root      &mapnode
+	table        &maptable // shared by all copies of the map
 pub:
 	size int
 }
 
-struct mapnode {
-	left &mapnode
-	right &mapnode
-	is_empty bool
-	key string
-	val voidptr
+struct maptable {
+mut:
+	element_size int
+	index        mapindex
+	len          int     // number of entries
+	entries_cap  int
+	entry_hashes &u32    // entries in insertion order
+	entry_keys   &string
+	entry_vals   byteptr // `element_size` bytes per entry
+}
+
+// The open addressing index of `map` and `intmap`
+struct mapindex {
+mut:
+	cap   int  // number of slots, a power of 2, 0 before the first `set()`
+	slots &u64 // entry << 32 | hash of the key, 0 if the slot is empty
 }
 
+const (
+	map_min_cap = 8
+)
+
 fn new_map(cap, elm_size int) map {
 	res := map {
 		element_size: elm_size
-		root: 0
+		table: new_maptable(elm_size)
 	}
 	return res
 }
 
 // `m := { 'one': 1, 'two': 2 }`
 fn new_map_init(cap, elm_size int, keys &string, vals voidptr) map {
-	mut res := map {
-		element_size: elm_size
-		root: 0
-	}
+	mut res := new_map(cap, elm_size)
 	for i in 0 .. cap {
 		res.set(keys[i], vals + i * elm_size)
 	}
 	return res
 }
 
-fn new_node(key string, val voidptr, element_size int) &mapnode {
-	new_e := &mapnode {
-		key: key
-		val: malloc(element_size)
-		left: 0
-		right: 0
+fn new_maptable(elm_size int) &maptable {
+	return &maptable {
+		element_size: elm_size
+		index: new_mapindex()
+		entry_hashes: 0
+		entry_keys: 0
+		entry_vals: 0
 	}
-	C.memcpy(new_e.val, val, element_size)
-	return new_e
 }
 
-fn (m mut map) insert(n mut mapnode, key string, val voidptr) {
-	if n.key == key {
-		C.memcpy(n.val, val, m.element_size)
-		return
-	}
-	if n.key > key {
-		if n.left == 0 {
-			n.left = new_node(key, val, m.element_size)
-			m.size++
-		}  else {
-			m.insert(mut n.left, key, val)
-		}
-		return
+fn new_mapindex() mapindex {
+	return mapindex {
+		slots: 0
 	}
-	if n.right == 0 {
-		n.right = new_node(key, val, m.element_size)
-		m.size++
-	}  else {
-		m.insert(mut n.right, key, val)
+}
+
+// wyhash with the per process seed (see hash.v). Never 0, that marks an
+// empty slot.
+[inline] fn map_hash(key string) u32 {
+	h := u32(wyhash(key.str, key.len, hash_seed))
+	if h == 0 {
+		return 1
 	}
+	return h
 }
 
-fn (n & mapnode) find(key string, out voidptr, element_size int) bool{
-	if n.key == key {
-		C.memcpy(out, n.val, element_size)
-		return true
+// Returns the index slot of `key`, or -1 if it's not in the map.
+fn (t &maptable) find_slot(key string, hash u32) int {
+	if t.index.cap == 0 {
+		return -1
 	}
-	else if n.key > key {
-		if n.left == 0 {
-			return false
-		}  else {
-			return n.left.find(key, out, element_size)
+	mask := t.index.cap - 1
+	mut slot := int(hash) & mask
+	mut dist := 0
+	for {
+		s := t.index.slots[slot]
+		h := u32(s)
+		// Robin Hood: `key` would have taken this slot
+		if h == 0 || ((slot - (int(h) & mask)) & mask) < dist {
+			return -1
 		}
-	}
-	else {
-		if n.right == 0 {
-			return false
-		}  else {
-			return n.right.find(key, out, element_size)
+		if h == hash && t.entry_keys[int(s >> u64(32))] == key {
+			return slot
 		}
+		slot = (slot + 1) & mask
+		dist++
 	}
+	return -1
 }
 
-// same as `find`, but doesn't return a value. Used by `exists`
-fn (n & mapnode) find2(key string, element_size int) bool{
-	if n.key == key {
-		return true
-	}
-	else if n.key > key {
-		if isnil(n.left) {
-			return false
-		}  else {
-			return n.left.find2(key, element_size)
+// Empties the index and resizes it to `cap` slots
+fn (ix mut mapindex) reset(cap int) {
+	free(ix.slots)
+	ix.cap = cap
+	ix.slots = &u64(calloc(cap * sizeof(u64)))
+}
+
+// The entry of the key in `slot`
+[inline] fn (ix &mapindex) idx(slot int) int {
+	return int(ix.slots[slot] >> u64(32))
+}
+
+fn (ix mut mapindex) insert(hash u32, idx int) {
+	mask := ix.cap - 1
+	mut slot := int(hash) & mask
+	mut dist := 0
+	mut cur := u64(hash) | (u64(idx) << u64(32))
+	for {
+		s := ix.slots[slot]
+		if s == 0 {
+			ix.slots[slot] = cur
+			return
 		}
+		// Take the slot of a key that is closer to its ideal slot,
+		// and continue with that key
+		slot_dist := (slot - (int(u32(s)) & mask)) & mask
+		if slot_dist < dist {
+			ix.slots[slot] = cur
+			cur = s
+			dist = slot_dist
+		}
+		slot = (slot + 1) & mask
+		dist++
 	}
-	else {
-		if isnil(n.right) {
-			return false
-		}  else {
-			return n.right.find2(key, element_size)
+}
+
+// Backward shift: moves the displaced keys after `slot` one slot back
+fn (ix mut mapindex) remove(slot_ int) {
+	mask := ix.cap - 1
+	mut slot := slot_
+	for {
+		next := (slot + 1) & mask
+		s := ix.slots[next]
+		if s == 0 || ((next - (int(u32(s)) & mask)) & mask) == 0 {
+			break
 		}
+		ix.slots[slot] = s
+		slot = next
 	}
+	ix.slots[slot] = 0
 }
 
-fn (m mut map) set(key string, val voidptr) {
-	if isnil(m.root) {
-		m.root = new_node(key, val, m.element_size)
-		m.size++
-		return
+// Points the slot of entry `from` (with hash `hash`) to `to`
+fn (ix mut mapindex) move(hash u32, from, to int) {
+	mask := ix.cap - 1
+	mut slot := int(hash) & mask
+	for ix.slots[slot] == 0 || ix.idx(slot) != from {
+		slot = (slot + 1) & mask
 	}
-	m.insert(mut m.root, key, val)
+	ix.slots[slot] = u64(hash) | (u64(to) << u64(32))
 }
 
-/*
-fn (m map) bs(query string, start, end int, out voidptr) {
-	// println('bs "$query" $start -> $end')
-	mid := start + ((end - start) / 2)
-	if end - start == 0 {
-		last := m.entries[end]
-		C.memcpy(out, last.val, m.element_size)
-		return
+fn (ix mut mapindex) free() {
+	free(ix.slots)
+}
+
+// Rebuilds the index with `cap` slots. The entries store the hashes,
+// so no keys are hashed or compared.
+fn (t mut maptable) rehash(cap int) {
+	t.index.reset(cap)
+	for i := 0; i < t.len; i++ {
+		t.index.insert(t.entry_hashes[i], i)
 	}
-	if end - start == 1 {
-		first := m.entries[start]
-		C.memcpy(out, first.val, m.element_size)
+}
+
+fn (t mut maptable) resize_entries(cap int) {
+	t.entries_cap = cap
+	t.entry_hashes = &u32(v_realloc(t.entry_hashes, cap * sizeof(u32)))
+	t.entry_keys = &string(v_realloc(t.entry_keys, cap * sizeof(string)))
+	t.entry_vals = v_realloc(t.entry_vals, cap * t.element_size + 1)
+}
+
+fn (t mut maptable) set(key string, val voidptr) {
+	hash := map_hash(key)
+	slot := t.find_slot(key, hash)
+	if slot >= 0 {
+		C.memcpy(t.entry_vals + t.index.idx(slot) * t.element_size, val, t.element_size)
 		return
 	}
-	if mid >= m.entries.len {
-		return
+	if t.len == t.entries_cap {
+		if t.entries_cap == 0 {
+			t.resize_entries(map_min_cap)
+		}
+		else {
+			t.resize_entries(t.entries_cap * 2)
+		}
 	}
-	mid_msg := m.entries[mid]
-	// println('mid.key=$mid_msg.key')
-	if query < mid_msg.key {
-		m.bs(query, start, mid, out)
+	idx := t.len
+	t.entry_hashes[idx] = hash
+	t.entry_keys[idx] = key
+	C.memcpy(t.entry_vals + idx * t.element_size, val, t.element_size)
+	t.len++
+	if t.len * 8 > t.index.cap * 7 {
+		if t.index.cap == 0 {
+			t.rehash(map_min_cap)
+		}
+		else {
+			t.rehash(t.index.cap * 2)
+		}
 		return
 	}
-	m.bs(query, mid, end, out)
+	t.index.insert(hash, idx)
 }
-*/
 
-fn preorder_keys(node &mapnode, keys mut []string, key_i int) int {
-	mut i := key_i
-	if !node.is_empty {
-		keys[i] = node.key
-		i++
+fn (t mut maptable) delete(key string) {
+	slot := t.find_slot(key, map_hash(key))
+	if slot < 0 {
+		return
 	}
-	if !isnil(node.left) {
-		i = preorder_keys(node.left, mut keys, i)
+	idx := t.index.idx(slot)
+	t.index.remove(slot)
+	// Move the last entry into the hole
+	last := t.len - 1
+	if idx != last {
+		t.entry_hashes[idx] = t.entry_hashes[last]
+		t.entry_keys[idx] = t.entry_keys[last]
+		C.memcpy(t.entry_vals + idx * t.element_size, t.entry_vals + last * t.element_size, t.element_size)
+		t.index.move(t.entry_hashes[idx], last, idx)
 	}
-	if !isnil(node.right) {
-		i = preorder_keys(node.right, mut keys, i)
+	t.len--
+	if t.index.cap > map_min_cap && t.len * 8 < t.index.cap {
+		t.rehash(t.index.cap / 2)
+		if t.entries_cap / 2 >= t.len * 2 {
+			t.resize_entries(t.entries_cap / 2)
+		}
+	}
+}
+
+fn (t mut maptable) free() {
+	t.index.free()
+	free(t.entry_hashes)
+	free(t.entry_keys)
+	free(t.entry_vals)
+	free(t)
+}
+
+fn (m mut map) set(key string, val voidptr) {
+	if isnil(m.table) {
+		m.table = new_maptable(m.element_size)
 	}
-	return i
+	m.table.set(key, val)
+	m.size = m.table.len
 }
 
 pub fn (m &map) keys() []string {
-	mut keys := [''].repeat(m.size)
-	if isnil(m.root) {
-		return keys
+	if isnil(m.table) {
+		return []string
+	}
+	mut keys := [''].repeat(m.table.len)
+	if m.table.len > 0 {
+		C.memcpy(keys.data, m.table.entry_keys, m.table.len * sizeof(string))
 	}
-	preorder_keys(m.root, mut keys, 0)
 	return keys
 }
 
 fn (m map) get(key string, out voidptr) bool {
-	//println('g')
-	if m.root == 0 {
+	if isnil(m.table) {
 		return false
 	}
-	return m.root.find(key, out, m.element_size)
-}
-
-pub fn (n mut mapnode) delete(key string, element_size int) {
-	if n.key == key {
-		C.memset(n.val, 0, element_size)
-		n.is_empty = true
-		return
-	}
-	else if n.key > key {
-		if isnil(n.left) {
-			return
-		}  else {
-			n.left.delete(key, element_size)
-		}
-	}
-	else {
-		if isnil(n.right) {
-			return
-		}  else {
-			n.right.delete(key, element_size)
-		}
+	t := m.table
+	slot := t.find_slot(key, map_hash(key))
+	if slot < 0 {
+		return false
 	}
+	C.memcpy(out, t.entry_vals + t.index.idx(slot) * t.element_size, t.element_size)
+	return true
 }
 
 pub fn (m mut map) delete(key string) {
-	m.root.delete(key, m.element_size)
-	m.size--
+	if isnil(m.table) {
+		return
+	}
+	m.table.delete(key)
+	m.size = m.table.len
 }
 
 fn (m map) exists(key string) bool {
-	return !isnil(m.root) && m.root.find2(key, m.element_size)
+	return !isnil(m.table) && m.table.find_slot(key, map_hash(key)) >= 0
 }
 
 pub fn (m map) print() {
 	println('<<<<<<<<')
-	//for i := 0; i < m.entries.len; i++ {
-		// entry := m.entries[i]
-		// println('$entry.key => $entry.val')
-	//}
-	/*
-	for i := 0; i < m.cap * m.element_size; i++ {
-		b := m.table[i]
-		print('$i: ')
-		C.printf('%02x', b)
-		println('')
+	for i := 0; !isnil(m.table) && i < m.table.len; i++ {
+		println('${m.table.entry_keys[i]} => ${m.table.entry_hashes[i]}')
 	}
-*/
 	println('>>>>>>>>>>')
 }
 
-fn (n mut mapnode) free() {
-	if n.val != 0 {
-		free(n.val)
-	}	
-	if n.left != 0 {
-		n.left.free()
-	}	
-	if n.right != 0 {
-		n.right.free()
-	}	
-	free(n)
-}
-
 pub fn (m mut map) free() {
-	if m.root == 0 {
+	if isnil(m.table) {
 		return
-	}	
-	m.root.free()
-	// C.free(m.table)
-	// C.free(m.keys_table)
+	}
+	m.table.free()
+	m.table = 0
+	m.size = 0
 }
 
 pub fn (m map_string) str() string {
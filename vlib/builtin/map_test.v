@@ -1,4 +1,4 @@
-// import time
+import rand
 
 struct User {
 	name string
@@ -85,6 +85,69 @@ fn test_large_map() {
 	//println(time.ticks() - ticks)
 }
 
+fn test_map_delete() {
+	mut m := map[string]int
+	m.delete('missing')
+	assert m.size == 0
+	for i := 0; i < 1000; i++ {
+		m['key$i'] = i
+	}
+	m.delete('missing')
+	assert m.size == 1000
+	// Deleting keeps all the other keys reachable
+	for i := 0; i < 1000; i += 2 {
+		m.delete('key$i')
+	}
+	assert m.size == 500
+	for i := 0; i < 1000; i++ {
+		assert ('key$i' in m) == (i % 2 == 1)
+	}
+	// Shrinking
+	for i := 1; i < 999; i += 2 {
+		m.delete('key$i')
+	}
+	assert m.size == 1
+	assert m['key999'] == 999
+	assert m.keys().len == 1
+	m['a'] = 1
+	keys := m.keys()
+	assert keys.len == 2
+	assert keys[0] == 'key999'
+	assert keys[1] == 'a'
+}
+
+fn test_map_sorted_keys() {
+	mut m := map[string]int
+	N := 100 * 1000
+	for i := 0; i < N; i++ {
+		m[(N + i).str()] = i
+	}
+	assert m.size == N
+	for i := 0; i < N; i += 7 {
+		assert m[(N + i).str()] == i
+	}
+	mut sum := 0
+	for _, val in m {
+		sum += val
+	}
+	assert sum == N * (N - 1) / 2
+}
+
+fn test_random_strings() {
+	mut m := map[string]int
+	for i in 0..1000 {
+		mut buf := []byte
+		for j in 0..10 {
+			buf << byte(rand.next(int(`z`) - int(`a`)) + `a`)
+		}
+		s := string(buf)
+		m[s] = i
+		assert m[s] == i
+	}
+	m['foo'] = 12
+	assert m['foo'] == 12
+}
+
 fn test_various_map_value() {
 	mut m1 := map[string]int
 	m1['test'] = 1
@@ -166,3 +229,105 @@ fn test_ref() {
 	
 }
 */
+
+struct Session {
+	id   int
+	user string
+}
+
+struct Cache {
+mut:
+	sessions map[int]Session
+}
+
+fn test_int_keys() {
+	mut m := map[int]string
+	m[1] = 'one'
+	m[-1] = 'minus one'
+	m[1000000] = 'million'
+	assert m.size == 3
+	assert m[1] == 'one'
+	assert m[-1] == 'minus one'
+	assert m[2] == ''
+	assert 1000000 in m
+	assert !(2 in m)
+	key := -1
+	m.delete(key)
+	assert !(-1 in m)
+	assert m.size == 2
+	mut keys := []int
+	for k, v in m {
+		keys << k
+		assert v == m[k]
+	}
+	assert keys.len == 2
+	assert keys[0] == 1
+	assert keys[1] == 1000000
+	ks := m.keys()
+	assert ks.len == 2
+	assert ks[1] == 1000000
+}
+
+fn test_int_keys_many() {
+	n := 100000
+	mut m := map[int]int
+	for i := 0; i < n; i++ {
+		m[i * 8] = i
+	}
+	assert m.size == n
+	for i := 0; i < n; i++ {
+		assert m[i * 8] == i
+	}
+	assert !(7 in m)
+	for i := 0; i < n; i += 2 {
+		m.delete(i * 8)
+	}
+	assert m.size == n / 2
+	assert m[8] == 1
+	assert m[16] == 0
+	mut sum := i64(0)
+	for _, v in m {
+		sum += i64(v)
+	}
+	assert sum == i64(n / 2) * i64(n / 2)
+}
+
+fn test_u64_and_i64_keys() {
+	mut m := map[u64]int
+	big := u64(0xffffffffffffffff)
+	m[big] = 1
+	m[u64(0)] = 2
+	assert m[big] == 1
+	assert m[u64(0)] == 2
+	for k, _ in m {
+		assert k == big
+		break
+	}
+	mut m2 := map[i64]string
+	m2[i64(-5)] = 'neg'
+	keys := m2.keys()
+	assert keys[0] == i64(-5)
+	mut m3 := map[byte]int
+	m3[byte(200)] = 7
+	assert m3.keys()[0] == byte(200)
+}
+
+fn test_pointer_keys() {
+	a := 1
+	b := 2
+	mut m := map[voidptr]string
+	m[&a] = 'a'
+	m[&b] = 'b'
+	assert m[&a] == 'a'
+	assert m[&b] == 'b'
+	assert m.size == 2
+	m.delete(&a)
+	assert !(&a in m)
+}
+
+fn test_int_map_struct_field() {
+	mut c := Cache{}
+	c.sessions[42] = Session{id: 42, user: 'bob'}
+	assert c.sessions[42].user == 'bob'
+	assert c.sessions.size == 1
+}
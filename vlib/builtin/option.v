@@ -27,6 +27,7 @@ fn opt_none() Option {
 	return Option{ is_none: true }
 }
 
+[cold]
 pub fn error(s string) Option {
 	return Option {
 		error: s
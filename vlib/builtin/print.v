@@ -0,0 +1,199 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+Buffered stdout. What `print()`, `println()`, `print_many()` and
+`write_raw()` write is kept in a buffer of each thread, and written to
+stdout:
+
+- at the end of each call when stdout is a terminal, so that it shows up
+  right away
+- when the buffer is full otherwise (e.g. stdout is a pipe), so that a
+  program that prints a lot of lines makes few writes
+- by `print_flush()` (`os.flush_stdout()`), `panic()`, when the thread
+  exits, and when a task started with `go` returns
+- when the program exits, for all the threads that have a buffer, so what
+  the threads that never exit (the workers of `[parallel]` loops, of the
+  `parallel` module and of `go`) printed isn't lost
+
+At exit, the buffer of the exiting thread is flushed last, and a thread
+still printing then may lose its output, so it should be joined first.
+Each flush holds whole calls, so the lines of different threads aren't
+mixed, but they can come out of order.
+What C functions like `printf()` write isn't in the buffer, call
+`print_flush()` before them.
+
+On Windows the output isn't buffered.
+*/
+
+const (
+	print_buf_size = 65536
+)
+
+struct PrintBuf {
+mut:
+	data byteptr
+	len  int
+	next &PrintBuf // in `print_bufs`
+}
+
+const (
+	print_mode_unknown  = 0 // before `init()`, flushed like a terminal
+	print_mode_terminal = 1
+	print_mode_block    = 2
+)
+
+__global print_mode int
+// The buffers of all the threads, locked by `alloc_sync`
+__global print_bufs &PrintBuf
+
+fn print_init() {
+	if is_atty(1) {
+		print_mode = print_mode_terminal
+	}
+	else {
+		print_mode = print_mode_block
+	}
+	C.atexit(print_flush_all)
+}
+
+fn thread_print_buf() &PrintBuf {
+	mut l := thread_alloc_lists()
+	if isnil(l.out) {
+		mut b := &PrintBuf(C.calloc(1, sizeof(PrintBuf)))
+		b.data = &byte(C.malloc(print_buf_size))
+		alloc_sync.lock()
+		b.next = print_bufs
+		print_bufs = b
+		alloc_sync.unlock()
+		l.out = b
+	}
+	return l.out
+}
+
+// Flushes and frees the buffer of a thread that exits
+fn print_buf_exit(b_ &PrintBuf) {
+	mut b := b_
+	b.flush()
+	alloc_sync.lock()
+	if print_bufs == b {
+		print_bufs = b.next
+	}
+	else {
+		mut prev := print_bufs
+		for prev.next != b {
+			prev = prev.next
+		}
+		prev.next = b.next
+	}
+	alloc_sync.unlock()
+	C.free(b.data)
+	C.free(b)
+}
+
+// At exit, the buffer of this thread last: the others are usually idle
+// workers, and this one printed after waiting for them
+fn print_flush_all() {
+	mut own := thread_alloc_lists().out
+	alloc_sync.lock()
+	mut b := print_bufs
+	for !isnil(b) {
+		if b != own {
+			b.flush()
+		}
+		b = b.next
+	}
+	alloc_sync.unlock()
+	if !isnil(own) {
+		own.flush()
+	}
+}
+
+fn (b mut PrintBuf) write(s byteptr, n int) {
+	if b.len + n > print_buf_size {
+		b.flush()
+		if n > print_buf_size {
+			C.fwrite(s, 1, n, stdout)
+			C.fflush(stdout)
+			return
+		}
+	}
+	C.memcpy(b.data + b.len, s, n)
+	b.len += n
+}
+
+fn (b mut PrintBuf) flush() {
+	if b.len > 0 {
+		C.fwrite(b.data, 1, b.len, stdout)
+		b.len = 0
+	}
+	C.fflush(stdout)
+}
+
+// The end of a call
+fn (b mut PrintBuf) done() {
+	if print_mode != print_mode_block {
+		b.flush()
+	}
+}
+
+// `println(n)` of integers is turned into this by the compiler
+fn println_i64(n i64) {
+	$if windows {
+		println(n.str())
+	} $else {
+		mut digits := [21]byte
+		digits[20] = `\n`
+		mut i := 0
+		if n < i64(0) {
+			i = write_dec(&digits[0], 20, u64(0) - u64(n)) - 1
+			digits[i] = `-`
+		}
+		else {
+			i = write_dec(&digits[0], 20, u64(n))
+		}
+		mut b := thread_print_buf()
+		b.write(&digits[i], 21 - i)
+		b.done()
+	}
+}
+
+// Writes what `print()` and `println()` of this thread have buffered to
+// stdout
+pub fn print_flush() {
+	$if !windows {
+		mut b := thread_print_buf()
+		b.flush()
+	}
+}
+
+// Prints each string of `lines` on its own line, like `println()` for each
+// one but faster
+pub fn print_many(lines []string) {
+	$if windows {
+		for line in lines {
+			println(line)
+		}
+	} $else {
+		mut b := thread_print_buf()
+		for line in lines {
+			b.write(line.str, line.len)
+			b.write('\n'.str, 1)
+		}
+		b.done()
+	}
+}
+
+// Prints the `n` bytes at `s` as they are
+pub fn write_raw(s byteptr, n int) {
+	$if windows {
+		print(tos(s, n))
+	} $else {
+		mut b := thread_print_buf()
+		b.write(s, n)
+		b.done()
+	}
+}
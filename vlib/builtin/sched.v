@@ -0,0 +1,512 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+The runtime behind `go`. `go f(x)` doesn't start a thread: it copies `x` to
+a task and queues it, and a pool of worker threads runs the tasks. The pool
+is started the first time `go` is used, with a worker per CPU.
+
+Each worker has a deque of tasks (Chase and Lev's). The tasks started by a
+task go to the bottom of the deque of its worker, which takes its next task
+from the bottom too, and workers that have nothing to do steal from the top
+of the others'. Tasks started by other threads, or when a deque is full, go
+to a queue shared by all workers.
+
+Tasks can block, on a lock, a channel, I/O or another task, and then the
+tasks queued behind them would wait for as long. A monitor thread checks
+every `monitor_interval` ms while there are queued tasks, and starts another
+worker when none has taken a task since the last check. So there are never
+more workers than tasks that ran at the same time, as when each task had
+its own thread. Workers are never stopped, they sleep when there is nothing
+to do.
+
+`h := go f(x)` returns a handle, and `h.wait()` waits for `f` to return and
+returns what it returned. If the task hasn't started yet, `wait()` runs it
+on the calling thread. `wait()` frees the task, so it must be called once.
+The tasks of `go f(x)` statements are freed when they are done.
+
+A task is a block of `task_block_size` bytes, or a `malloc()` of its size
+if the arguments don't fit. Free blocks are kept in a list of each thread,
+and moved to and from a list shared by all threads half a list at a time.
+
+What a task prints is flushed when it returns, the `print()` buffer of a
+worker would only be flushed when the program exits.
+*/
+
+const (
+	task_queued       = 0
+	task_running      = 1
+	task_done         = 2
+	task_block_size   = 128
+	task_cache_size   = 64 // free blocks a thread keeps
+	deque_size        = 1024 // a power of 2
+	monitor_interval  = 1
+)
+
+// The header of a task. The compiler puts what the function returns and its
+// arguments after it (see `async_fn_call()`).
+struct GoTask {
+mut:
+	run     fn (voidptr) // calls the function with the arguments of the task
+	state   int
+	refs    int // the queue and the handle, it's freed when both drop it
+	waiting int // a thread waits for it in `wait()`
+	pooled  bool
+	next    &GoTask // in the shared queue, or in a list of free blocks
+}
+
+// The tasks of a worker. Only the worker pushes and pops at the bottom, any
+// thread steals at the top.
+struct GoDeque {
+mut:
+	top    i64
+	pad    [56]byte // the top and the bottom in different cache lines
+	bottom i64
+	tasks  &i64 // `deque_size` pointers
+}
+
+struct GoWorker {
+mut:
+	deque GoDeque
+	taken int // tasks it took so far, the monitor checks that it changes
+	seed  u32 // picks the workers to steal from
+}
+
+struct GoSched {
+mut:
+	state        int // 0 not started, 1 starting, 2 started
+	sync         GoSync // see sched_nix.v and sched_win.v
+	nr_workers   int
+	cap_workers  int
+	workers      &i64 // pointers, replaced by a larger copy when it's full
+	idle         int // sleeping workers that weren't woken up yet
+	wakeups      int
+	monitor_idle int
+	queue_head   &GoTask
+	queue_tail   &GoTask
+	queued       int
+	free_tasks   &GoTask
+	nr_free      int
+}
+
+__global go_sched GoSched
+
+// The `__atomic` builtins work on any integer or pointer type, they are
+// declared with the widest one so that casts of their results are plain C
+// casts. They are used here and by the sync module, C functions can only be
+// declared once.
+fn C.__atomic_load_n(voidptr, int) u64
+fn C.__atomic_exchange_n(voidptr, u64, int) u64
+fn C.__atomic_fetch_add(voidptr, u64, int) u64
+
+// Called by the function the compiler generates for each function started
+// with `go`, which copies the arguments to the block then calls
+// `go_task_start()`. `size` is the size of that block.
+fn go_task_new(size int, run fn (voidptr), joinable bool) &GoTask {
+	if go_load(&go_sched.state) != 2 {
+		go_sched_start()
+	}
+	mut t := &GoTask(0)
+	if size <= task_block_size {
+		t = go_alloc_block()
+		t.pooled = true
+	}
+	else {
+		t = &GoTask(C.malloc(size))
+		t.pooled = false
+	}
+	t.run = run
+	t.state = task_queued
+	t.refs = 1
+	if joinable {
+		t.refs = 2
+	}
+	t.waiting = 0
+	t.next = &GoTask(0)
+	return t
+}
+
+// Queues `t` on the deque of this thread's worker, or on the shared queue
+fn go_task_start(t &GoTask) {
+	l := thread_alloc_lists()
+	w := &GoWorker(l.worker)
+	if isnil(w) || !w.deque.push(t) {
+		go_sched.sync.lock()
+		if isnil(go_sched.queue_tail) {
+			go_sched.queue_head = t
+		}
+		else {
+			mut tail := go_sched.queue_tail
+			tail.next = t
+		}
+		go_sched.queue_tail = t
+		go_add(&go_sched.queued, 1)
+		go_sched.sync.unlock()
+	}
+	go_sched.wake_up()
+}
+
+// `h.wait()` on the handle of `go f(x)`. The result is left in the task, and
+// the caller releases it.
+fn go_task_wait(t &GoTask) {
+	if go_cas(&t.state, task_queued, task_running) {
+		go_call(t.run, t)
+		go_store(&t.state, task_done)
+		return
+	}
+	if go_load(&t.state) == task_done {
+		return
+	}
+	// Either `finish()` sees `waiting`, or this sees that it's done
+	go_store(&t.waiting, 1)
+	go_sched.sync.lock()
+	for go_load(&t.state) != task_done {
+		go_sched.sync.wait(&go_sched.sync.done)
+	}
+	go_sched.sync.unlock()
+}
+
+// Frees `t` when both its queue and its handle are done with it
+fn go_task_release(t &GoTask) {
+	if go_add(&t.refs, -1) == 1 {
+		go_free_block(t)
+	}
+}
+
+// The task's function is only known as a pointer, a parameter gives it a
+// type
+fn go_call(run fn (voidptr), t voidptr) {
+	run(t)
+}
+
+fn (t &GoTask) finish() {
+	go_store(&t.state, task_done)
+	if go_load(&t.waiting) != 0 {
+		go_sched.sync.lock()
+		go_sched.sync.done.broadcast()
+		go_sched.sync.unlock()
+	}
+}
+
+fn (d &GoDeque) slot(i i64) &i64 {
+	return &i64(&byte(d.tasks) + int(i & i64(deque_size - 1)) * sizeof(i64))
+}
+
+// Returns false if the deque is full
+fn (d &GoDeque) push(t &GoTask) bool {
+	b := d.bottom
+	if b - go_load_i64(&d.top) >= i64(deque_size) {
+		return false
+	}
+	go_store_i64(d.slot(b), i64(t))
+	go_store_i64(&d.bottom, b + i64(1))
+	return true
+}
+
+fn (d &GoDeque) pop() &GoTask {
+	b := d.bottom - i64(1)
+	go_store_i64(&d.bottom, b)
+	top := go_load_i64(&d.top)
+	if top > b {
+		go_store_i64(&d.bottom, b + i64(1))
+		return &GoTask(0)
+	}
+	mut t := &GoTask(go_load_i64(d.slot(b)))
+	if top == b {
+		// The last task, a thief may be taking it too
+		if !go_cas_i64(&d.top, top, top + i64(1)) {
+			t = &GoTask(0)
+		}
+		go_store_i64(&d.bottom, b + i64(1))
+	}
+	return t
+}
+
+// Returns nil if the deque is empty or another thread took the task first
+fn (d &GoDeque) steal() &GoTask {
+	top := go_load_i64(&d.top)
+	if top >= go_load_i64(&d.bottom) {
+		return &GoTask(0)
+	}
+	t := &GoTask(go_load_i64(d.slot(top)))
+	if !go_cas_i64(&d.top, top, top + i64(1)) {
+		return &GoTask(0)
+	}
+	return t
+}
+
+fn (d &GoDeque) is_empty() bool {
+	return go_load_i64(&d.top) >= go_load_i64(&d.bottom)
+}
+
+fn go_sched_start() {
+	mut s := &go_sched
+	if !go_cas(&s.state, 0, 1) {
+		for go_load(&s.state) != 2 {
+		}
+		return
+	}
+	// `alloc_init()` runs before the workers can call it
+	thread_alloc_lists()
+	s.sync.init()
+	s.cap_workers = 16
+	s.workers = &i64(C.calloc(s.cap_workers, sizeof(i64)))
+	nr_cpus := go_nr_cpus()
+	s.sync.lock()
+	for i := 0; i < nr_cpus; i++ {
+		s.add_worker()
+	}
+	s.sync.unlock()
+	go_start_thread(go_monitor_main, 0)
+	go_store(&s.state, 2)
+}
+
+// `sync` is locked
+fn (s mut GoSched) add_worker() {
+	n := s.nr_workers
+	if n == s.cap_workers {
+		// Threads that are stealing can still be reading the old array, it
+		// is left as it is
+		workers := &i64(C.calloc(2 * n, sizeof(i64)))
+		C.memcpy(workers, s.workers, n * sizeof(i64))
+		s.cap_workers = 2 * n
+		go_store_i64(&s.workers, i64(workers))
+	}
+	mut w := &GoWorker(C.calloc(1, sizeof(GoWorker)))
+	w.deque.tasks = &i64(C.calloc(deque_size, sizeof(i64)))
+	w.seed = u32(n + 1)
+	go_store_i64(go_worker_slot(s.workers, n), i64(w))
+	go_store(&s.nr_workers, n + 1)
+	go_start_thread(go_worker_main, w)
+}
+
+fn go_worker_slot(workers &i64, i int) &i64 {
+	return &i64(&byte(workers) + i * sizeof(i64))
+}
+
+// The array is read after the number, it has at least that many workers
+fn (s &GoSched) worker(i int) &GoWorker {
+	workers := &i64(go_load_i64(&s.workers))
+	return &GoWorker(go_load_i64(go_worker_slot(workers, i)))
+}
+
+fn (s &GoSched) has_work() bool {
+	if go_load(&s.queued) > 0 {
+		return true
+	}
+	n := go_load(&s.nr_workers)
+	for i := 0; i < n; i++ {
+		w := s.worker(i)
+		if !w.deque.is_empty() {
+			return true
+		}
+	}
+	return false
+}
+
+// Wakes up a sleeping worker for a task that was just queued, or the
+// monitor if they are all busy
+fn (s &GoSched) wake_up() {
+	if go_load(&s.idle) > 0 {
+		s.sync.lock()
+		if s.idle > 0 {
+			go_add(&s.idle, -1)
+			go_add(&s.wakeups, 1)
+			s.sync.work.signal()
+		}
+		s.sync.unlock()
+	}
+	else if go_load(&s.monitor_idle) != 0 {
+		s.sync.lock()
+		s.sync.monitor.signal()
+		s.sync.unlock()
+	}
+}
+
+fn (s mut GoSched) pop_queue() &GoTask {
+	s.sync.lock()
+	t := s.queue_head
+	if !isnil(t) {
+		s.queue_head = t.next
+		if isnil(s.queue_head) {
+			s.queue_tail = &GoTask(0)
+		}
+		go_add(&s.queued, -1)
+	}
+	s.sync.unlock()
+	return t
+}
+
+fn go_worker_main(w_ &GoWorker) voidptr {
+	mut w := w_
+	mut l := thread_alloc_lists()
+	l.worker = w
+	for {
+		t := w.find_task()
+		if isnil(t) {
+			w.sleep()
+			continue
+		}
+		go_store(&w.taken, w.taken + 1)
+		if go_cas(&t.state, task_queued, task_running) {
+			go_call(t.run, t)
+			t.finish()
+			if !isnil(l.out) && l.out.len > 0 {
+				mut out := l.out
+				out.flush()
+			}
+		}
+		go_task_release(t)
+	}
+	return voidptr(0)
+}
+
+fn (w mut GoWorker) find_task() &GoTask {
+	mut t := w.deque.pop()
+	if !isnil(t) {
+		return t
+	}
+	mut s := &go_sched
+	if go_load(&s.queued) > 0 {
+		t = s.pop_queue()
+		if !isnil(t) {
+			return t
+		}
+	}
+	n := go_load(&s.nr_workers)
+	// xorshift
+	w.seed ^= w.seed << u32(13)
+	w.seed ^= w.seed >> u32(17)
+	w.seed ^= w.seed << u32(5)
+	start := int(w.seed % u32(n))
+	for i := 0; i < n; i++ {
+		victim := s.worker((start + i) % n)
+		if victim != w {
+			t = victim.deque.steal()
+			if !isnil(t) {
+				return t
+			}
+		}
+	}
+	return &GoTask(0)
+}
+
+// Sleeps until a task is queued. The task is queued before `idle` is read,
+// and `idle` is counted before the queues are checked, so one of the two
+// sees the other.
+fn (w &GoWorker) sleep() {
+	mut s := &go_sched
+	s.sync.lock()
+	go_add(&s.idle, 1)
+	if s.has_work() {
+		go_add(&s.idle, -1)
+		s.sync.unlock()
+		return
+	}
+	for s.wakeups == 0 {
+		s.sync.wait(&s.sync.work)
+	}
+	go_add(&s.wakeups, -1)
+	s.sync.unlock()
+}
+
+fn (s &GoSched) nr_taken() int {
+	mut taken := 0
+	n := go_load(&s.nr_workers)
+	for i := 0; i < n; i++ {
+		w := s.worker(i)
+		taken += go_load(&w.taken)
+	}
+	return taken
+}
+
+// Starts a worker when tasks are queued and no worker took one during the
+// last `monitor_interval` ms, as they may all be blocked
+fn go_monitor_main() voidptr {
+	mut s := &go_sched
+	mut last := -1
+	s.sync.lock()
+	for {
+		if !s.has_work() {
+			go_store(&s.monitor_idle, 1)
+			if !s.has_work() {
+				s.sync.wait(&s.sync.monitor)
+			}
+			go_store(&s.monitor_idle, 0)
+			last = -1
+			continue
+		}
+		s.sync.unlock()
+		go_sleep_ms(monitor_interval)
+		s.sync.lock()
+		taken := s.nr_taken()
+		if taken == last && go_load(&s.idle) == 0 && s.has_work() {
+			s.add_worker()
+		}
+		last = taken
+	}
+	return voidptr(0)
+}
+
+fn go_alloc_block() &GoTask {
+	mut l := thread_alloc_lists()
+	if l.nr_tasks == 0 {
+		mut s := &go_sched
+		s.sync.lock()
+		for s.nr_free > 0 && l.nr_tasks < task_cache_size / 2 {
+			t := s.free_tasks
+			s.free_tasks = t.next
+			s.nr_free--
+			mut t2 := t
+			t2.next = l.tasks
+			l.tasks = t
+			l.nr_tasks++
+		}
+		s.sync.unlock()
+		if l.nr_tasks == 0 {
+			return &GoTask(C.malloc(task_block_size))
+		}
+	}
+	t := l.tasks
+	l.tasks = t.next
+	l.nr_tasks--
+	return t
+}
+
+fn go_free_block(t_ &GoTask) {
+	mut t := t_
+	if !t.pooled {
+		C.free(t)
+		return
+	}
+	mut l := thread_alloc_lists()
+	t.next = l.tasks
+	l.tasks = t
+	l.nr_tasks++
+	if l.nr_tasks > task_cache_size {
+		mut s := &go_sched
+		s.sync.lock()
+		for l.nr_tasks > task_cache_size / 2 {
+			mut b := l.tasks
+			l.tasks = b.next
+			l.nr_tasks--
+			b.next = s.free_tasks
+			s.free_tasks = b
+			s.nr_free++
+		}
+		s.sync.unlock()
+	}
+}
+
+// The free blocks of a thread that exits
+fn go_free_cache(l &AllocLists) {
+	mut t := l.tasks
+	for !isnil(t) {
+		next := t.next
+		C.free(t)
+		t = next
+	}
+}
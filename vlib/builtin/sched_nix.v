@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+struct C.pthread_t {}
+
+// The lock of the pool of `go`, and the conditions its threads wait for:
+// a task to run, a task to be done, and tasks to be queued
+struct GoSync {
+	mutex   C.pthread_mutex_t
+	work    GoCond
+	done    GoCond
+	monitor GoCond
+}
+
+struct GoCond {
+	cond C.pthread_cond_t
+}
+
+fn (s mut GoSync) init() {
+	C.pthread_mutex_init(&s.mutex, 0)
+	C.pthread_cond_init(&s.work.cond, 0)
+	C.pthread_cond_init(&s.done.cond, 0)
+	C.pthread_cond_init(&s.monitor.cond, 0)
+}
+
+fn (s &GoSync) lock() {
+	C.pthread_mutex_lock(&s.mutex)
+}
+
+fn (s &GoSync) unlock() {
+	C.pthread_mutex_unlock(&s.mutex)
+}
+
+// `s` must be locked, it's unlocked while waiting
+fn (s &GoSync) wait(c &GoCond) {
+	C.pthread_cond_wait(&c.cond, &s.mutex)
+}
+
+fn (c &GoCond) signal() {
+	C.pthread_cond_signal(&c.cond)
+}
+
+fn (c &GoCond) broadcast() {
+	C.pthread_cond_broadcast(&c.cond)
+}
+
+// C structs can't be local variables
+struct GoThread {
+	thread C.pthread_t
+}
+
+fn go_start_thread(f, arg voidptr) {
+	t := &GoThread(C.malloc(sizeof(GoThread)))
+	C.pthread_create(&t.thread, 0, f, arg)
+	C.pthread_detach(t.thread)
+	C.free(t)
+}
+
+fn go_nr_cpus() int {
+	n := int(C.sysconf(C._SC_NPROCESSORS_ONLN))
+	if n < 1 {
+		return 1
+	}
+	return n
+}
+
+fn go_sleep_ms(ms int) {
+	C.usleep(ms * 1000)
+}
+
+// The `__atomic` builtins of GCC and Clang, sequentially consistent like the
+// sync module's. On tcc, which has none, the C headers the compiler adds
+// define them with a lock. builtin can't import sync, so these are copies
+// of its `atomic_*` functions.
+
+fn go_load(p &int) int {
+	return int(C.__atomic_load_n(p, C.__ATOMIC_SEQ_CST))
+}
+
+fn go_store(p &int, v int) {
+	C.__atomic_store_n(p, v, C.__ATOMIC_SEQ_CST)
+}
+
+// Returns the value before
+fn go_add(p &int, d int) int {
+	return int(C.__atomic_fetch_add(p, d, C.__ATOMIC_SEQ_CST))
+}
+
+fn go_cas(p &int, old, new int) bool {
+	expected := old
+	return C.__atomic_compare_exchange_n(p, &expected, new, false, C.__ATOMIC_SEQ_CST,
+		C.__ATOMIC_SEQ_CST)
+}
+
+fn go_load_i64(p &i64) i64 {
+	return i64(C.__atomic_load_n(p, C.__ATOMIC_SEQ_CST))
+}
+
+fn go_store_i64(p &i64, v i64) {
+	C.__atomic_store_n(p, v, C.__ATOMIC_SEQ_CST)
+}
+
+fn go_add_i64(p &i64, d i64) i64 {
+	return i64(C.__atomic_fetch_add(p, d, C.__ATOMIC_SEQ_CST))
+}
+
+fn go_cas_i64(p &i64, old, new i64) bool {
+	expected := old
+	return C.__atomic_compare_exchange_n(p, &expected, new, false, C.__ATOMIC_SEQ_CST,
+		C.__ATOMIC_SEQ_CST)
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+// For the parallel module, C structs can only be declared once
+struct C.CONDITION_VARIABLE {}
+
+// The lock of the pool of `go`, and the conditions its threads wait for:
+// a task to run, a task to be done, and tasks to be queued
+struct GoSync {
+	mutex   C.SRWLOCK
+	work    GoCond
+	done    GoCond
+	monitor GoCond
+}
+
+struct GoCond {
+	cond C.CONDITION_VARIABLE
+}
+
+fn (s mut GoSync) init() {
+	C.InitializeSRWLock(&s.mutex)
+	C.InitializeConditionVariable(&s.work.cond)
+	C.InitializeConditionVariable(&s.done.cond)
+	C.InitializeConditionVariable(&s.monitor.cond)
+}
+
+fn (s &GoSync) lock() {
+	C.AcquireSRWLockExclusive(&s.mutex)
+}
+
+fn (s &GoSync) unlock() {
+	C.ReleaseSRWLockExclusive(&s.mutex)
+}
+
+// `s` must be locked, it's unlocked while waiting
+fn (s &GoSync) wait(c &GoCond) {
+	C.SleepConditionVariableSRW(&c.cond, &s.mutex, C.INFINITE, 0)
+}
+
+fn (c &GoCond) signal() {
+	C.WakeConditionVariable(&c.cond)
+}
+
+fn (c &GoCond) broadcast() {
+	C.WakeAllConditionVariable(&c.cond)
+}
+
+fn go_start_thread(f, arg voidptr) {
+	C.CloseHandle(C.CreateThread(0, 0, f, arg, 0, 0))
+}
+
+fn go_nr_cpus() int {
+	n := int(C.GetActiveProcessorCount(C.ALL_PROCESSOR_GROUPS))
+	if n < 1 {
+		return 1
+	}
+	return n
+}
+
+fn go_sleep_ms(ms int) {
+	C.Sleep(ms)
+}
+
+// The `Interlocked` functions are full barriers, they are sequentially
+// consistent like the `__atomic` builtins used on other systems. MSVC has no
+// `__atomic` builtins.
+
+fn C.InterlockedCompareExchange64(voidptr, i64, i64) i64
+fn C.InterlockedExchangeAdd64(voidptr, i64) i64
+
+fn go_load(p &int) int {
+	return int(C.InterlockedCompareExchange(p, 0, 0))
+}
+
+fn go_store(p &int, v int) {
+	C.InterlockedExchange(p, v)
+}
+
+// Returns the value before
+fn go_add(p &int, d int) int {
+	return int(C.InterlockedExchangeAdd(p, d))
+}
+
+fn go_cas(p &int, old, new int) bool {
+	return int(C.InterlockedCompareExchange(p, new, old)) == old
+}
+
+fn go_load_i64(p &i64) i64 {
+	return C.InterlockedCompareExchange64(p, 0, 0)
+}
+
+fn go_store_i64(p &i64, v i64) {
+	C.InterlockedExchange64(p, v)
+}
+
+fn go_add_i64(p &i64, d i64) i64 {
+	return C.InterlockedExchangeAdd64(p, d)
+}
+
+fn go_cas_i64(p &i64, old, new i64) bool {
+	return C.InterlockedCompareExchange64(p, new, old) == old
+}
@@ -0,0 +1,848 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module builtin
+
+/*
+Sorting.
+
+`[]int`, `[]u64` and `[]f64` are sorted with an LSD radix sort: a pass per
+byte of the key, least significant first, each one a counting sort into a
+second buffer. The histograms of all the passes are built in a single read
+of the array, and a pass is skipped if every key has the same byte there
+(e.g. the high bytes of small ints).
+
+`[]string` is sorted with an MSD radix sort: the strings are split into 256
+buckets by their first byte, then each bucket by the second byte, and so
+on. The buckets that get small are sorted with pdqsort, comparing the bytes
+after the prefix they share.
+
+`sort_with_compare()` uses pdqsort too, with the compare function called
+through a pointer, since V doesn't generate code per element type.
+
+pdqsort (pattern-defeating quicksort, by Orson Peters) is introsort with:
+ - insertion sort for ranges of fewer than 24 elements
+ - the median of 3 as the pivot, or the pseudomedian of 9 above 128
+ - if partitioning didn't move anything, the range is probably sorted, and
+   an insertion sort that gives up after 8 moves finishes it in O(n)
+ - if the pivot is equal to the one of the parent range (the element just
+   before the range), everything equal to it is put on the left and is
+   done, so many equal elements take O(n)
+ - an unbalanced partition swaps a few elements around to break patterns,
+   and after log2(n) of them the range is heapsorted (O(n log n) at worst)
+*/
+
+const (
+	insertion_sort_threshold     = 24
+	ninther_threshold            = 128
+	partial_insertion_sort_limit = 8
+	// Below this many elements, radix sorting isn't worth clearing the
+	// histograms for
+	radix_sort_threshold         = 64
+	// Buckets of the string MSD radix sort with fewer strings are pdqsorted
+	msd_sort_threshold           = 32
+)
+
+fn log2_floor(n int) int {
+	mut log := 0
+	mut x := n
+	for x > 1 {
+		x = x >> 1
+		log++
+	}
+	return log
+}
+
+// ===== pdqsort with a compare function, for any element type =====
+
+// The array being sorted, and room for the elements that are held aside
+struct SortCtx {
+	data  byteptr
+	size  int
+	tmp   byteptr // for swaps
+	pivot byteptr
+	hole  byteptr // the element being inserted by the insertion sorts
+}
+
+[inline] fn (c &SortCtx) at(i int) byteptr {
+	return c.data + i * c.size
+}
+
+[inline] fn (c &SortCtx) swap(i, j int) {
+	C.memcpy(c.tmp, c.at(i), c.size)
+	C.memcpy(c.at(i), c.at(j), c.size)
+	C.memcpy(c.at(j), c.tmp, c.size)
+}
+
+[inline] fn (c &SortCtx) sort2(cmp fn (voidptr, voidptr) int, i, j int) {
+	if cmp(c.at(j), c.at(i)) < 0 {
+		c.swap(i, j)
+	}
+}
+
+[inline] fn (c &SortCtx) sort3(cmp fn (voidptr, voidptr) int, i, j, k int) {
+	c.sort2(cmp, i, j)
+	c.sort2(cmp, j, k)
+	c.sort2(cmp, i, j)
+}
+
+// `unguarded`: the element before `begin` is <= every element of the range,
+// so it stops the scans
+fn (c &SortCtx) insertion_sort(cmp fn (voidptr, voidptr) int, begin, end int, unguarded bool) {
+	for i := begin + 1; i < end; i++ {
+		if cmp(c.at(i), c.at(i - 1)) >= 0 {
+			continue
+		}
+		C.memcpy(c.hole, c.at(i), c.size)
+		mut j := i - 1
+		for (unguarded || j > begin) && cmp(c.hole, c.at(j - 1)) < 0 {
+			j--
+		}
+		C.memmove(c.at(j + 1), c.at(j), (i - j) * c.size)
+		C.memcpy(c.at(j), c.hole, c.size)
+	}
+}
+
+// Returns false if more than `partial_insertion_sort_limit` elements had
+// to be moved, the range is then only partly sorted
+fn (c &SortCtx) partial_insertion_sort(cmp fn (voidptr, voidptr) int, begin, end int) bool {
+	mut moved := 0
+	for i := begin + 1; i < end; i++ {
+		if cmp(c.at(i), c.at(i - 1)) >= 0 {
+			continue
+		}
+		C.memcpy(c.hole, c.at(i), c.size)
+		mut j := i - 1
+		for j > begin && cmp(c.hole, c.at(j - 1)) < 0 {
+			j--
+		}
+		C.memmove(c.at(j + 1), c.at(j), (i - j) * c.size)
+		C.memcpy(c.at(j), c.hole, c.size)
+		moved += i - j
+		if moved > partial_insertion_sort_limit {
+			return false
+		}
+	}
+	return true
+}
+
+fn (c &SortCtx) sift_down(cmp fn (voidptr, voidptr) int, base, root_, n int) {
+	mut root := root_
+	for {
+		mut child := 2 * root + 1
+		if child >= n {
+			return
+		}
+		if child + 1 < n && cmp(c.at(base + child), c.at(base + child + 1)) < 0 {
+			child++
+		}
+		if cmp(c.at(base + root), c.at(base + child)) >= 0 {
+			return
+		}
+		c.swap(base + root, base + child)
+		root = child
+	}
+}
+
+fn (c &SortCtx) heapsort(cmp fn (voidptr, voidptr) int, begin, end int) {
+	n := end - begin
+	for i := n / 2 - 1; i >= 0; i-- {
+		c.sift_down(cmp, begin, i, n)
+	}
+	for i := n - 1; i > 0; i-- {
+		c.swap(begin, begin + i)
+		c.sift_down(cmp, begin, 0, i)
+	}
+}
+
+// Partitions the range around its first element, the pivot. The elements
+// equal to it go to the right. Returns where the pivot ends up, and whether
+// the range was partitioned already.
+fn (c &SortCtx) partition_right(cmp fn (voidptr, voidptr) int, begin, end int) (int, bool) {
+	C.memcpy(c.pivot, c.at(begin), c.size)
+	mut first := begin + 1
+	mut last := end - 1
+	// The pivot is a median, so there is an element >= it on the right, and
+	// one <= it on the left, and the scans can't run off the range (except
+	// on the right when nothing was smaller, hence `first < last`)
+	for cmp(c.at(first), c.pivot) < 0 {
+		first++
+	}
+	if first - 1 == begin {
+		for first < last && cmp(c.at(last), c.pivot) >= 0 {
+			last--
+		}
+	}
+	else {
+		for cmp(c.at(last), c.pivot) >= 0 {
+			last--
+		}
+	}
+	already_partitioned := first >= last
+	for first < last {
+		c.swap(first, last)
+		first++
+		for cmp(c.at(first), c.pivot) < 0 {
+			first++
+		}
+		last--
+		for cmp(c.at(last), c.pivot) >= 0 {
+			last--
+		}
+	}
+	pivot_pos := first - 1
+	C.memcpy(c.at(begin), c.at(pivot_pos), c.size)
+	C.memcpy(c.at(pivot_pos), c.pivot, c.size)
+	return pivot_pos, already_partitioned
+}
+
+// Like `partition_right()`, but the elements equal to the pivot go to the
+// left. Only called when they are all >= the pivot.
+fn (c &SortCtx) partition_left(cmp fn (voidptr, voidptr) int, begin, end int) int {
+	C.memcpy(c.pivot, c.at(begin), c.size)
+	mut first := begin + 1
+	mut last := end - 1
+	for cmp(c.pivot, c.at(last)) < 0 {
+		last--
+	}
+	if last + 1 == end {
+		for first < last && cmp(c.pivot, c.at(first)) >= 0 {
+			first++
+		}
+	}
+	else {
+		for cmp(c.pivot, c.at(first)) >= 0 {
+			first++
+		}
+	}
+	for first < last {
+		c.swap(first, last)
+		last--
+		for cmp(c.pivot, c.at(last)) < 0 {
+			last--
+		}
+		first++
+		for cmp(c.pivot, c.at(first)) >= 0 {
+			first++
+		}
+	}
+	C.memcpy(c.at(begin), c.at(last), c.size)
+	C.memcpy(c.at(last), c.pivot, c.size)
+	return last
+}
+
+fn (c &SortCtx) pdqsort(cmp fn (voidptr, voidptr) int, begin_, end int, bad_allowed_ int, leftmost_ bool) {
+	mut begin := begin_
+	mut bad_allowed := bad_allowed_
+	mut leftmost := leftmost_
+	for {
+		size := end - begin
+		if size < insertion_sort_threshold {
+			c.insertion_sort(cmp, begin, end, !leftmost)
+			return
+		}
+		s2 := size / 2
+		if size > ninther_threshold {
+			c.sort3(cmp, begin, begin + s2, end - 1)
+			c.sort3(cmp, begin + 1, begin + s2 - 1, end - 2)
+			c.sort3(cmp, begin + 2, begin + s2 + 1, end - 3)
+			c.sort3(cmp, begin + s2 - 1, begin + s2, begin + s2 + 1)
+			c.swap(begin, begin + s2)
+		}
+		else {
+			c.sort3(cmp, begin + s2, begin, end - 1)
+		}
+		if !leftmost && cmp(c.at(begin - 1), c.at(begin)) >= 0 {
+			begin = c.partition_left(cmp, begin, end) + 1
+			continue
+		}
+		pivot_pos, already_partitioned := c.partition_right(cmp, begin, end)
+		l_size := pivot_pos - begin
+		r_size := end - (pivot_pos + 1)
+		if l_size < size / 8 || r_size < size / 8 {
+			bad_allowed--
+			if bad_allowed == 0 {
+				c.heapsort(cmp, begin, end)
+				return
+			}
+			if l_size >= insertion_sort_threshold {
+				c.swap(begin, begin + l_size / 4)
+				c.swap(pivot_pos - 1, pivot_pos - l_size / 4)
+				if l_size > ninther_threshold {
+					c.swap(begin + 1, begin + l_size / 4 + 1)
+					c.swap(begin + 2, begin + l_size / 4 + 2)
+					c.swap(pivot_pos - 2, pivot_pos - l_size / 4 - 1)
+					c.swap(pivot_pos - 3, pivot_pos - l_size / 4 - 2)
+				}
+			}
+			if r_size >= insertion_sort_threshold {
+				c.swap(pivot_pos + 1, pivot_pos + 1 + r_size / 4)
+				c.swap(end - 1, end - r_size / 4)
+				if r_size > ninther_threshold {
+					c.swap(pivot_pos + 2, pivot_pos + 2 + r_size / 4)
+					c.swap(pivot_pos + 3, pivot_pos + 3 + r_size / 4)
+					c.swap(end - 2, end - 1 - r_size / 4)
+					c.swap(end - 3, end - 2 - r_size / 4)
+				}
+			}
+		}
+		else if already_partitioned &&
+			c.partial_insertion_sort(cmp, begin, pivot_pos) &&
+			c.partial_insertion_sort(cmp, pivot_pos + 1, end) {
+			return
+		}
+		c.pdqsort(cmp, begin, pivot_pos, bad_allowed, leftmost)
+		begin = pivot_pos + 1
+		leftmost = false
+	}
+}
+
+// `compare` is only known as a pointer by `sort_with_compare()`, a field
+// gives it a type
+struct SortCompare {
+	cmp fn (voidptr, voidptr) int
+}
+
+// `compare(a, b voidptr) int` gets pointers to the two elements, and returns
+// a negative number if `a` goes first, a positive one if `b` does, or 0.
+// The sort isn't stable.
+pub fn (a mut array) sort_with_compare(compare voidptr) {
+	if a.len < 2 {
+		return
+	}
+	buf := malloc(3 * a.element_size)
+	c := SortCtx {
+		data: a.data
+		size: a.element_size
+		tmp: buf
+		pivot: buf + a.element_size
+		hole: buf + 2 * a.element_size
+	}
+	f := SortCompare{ cmp: compare }
+	c.pdqsort(f.cmp, 0, a.len, log2_floor(a.len), true)
+	free(buf)
+}
+
+// ===== pdqsort for strings, comparing the bytes after the first `d` =====
+
+// Bytes before `d` are the same in `a` and `b`
+[inline] fn str_lt(a, b string, d int) bool {
+	mut n := a.len
+	if b.len < n {
+		n = b.len
+	}
+	if n > d {
+		res := C.memcmp(a.str + d, b.str + d, n - d)
+		if res != 0 {
+			return res < 0
+		}
+	}
+	return a.len < b.len
+}
+
+[inline] fn swap_strings(a_ &string, i, j int) {
+	mut a := a_
+	t := a[i]
+	a[i] = a[j]
+	a[j] = t
+}
+
+[inline] fn sort2_strings(a &string, d, i, j int) {
+	if str_lt(a[j], a[i], d) {
+		swap_strings(a, i, j)
+	}
+}
+
+[inline] fn sort3_strings(a &string, d, i, j, k int) {
+	sort2_strings(a, d, i, j)
+	sort2_strings(a, d, j, k)
+	sort2_strings(a, d, i, j)
+}
+
+fn insertion_sort_strings(a_ &string, d, begin, end int, unguarded bool) {
+	mut a := a_
+	for i := begin + 1; i < end; i++ {
+		x := a[i]
+		mut j := i
+		for (unguarded || j > begin) && str_lt(x, a[j - 1], d) {
+			a[j] = a[j - 1]
+			j--
+		}
+		a[j] = x
+	}
+}
+
+fn partial_insertion_sort_strings(a_ &string, d, begin, end int) bool {
+	mut a := a_
+	mut moved := 0
+	for i := begin + 1; i < end; i++ {
+		x := a[i]
+		if !str_lt(x, a[i - 1], d) {
+			continue
+		}
+		mut j := i
+		for j > begin && str_lt(x, a[j - 1], d) {
+			a[j] = a[j - 1]
+			j--
+		}
+		a[j] = x
+		moved += i - j
+		if moved > partial_insertion_sort_limit {
+			return false
+		}
+	}
+	return true
+}
+
+fn heapsort_strings(a &string, d, begin, end int) {
+	n := end - begin
+	for i := n / 2 - 1; i >= 0; i-- {
+		sift_down_strings(a, d, begin, i, n)
+	}
+	for i := n - 1; i > 0; i-- {
+		swap_strings(a, begin, begin + i)
+		sift_down_strings(a, d, begin, 0, i)
+	}
+}
+
+fn sift_down_strings(a &string, d, base, root_, n int) {
+	mut root := root_
+	for {
+		mut child := 2 * root + 1
+		if child >= n {
+			return
+		}
+		if child + 1 < n && str_lt(a[base + child], a[base + child + 1], d) {
+			child++
+		}
+		if !str_lt(a[base + root], a[base + child], d) {
+			return
+		}
+		swap_strings(a, base + root, base + child)
+		root = child
+	}
+}
+
+fn partition_right_strings(a_ &string, d, begin, end int) (int, bool) {
+	mut a := a_
+	pivot := a[begin]
+	mut first := begin + 1
+	mut last := end - 1
+	for str_lt(a[first], pivot, d) {
+		first++
+	}
+	if first - 1 == begin {
+		for first < last && !str_lt(a[last], pivot, d) {
+			last--
+		}
+	}
+	else {
+		for !str_lt(a[last], pivot, d) {
+			last--
+		}
+	}
+	already_partitioned := first >= last
+	for first < last {
+		swap_strings(a, first, last)
+		first++
+		for str_lt(a[first], pivot, d) {
+			first++
+		}
+		last--
+		for !str_lt(a[last], pivot, d) {
+			last--
+		}
+	}
+	pivot_pos := first - 1
+	a[begin] = a[pivot_pos]
+	a[pivot_pos] = pivot
+	return pivot_pos, already_partitioned
+}
+
+fn partition_left_strings(a_ &string, d, begin, end int) int {
+	mut a := a_
+	pivot := a[begin]
+	mut first := begin + 1
+	mut last := end - 1
+	for str_lt(pivot, a[last], d) {
+		last--
+	}
+	if last + 1 == end {
+		for first < last && !str_lt(pivot, a[first], d) {
+			first++
+		}
+	}
+	else {
+		for !str_lt(pivot, a[first], d) {
+			first++
+		}
+	}
+	for first < last {
+		swap_strings(a, first, last)
+		last--
+		for str_lt(pivot, a[last], d) {
+			last--
+		}
+		first++
+		for !str_lt(pivot, a[first], d) {
+			first++
+		}
+	}
+	a[begin] = a[last]
+	a[last] = pivot
+	return last
+}
+
+fn pdqsort_strings(a &string, d, begin_, end int, bad_allowed_ int, leftmost_ bool) {
+	mut begin := begin_
+	mut bad_allowed := bad_allowed_
+	mut leftmost := leftmost_
+	for {
+		size := end - begin
+		if size < insertion_sort_threshold {
+			insertion_sort_strings(a, d, begin, end, !leftmost)
+			return
+		}
+		s2 := size / 2
+		if size > ninther_threshold {
+			sort3_strings(a, d, begin, begin + s2, end - 1)
+			sort3_strings(a, d, begin + 1, begin + s2 - 1, end - 2)
+			sort3_strings(a, d, begin + 2, begin + s2 + 1, end - 3)
+			sort3_strings(a, d, begin + s2 - 1, begin + s2, begin + s2 + 1)
+			swap_strings(a, begin, begin + s2)
+		}
+		else {
+			sort3_strings(a, d, begin + s2, begin, end - 1)
+		}
+		if !leftmost && !str_lt(a[begin - 1], a[begin], d) {
+			begin = partition_left_strings(a, d, begin, end) + 1
+			continue
+		}
+		pivot_pos, already_partitioned := partition_right_strings(a, d, begin, end)
+		l_size := pivot_pos - begin
+		r_size := end - (pivot_pos + 1)
+		if l_size < size / 8 || r_size < size / 8 {
+			bad_allowed--
+			if bad_allowed == 0 {
+				heapsort_strings(a, d, begin, end)
+				return
+			}
+			if l_size >= insertion_sort_threshold {
+				swap_strings(a, begin, begin + l_size / 4)
+				swap_strings(a, pivot_pos - 1, pivot_pos - l_size / 4)
+				if l_size > ninther_threshold {
+					swap_strings(a, begin + 1, begin + l_size / 4 + 1)
+					swap_strings(a, begin + 2, begin + l_size / 4 + 2)
+					swap_strings(a, pivot_pos - 2, pivot_pos - l_size / 4 - 1)
+					swap_strings(a, pivot_pos - 3, pivot_pos - l_size / 4 - 2)
+				}
+			}
+			if r_size >= insertion_sort_threshold {
+				swap_strings(a, pivot_pos + 1, pivot_pos + 1 + r_size / 4)
+				swap_strings(a, end - 1, end - r_size / 4)
+				if r_size > ninther_threshold {
+					swap_strings(a, pivot_pos + 2, pivot_pos + 2 + r_size / 4)
+					swap_strings(a, pivot_pos + 3, pivot_pos + 3 + r_size / 4)
+					swap_strings(a, end - 2, end - 1 - r_size / 4)
+					swap_strings(a, end - 3, end - 2 - r_size / 4)
+				}
+			}
+		}
+		else if already_partitioned &&
+			partial_insertion_sort_strings(a, d, begin, pivot_pos) &&
+			partial_insertion_sort_strings(a, d, pivot_pos + 1, end) {
+			return
+		}
+		pdqsort_strings(a, d, begin, pivot_pos, bad_allowed, leftmost)
+		begin = pivot_pos + 1
+		leftmost = false
+	}
+}
+
+// ===== MSD radix sort for strings =====
+
+// Sorts `a[begin..end]`, whose strings all start with the same `d` bytes.
+// `tmp` has room for as many strings as `a`, `keys` for as many u16.
+fn msd_sort_strings(a, tmp_ &string, keys_ &u16, begin, end, d_ int) {
+	mut tmp := tmp_
+	mut keys := keys_
+	mut d := d_
+	n := end - begin
+	if n < msd_sort_threshold {
+		pdqsort_strings(a, d, begin, end, log2_floor(n), true)
+		return
+	}
+	mut counts := [257]int
+	mut key := 0
+	for {
+		// Bucket 0 is for the strings that end before `d`, they go first
+		for i := 0; i < 257; i++ {
+			counts[i] = 0
+		}
+		for i := begin; i < end; i++ {
+			s := a[i]
+			key = 0
+			if s.len > d {
+				key = int(s.str[d]) + 1
+			}
+			keys[i] = key
+			counts[key]++
+		}
+		// All the strings have the same next byte, skip it
+		if counts[key] == n && key != 0 {
+			d++
+			continue
+		}
+		break
+	}
+	mut sum := begin
+	for i := 0; i < 257; i++ {
+		count := counts[i]
+		counts[i] = sum
+		sum += count
+	}
+	for i := begin; i < end; i++ {
+		k := int(keys[i])
+		tmp[counts[k]] = a[i]
+		counts[k]++
+	}
+	C.memcpy(&a[begin], &tmp[begin], n * sizeof(string))
+	// `counts[i]` is now where bucket `i` ends. Bucket 0 is done.
+	for i := 1; i < 257; i++ {
+		start := counts[i - 1]
+		if counts[i] - start > 1 {
+			msd_sort_strings(a, tmp, keys, start, counts[i], d + 1)
+		}
+	}
+}
+
+fn sort_strings(a &string, n int) {
+	if n < msd_sort_threshold {
+		pdqsort_strings(a, 0, 0, n, log2_floor(n), true)
+		return
+	}
+	tmp := &string(malloc(n * sizeof(string)))
+	keys := &u16(malloc(n * sizeof(u16)))
+	msd_sort_strings(a, tmp, keys, 0, n, 0)
+	free(keys)
+	free(tmp)
+}
+
+// ===== LSD radix sorts =====
+
+fn insertion_sort_u64(a_ &u64, n int) {
+	mut a := a_
+	for i := 1; i < n; i++ {
+		x := a[i]
+		mut j := i
+		for j > 0 && x < a[j - 1] {
+			a[j] = a[j - 1]
+			j--
+		}
+		a[j] = x
+	}
+}
+
+// Sorts the ints as u32 keys, with the sign bit flipped so that the
+// negative ones go first
+fn radix_sort_ints(a_ &int, n int) {
+	mut a := a_
+	if n < radix_sort_threshold {
+		for i := 1; i < n; i++ {
+			x := a[i]
+			mut j := i
+			for j > 0 && x < a[j - 1] {
+				a[j] = a[j - 1]
+				j--
+			}
+			a[j] = x
+		}
+		return
+	}
+	mut counts := [1024]int
+	for i := 0; i < n; i++ {
+		k := u32(a[i]) ^ u32(0x80000000)
+		counts[int(k & u32(0xff))]++
+		counts[256 + int(u32(k >> u32(8)) & u32(0xff))]++
+		counts[512 + int(u32(k >> u32(16)) & u32(0xff))]++
+		counts[768 + int(u32(k >> u32(24)))]++
+	}
+	buf := &int(malloc(n * sizeof(int)))
+	mut src := a
+	mut dst := buf
+	for pass := 0; pass < 4; pass++ {
+		shift := u32(pass * 8)
+		c := pass * 256
+		first := int(u32(u32(u32(src[0]) ^ u32(0x80000000)) >> shift) & u32(0xff))
+		if counts[c + first] == n {
+			continue
+		}
+		mut sum := 0
+		for i := 0; i < 256; i++ {
+			count := counts[c + i]
+			counts[c + i] = sum
+			sum += count
+		}
+		for i := 0; i < n; i++ {
+			x := src[i]
+			digit := c + int(u32(u32(u32(x) ^ u32(0x80000000)) >> shift) & u32(0xff))
+			dst[counts[digit]] = x
+			counts[digit]++
+		}
+		t := src
+		src = dst
+		dst = t
+	}
+	if src != a {
+		C.memcpy(a, src, n * sizeof(int))
+	}
+	free(buf)
+}
+
+// If `idx` isn't nil, its elements are moved along with the keys. The sort
+// is stable.
+fn radix_sort_u64(a &u64, idx &int, n int) {
+	if n < radix_sort_threshold && isnil(idx) {
+		insertion_sort_u64(a, n)
+		return
+	}
+	mut counts := [2048]int
+	for i := 0; i < n; i++ {
+		k := a[i]
+		for b := 0; b < 8; b++ {
+			counts[b * 256 + int(u64(k >> u64(b * 8)) & u64(0xff))]++
+		}
+	}
+	buf := &u64(malloc(n * sizeof(u64)))
+	mut src := a
+	mut dst := buf
+	mut idx_buf := &int(0)
+	mut idx_src := idx
+	mut idx_dst := &int(0)
+	if !isnil(idx) {
+		idx_buf = &int(malloc(n * sizeof(int)))
+		idx_dst = idx_buf
+	}
+	for pass := 0; pass < 8; pass++ {
+		shift := u64(pass * 8)
+		c := pass * 256
+		if counts[c + int(u64(src[0] >> shift) & u64(0xff))] == n {
+			continue
+		}
+		mut sum := 0
+		for i := 0; i < 256; i++ {
+			count := counts[c + i]
+			counts[c + i] = sum
+			sum += count
+		}
+		if isnil(idx) {
+			for i := 0; i < n; i++ {
+				x := src[i]
+				digit := c + int(u64(x >> shift) & u64(0xff))
+				dst[counts[digit]] = x
+				counts[digit]++
+			}
+		}
+		else {
+			for i := 0; i < n; i++ {
+				x := src[i]
+				digit := c + int(u64(x >> shift) & u64(0xff))
+				dst[counts[digit]] = x
+				idx_dst[counts[digit]] = idx_src[i]
+				counts[digit]++
+			}
+			t := idx_src
+			idx_src = idx_dst
+			idx_dst = t
+		}
+		t := src
+		src = dst
+		dst = t
+	}
+	if src != a {
+		C.memcpy(a, src, n * sizeof(u64))
+		if !isnil(idx) {
+			C.memcpy(idx, idx_src, n * sizeof(int))
+		}
+	}
+	free(buf)
+	if !isnil(idx) {
+		free(idx_buf)
+	}
+}
+
+pub fn (a mut []int) sort() {
+	radix_sort_ints(&int(a.data), a.len)
+}
+
+pub fn (a mut []u64) sort() {
+	radix_sort_u64(&u64(a.data), &int(0), a.len)
+}
+
+// NaNs go after +inf (or before -inf if their sign bit is set)
+pub fn (a mut []f64) sort() {
+	// The bits of an f64, with the sign bit flipped for positive numbers,
+	// and all of them flipped for negative ones, sort like the numbers
+	mut keys := &u64(a.data)
+	for i := 0; i < a.len; i++ {
+		k := keys[i]
+		if u64(k >> u64(63)) == 0 {
+			keys[i] = k ^ u64(0x8000000000000000)
+		}
+		else {
+			keys[i] = ~k
+		}
+	}
+	radix_sort_u64(keys, &int(0), a.len)
+	for i := 0; i < a.len; i++ {
+		k := keys[i]
+		if u64(k >> u64(63)) == 1 {
+			keys[i] = k ^ u64(0x8000000000000000)
+		}
+		else {
+			keys[i] = ~k
+		}
+	}
+}
+
+pub fn (s mut []string) sort() {
+	sort_strings(&string(s.data), s.len)
+}
+
+struct SortKey {
+	key fn (voidptr) i64
+}
+
+fn call_sort_key(key fn (voidptr) i64, elm voidptr) i64 {
+	return key(elm)
+}
+
+// Sorts by the i64 that `key(elm voidptr) i64` returns for a pointer to
+// each element: `people.sort_by_key(person_age)`. `key` is called once per
+// element (unlike the compare function of `sort_with_compare()`, called
+// O(n log n) times), and the sort is stable.
+pub fn (a mut array) sort_by_key(key voidptr) {
+	if a.len < 2 {
+		return
+	}
+	k := SortKey{ key: key }
+	mut keys := &u64(malloc(a.len * sizeof(u64)))
+	mut idx := &int(malloc(a.len * sizeof(int)))
+	for i := 0; i < a.len; i++ {
+		// Flip the sign bit, so that the negative keys go first
+		keys[i] = u64(call_sort_key(k.key, a.data + i * a.element_size)) ^
+			u64(0x8000000000000000)
+		idx[i] = i
+	}
+	radix_sort_u64(keys, idx, a.len)
+	size := a.element_size
+	sorted := malloc(a.len * size)
+	for i := 0; i < a.len; i++ {
+		C.memcpy(sorted + i * size, a.data + idx[i] * size, size)
+	}
+	C.memcpy(a.data, sorted, a.len * size)
+	free(sorted)
+	free(idx)
+	free(keys)
+}
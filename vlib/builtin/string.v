@@ -18,13 +18,22 @@ NB: A V string should be/is immutable from the point of view of
     strictly necessary from the V point of view, that additional 0
     is *very useful for C interoperability*.
 
+    The exception are substrings (`substr()`, and everything built on
+    it, like `left()`, `all_after()`, `split()` and `trim()`): they are
+    views into the bytes of the string they are in, so they don't
+    allocate, and they are followed by the rest of that string instead
+    of a 0. Call `.cstr()` to get a 0 terminated pointer (it copies
+    substrings, free the copy with `.free_cstr()`), and `.clone()` to get
+    a copy that outlives the original string. Substrings know they are
+    views, and `free()` does nothing on them.
+
     The V string implementation also has an integer .len field,
     containing the length of the .str field, excluding the
     terminating 0 (just like the C's strlen(s) would do).
 
     The 0 ending of .str, and the .len field, mean that in practice:
       a) a V string s can be used very easily, wherever a
-         C string is needed, just by passing s.str,
+         C string is needed, just by passing s.cstr(),
          without a need for further conversion/copying.
 
       b) where strlen(s) is needed, you can just pass s.len,
@@ -42,17 +51,16 @@ NB: A V string should be/is immutable from the point of view of
 */
 
 struct string {
-//mut:
-	//hash_cache int
+	is_view bool // made by `substr()`, the bytes belong to another string
 pub:
-	str byteptr // points to a C style 0 terminated string of bytes.
-	len int     // the length of the .str field, excluding the ending 0 byte. It is always equal to strlen(.str).
+	str byteptr // points to a C style 0 terminated string of bytes (unless it's a substring, see above).
+	len int     // the length of the .str field, excluding the ending 0 byte.
 }
 
 struct ustring {
+	runes []int // the byte offset of each code point, empty if they are all ASCII
 pub:
 	s     string
-	runes []int
 	len   int
 }
 
@@ -66,10 +74,15 @@ pub fn vstrlen(s byteptr) int {
 fn todo() { }
 
 // Converts a C string to a V string.
-// String data is reused, not copied.
+// String data is reused, not copied. `cstr()` returns `s` as it is, so
+// `s[len]` should be a 0 if the string is passed to C.
 pub fn tos(s byteptr, len int) string {
-	// This should never happen.
 	if s == 0 {
+		// An empty array has no data yet
+		if len == 0 {
+			return ''
+		}
+		// This should never happen.
 		panic('tos(): nil string')
 	}
 	return string {
@@ -112,20 +125,11 @@ pub fn (a string) clone() string {
 		len: a.len
 		str: malloc(a.len + 1)
 	}
-	for i := 0; i < a.len; i++ {
-		b[i] = a[i]
-	}
+	C.memcpy(b.str, a.str, a.len)
 	b[a.len] = `\0`
 	return b
 }
 
-/*
-pub fn (s string) cstr() byteptr {
-	clone := s.clone()
-	return clone.str
-}
-*/
-
 pub fn (s string) replace(rep, with string) string {
 	if s.len == 0 || rep.len == 0 {
 		return s
@@ -133,15 +137,14 @@ pub fn (s string) replace(rep, with string) string {
 	// TODO PERF Allocating ints is expensive. Should be a stack array
 	// Get locations of all reps within this string
 	mut idxs := []int
-	mut rem := s
-	mut rstart := 0
+	mut idx := 0
 	for {
-		mut i := rem.index(rep)
-		if i < 0 {break}
-		idxs << rstart + i
-		i += rep.len
-		rstart += i
-		rem = rem.substr(i, rem.len)
+		idx = s.index_after(rep, idx)
+		if idx < 0 {
+			break
+		}
+		idxs << idx
+		idx += rep.len
 	}
 	// Dont change the string if there's nothing to replace
 	if idxs.len == 0 {
@@ -150,67 +153,203 @@ pub fn (s string) replace(rep, with string) string {
 	// Now we know the number of replacements we need to do and we can calc the len of the new string
 	new_len := s.len + idxs.len * (with.len - rep.len)
 	mut b := malloc(new_len + 1)// add a newline just in case
-	// Fill the new string
-	mut idx_pos := 0
-	mut cur_idx := idxs[idx_pos]
+	// Copy the parts between the reps, and `with` instead of each rep
 	mut b_i := 0
-	for i := 0; i < s.len; i++ {
-		// Reached the location of rep, replace it with "with"
-		if i == cur_idx {
-			for j := 0; j < with.len; j++ {
-				b[b_i] = with[j]
-				b_i++
+	mut s_i := 0
+	for i in idxs {
+		C.memcpy(b + b_i, s.str + s_i, i - s_i)
+		b_i += i - s_i
+		C.memcpy(b + b_i, with.str, with.len)
+		b_i += with.len
+		s_i = i + rep.len
+	}
+	C.memcpy(b + b_i, s.str + s_i, s.len - s_i)
+	b[new_len] = `\0`
+	return tos(b, new_len)
+}
+
+// The integer at the start of `s`, after spaces and a `+` or `-`, like C's
+// `strtoull()`: with `auto_base`, `0x` starts a hexadecimal number and `0`
+// an octal one, otherwise it is decimal. Returns its absolute value, and
+// whether it is negative. It wraps around if it doesn't fit in a u64.
+fn parse_uint(s string, auto_base bool) (u64, bool) {
+	str := s.str
+	mut i := 0
+	for i < s.len && (str[i] == ` ` || (str[i] >= `\t` && str[i] <= `\r`)) {
+		i++
+	}
+	mut neg := false
+	if i < s.len && (str[i] == `-` || str[i] == `+`) {
+		neg = str[i] == `-`
+		i++
+	}
+	mut n := u64(0)
+	if auto_base && i + 1 < s.len && str[i] == `0` {
+		mut base := u64(8)
+		if str[i + 1] == `x` || str[i + 1] == `X` {
+			base = u64(16)
+			i += 2
+		}
+		for i < s.len {
+			c := str[i]
+			mut d := u64(16)
+			if c >= `0` && c <= `9` {
+				d = u64(c - `0`)
 			}
-			// Skip the length of rep, since we just replaced it with "with"
-			i += rep.len - 1
-			// Go to the next index
-			idx_pos++
-			if idx_pos < idxs.len {
-				cur_idx = idxs[idx_pos]
+			else if c >= `a` && c <= `f` {
+				d = u64(c - `a` + 10)
 			}
+			else if c >= `A` && c <= `F` {
+				d = u64(c - `A` + 10)
+			}
+			if d >= base {
+				break
+			}
+			n = n * base + d
+			i++
 		}
-		// Rep doesnt start here, just copy
-		else {
-			b[b_i] = s[i]
-			b_i++
-		}
+		return n, neg
 	}
-	b[new_len] = `\0`
-	return tos(b, new_len)
+	for i < s.len && str[i] >= `0` && str[i] <= `9` {
+		n = n * u64(10) + u64(str[i] - `0`)
+		i++
+	}
+	return n, neg
 }
 
+// The integer at the start of `s`, like C's `atoi()`: `' -12a'.int() == -12`,
+// and 0 if there is none. It wraps around if it doesn't fit.
 pub fn (s string) int() int {
-	return C.atoi(*char(s.str))
+	n, neg := parse_uint(s, false)
+	if neg {
+		return -int(n)
+	}
+	return int(n)
 }
 
-
 pub fn (s string) i64() i64 {
-	return C.atoll(*char(s.str))
+	n, neg := parse_uint(s, false)
+	if neg {
+		return -i64(n)
+	}
+	return i64(n)
 }
 
 pub fn (s string) f32() f32 {
-	return C.atof(*char(s.str))
+	return f32(s.f64())
 }
 
+// The number at the start of `s`, like C's `atof()`. Numbers of up to 15
+// digits with an exponent of up to 22, which covers most of the ones in
+// JSON, CSV and the like, are read right from `s`, the others with
+// `strtod()`.
 pub fn (s string) f64() f64 {
-	return C.atof(*char(s.str))
+	str := s.str
+	mut i := 0
+	for i < s.len && (str[i] == ` ` || (str[i] >= `\t` && str[i] <= `\r`)) {
+		i++
+	}
+	start := i
+	mut neg := false
+	if i < s.len && (str[i] == `-` || str[i] == `+`) {
+		neg = str[i] == `-`
+		i++
+	}
+	mut mant := u64(0)
+	mut nr_digits := 0 // without the leading zeros
+	mut exp := 0
+	mut has_digits := false
+	for i < s.len && str[i] >= `0` && str[i] <= `9` {
+		mant = mant * u64(10) + u64(str[i] - `0`)
+		if mant != u64(0) {
+			nr_digits++
+		}
+		has_digits = true
+		i++
+	}
+	if i < s.len && str[i] == `.` {
+		i++
+		for i < s.len && str[i] >= `0` && str[i] <= `9` {
+			mant = mant * u64(10) + u64(str[i] - `0`)
+			if mant != u64(0) {
+				nr_digits++
+			}
+			exp--
+			has_digits = true
+			i++
+		}
+	}
+	if i < s.len && (str[i] == `e` || str[i] == `E`) {
+		mut j := i + 1
+		mut exp_neg := false
+		if j < s.len && (str[j] == `-` || str[j] == `+`) {
+			exp_neg = str[j] == `-`
+			j++
+		}
+		if j < s.len && str[j] >= `0` && str[j] <= `9` {
+			mut e := 0
+			for j < s.len && str[j] >= `0` && str[j] <= `9` {
+				if e < 100000 {
+					e = e * 10 + int(str[j] - `0`)
+				}
+				j++
+			}
+			exp += if exp_neg { -e } else { e }
+		}
+	}
+	// Exact: the digits and the power of 10 are exact f64s, and so is the
+	// rounded product or quotient
+	if has_digits && nr_digits <= 15 && exp >= -22 && exp <= 22 {
+		mut d := f64(mant)
+		if exp < 0 {
+			d = d / pow10_f64(-exp)
+		}
+		else {
+			d = d * pow10_f64(exp)
+		}
+		return if neg { -d } else { d }
+	}
+	// Long, huge, tiny, `inf`, `nan`, `0x1p-3`... C's strtod() needs a 0
+	// at the end
+	rest := s.right(start)
+	if rest.len < 64 {
+		mut buf := [64]byte
+		C.memcpy(&buf[0], rest.str, rest.len)
+		buf[rest.len] = `\0`
+		return C.strtod(*char(&buf[0]), 0)
+	}
+	crest := rest.cstr()
+	d := C.strtod(crest, 0)
+	rest.free_cstr(crest)
+	return d
 }
 
+fn C.strtod(voidptr, voidptr) f64
+
+// 10^n, exact for n <= 22
+fn pow10_f64(n int) f64 {
+	mut p := f64(1)
+	for i := 0; i < n; i++ {
+		p = p * f64(10)
+	}
+	return p
+}
+
+// Like C's `strtoul()`, with `0x` for hexadecimal and `0` for octal numbers
 pub fn (s string) u32() u32 {
-	//$if tinyc {
-		//return u32(s.int()) // TODO
-	//} $else {
-		return C.strtoul(*char(s.str), 0, 0)
-	//}
+	n, neg := parse_uint(s, true)
+	if neg {
+		return u32(u64(0) - n)
+	}
+	return u32(n)
 }
 
 pub fn (s string) u64() u64 {
-	//$if tinyc {
-		//return u64(s.i64()) // TODO
-	//} $else {
-		return C.strtoull(*char(s.str), 0, 0)
-	//}
-	//return C.atoll(s.str) // temporary fix for tcc on windows.
+	n, neg := parse_uint(s, true)
+	if neg {
+		return u64(0) - n
+	}
+	return n
 }
 
 // ==
@@ -295,12 +434,11 @@ pub fn (s string) split(delim string) []string {
 	mut i := 0
 	mut start := 0// - 1
 	for i < s.len {
-		// printiln(i)
-		mut a := s[i] == delim[0]
-		mut j := 1
-		for j < delim.len && a {
-			a = a && s[i + j] == delim[j]
-			j++
+		// Skip to the next delimiter, or to the last byte
+		i = s.index_after(delim, i)
+		a := i >= 0
+		if !a {
+			i = s.len - 1
 		}
 		last := i == s.len - 1
 		if a || last {
@@ -334,7 +472,12 @@ pub fn (s string) split_single(delim byte) []string {
 	mut i := 0
 	mut start := 0
 	for i < s.len {
-		is_delim := s[i] == delim
+		// Skip to the next delimiter, or to the last byte
+		i = s.index_byte_after(delim, i)
+		is_delim := i >= 0
+		if !is_delim {
+			i = s.len - 1
+		}
 		last := i == s.len - 1
 		if is_delim || last {
 			if !is_delim && i == s.len - 1 {
@@ -371,6 +514,87 @@ pub fn (s string) split_into_lines() []string {
 	return res
 }
 
+struct SplitIterator {
+	s        string
+	delim    string
+	is_lines bool
+mut:
+	pos      int // where the next field starts, -1 after the last one
+pub:
+	val      string // the current field, a view into the string
+}
+
+// Iterates over the fields of `s` separated by `delim`, without building
+// an array, so the fields after the ones that are needed cost nothing:
+//
+//     mut it := s.split_iter('\t')
+//     for it.next() {
+//         println(it.val)
+//     }
+//
+// Unlike `split()`, the fields aren't trimmed and empty fields are kept:
+// 'a,,b' has 3 fields, and '' has one.
+pub fn (s string) split_iter(delim string) SplitIterator {
+	return SplitIterator {
+		s: s
+		delim: delim
+	}
+}
+
+// Iterates over the lines of `s` like `split_into_lines()`. The lines
+// don't include the '\n', and a '\n' at the end doesn't start a new line.
+pub fn (s string) lines_iter() SplitIterator {
+	mut it := SplitIterator {
+		s: s
+		delim: '\n'
+		is_lines: true
+	}
+	if s.len == 0 {
+		it.pos = -1
+	}
+	return it
+}
+
+// Moves to the next field, returns false at the end
+pub fn (it mut SplitIterator) next() bool {
+	if it.pos < 0 || (it.is_lines && it.pos == it.s.len) {
+		return false
+	}
+	mut end := -1
+	if it.delim.len == 1 {
+		end = it.s.index_byte_after(it.delim[0], it.pos)
+	}
+	else if it.delim.len > 1 {
+		end = it.s.index_after(it.delim, it.pos)
+	}
+	if end < 0 {
+		it.val = it.s.substr(it.pos, it.s.len)
+		it.pos = -1
+		return true
+	}
+	it.val = it.s.substr(it.pos, end)
+	it.pos = end + it.delim.len
+	return true
+}
+
+// Splits `s` into `n` fields at most, the last one is the rest of the
+// string: 'a b c'.split_n(' ', 2) == ['a', 'b c']. Fields are kept as they
+// are, like with `split_iter()`.
+pub fn (s string) split_n(delim string, n int) []string {
+	mut res := []string
+	if n <= 0 {
+		return res
+	}
+	mut it := s.split_iter(delim)
+	for res.len < n - 1 && it.next() {
+		res << it.val
+	}
+	if it.pos >= 0 {
+		res << s.right(it.pos)
+	}
+	return res
+}
+
 // 'hello'.left(2) => 'he'
 pub fn (s string) left(n int) string {
 	if n >= s.len {
@@ -386,86 +610,103 @@ pub fn (s string) right(n int) string {
 	return s.substr(n, s.len)
 }
 
-// substr
+// substr returns a view into the bytes of `s`, without copying them.
+// It's not 0 terminated, see `cstr()`.
 pub fn (s string) substr(start, end int) string {
 	if start > end || start > s.len || end > s.len || start < 0 || end < 0 {
 		panic('substr($start, $end) out of bounds (len=$s.len)')
 	}
-	len := end - start
+	res := string {
+		str: s.str + start
+		len: end - start
+		is_view: true
+	}
+	return res
+}
 
-	mut res := string {
-		len: len
-		str: malloc(len + 1)
+// cstr returns a 0 terminated C string with the contents of `s`: `s.str`
+// itself, or a copy if `s` is a substring. The copy belongs to the caller,
+// `free_cstr()` frees it.
+pub fn (s string) cstr() byteptr {
+	if isnil(s.str) {
+		return ''.str
 	}
-	for i := 0; i < len; i++ {
-		res.str[i] = s.str[start + i]
+	if !s.is_view {
+		return s.str
 	}
-	res.str[len] = `\0`
+	return s.clone().str
+}
 
-/*
-	res := string {
-		str: s.str + start
-		len: len
+// Frees what `s.cstr()` returned, if it's a copy
+pub fn (s string) free_cstr(p byteptr) {
+	if s.is_view {
+		free(p)
 	}
-*/
-	return res
 }
 
 pub fn (s string) index(p string) int {
+	return s.index_after(p, 0)
+}
+
+// KMP search
+pub fn (s string) index_kmp(p string) int {
 	if p.len > s.len {
 		return -1
 	}
-	mut i := 0
-	for i < s.len {
-		mut j := 0
-		for j < p.len && s[i + j] == p[j] {
+	return s.index_kmp_after(p, 0)
+}
+
+fn (s string) index_kmp_after(p string, start int) int {
+	mut prefix := [0].repeat(p.len)
+	mut j := 0
+	for i := 1; i < p.len; i++ {
+		for p[j] != p[i] && j > 0 {
+			j = prefix[j - 1]
+		}
+		if p[j] == p[i] {
+			j++
+		}
+		prefix[i] = j
+	}
+	j = 0
+	for i := start; i < s.len; i++ {
+		for p[j] != s[i] && j > 0 {
+			j = prefix[j - 1]
+		}
+		if p[j] == s[i] {
 			j++
 		}
 		if j == p.len {
-			return i
+			return i - p.len + 1
 		}
-		i++
 	}
 	return -1
 }
 
-// KMP search
-pub fn (s string) index_kmp(p string) int {
-        if p.len > s.len {
-                return -1
-        }
-        mut prefix := [0].repeat(p.len)
-        mut j := 0
-        for i := 1; i < p.len; i++ {
-                for p[j] != p[i] && j > 0 {
-                        j = prefix[j - 1]
-                }
-                if p[j] == p[i] {
-                        j++
-                }
-                prefix[i] = j
-        }
-        j = 0
-        for i := 0; i < s.len; i++ {
-                for p[j] != s[i] && j > 0 {
-                        j = prefix[j - 1]
-                }
-                if p[j] == s[i] {
-                        j++
-                }
-                if j == p.len {
-                        return i - p.len + 1
-                }
-        }
-        return -1
-}
-
-
+// The index of the first byte of `s` that is in `chars`
 pub fn (s string) index_any(chars string) int {
+	// A few bytes: `memchr()` each one, in the part before the first hit
+	if chars.len <= 4 {
+		mut res := -1
+		mut n := s.len
+		for c in chars {
+			hit := byteptr(C.memchr(s.str, c, n))
+			if hit != 0 {
+				res = int(u64(hit) - u64(s.str))
+				n = res
+			}
+		}
+		return res
+	}
+	// A bit for each byte value
+	mut set := [u64(0), u64(0), u64(0), u64(0)]
 	for c in chars {
-		index := s.index(c.str())
-		if index != -1 {
-			return index
+		set[c >> 6] = set[c >> 6] | u64(u64(1) << u64(c & 63))
+	}
+	for i := 0; i < s.len; i++ {
+		c := s.str[i]
+		if (set[c >> 6] & u64(u64(1) << u64(c & 63))) != 0 {
+			return i
 		}
 	}
 	return -1
@@ -475,13 +716,13 @@ pub fn (s string) last_index(p string) int {
 	if p.len > s.len {
 		return -1
 	}
+	if p.len == 0 {
+		return s.len
+	}
+	first := p.str[0]
 	mut i := s.len - p.len
 	for i >= 0 {
-		mut j := 0
-		for j < p.len && s[i + j] == p[j] {
-			j++
-		}
-		if j == p.len {
+		if s.str[i] == first && C.memcmp(s.str + i, p.str, p.len) == 0 {
 			return i
 		}
 		i--
@@ -489,6 +730,12 @@ pub fn (s string) last_index(p string) int {
 	return -1
 }
 
+// The first index of `p` in `s` at or after `start`.
+// `memchr()` (vectorized by the C library) finds the candidates, the
+// positions of the first byte of `p`, the last byte of `p` filters them,
+// and `memcmp()` checks the rest. If the checks keep failing (like
+// searching for `aXa` in `aaaa...`, which is O(len * p.len) this way),
+// the rest of `s` is searched with KMP, which is linear.
 pub fn (s string) index_after(p string, start int) int {
 	if p.len > s.len {
 		return -1
@@ -500,16 +747,31 @@ pub fn (s string) index_after(p string, start int) int {
 	if start >= s.len {
 		return -1
 	}
+	if p.len == 0 {
+		return strt
+	}
+	if p.len == 1 {
+		return s.index_byte_after(p[0], strt)
+	}
+	first := p.str[0]
+	last := p.str[p.len - 1]
+	end := s.len - p.len // the last possible match
+	mut checked := 0 // bytes compared by failed `memcmp()`s
 	mut i := strt
-	for i < s.len {
-		mut j := 0
-		mut ii := i
-		for j < p.len && s[ii] == p[j] {
-			j++
-			ii++
+	for i <= end {
+		hit := byteptr(C.memchr(s.str + i, first, end - i + 1))
+		if hit == 0 {
+			return -1
 		}
-		if j == p.len {
-			return i
+		i = int(u64(hit) - u64(s.str))
+		if s.str[i + p.len - 1] == last {
+			if C.memcmp(s.str + i + 1, p.str + 1, p.len - 2) == 0 {
+				return i
+			}
+			checked += p.len
+			if checked > 4 * (i - strt) + 256 {
+				return s.index_kmp_after(p, i + 1)
+			}
 		}
 		i++
 	}
@@ -517,12 +779,18 @@ pub fn (s string) index_after(p string, start int) int {
 }
 
 pub fn (s string) index_byte(c byte) int {
-	for i:=0; i<s.len; i++ {
-		if s[i] == c {
-			return i
-		}
+	return s.index_byte_after(c, 0)
+}
+
+fn (s string) index_byte_after(c byte, start int) int {
+	if start >= s.len {
+		return -1
 	}
-	return -1
+	hit := byteptr(C.memchr(s.str + start, c, s.len - start))
+	if hit == 0 {
+		return -1
+	}
+	return int(u64(hit) - u64(s.str))
 }
 
 pub fn (s string) last_index_byte(c byte) int {
@@ -561,16 +829,11 @@ pub fn (s string) contains(p string) bool {
 }
 
 pub fn (s string) starts_with(p string) bool {
-	res := s.index(p) == 0
-	return res
+	return p.len <= s.len && C.memcmp(s.str, p.str, p.len) == 0
 }
 
 pub fn (s string) ends_with(p string) bool {
-	if p.len > s.len {
-		return false
-	}
-	res := s.last_index(p) == s.len - p.len
-	return res
+	return p.len <= s.len && C.memcmp(s.str + s.len - p.len, p.str, p.len) == 0
 }
 
 // TODO only works with ASCII
@@ -725,46 +988,78 @@ fn compare_strings(a, b &string) int {
 	return 0
 }
 
-fn compare_strings_by_len(a, b &string) int {
-	if a.len < b.len {
-		return -1
-	}
-	if a.len > b.len {
-		return 1
-	}
-	return 0
-}
-
+// Compares the bytes as `to_lower()` would change them, without allocating
 fn compare_lower_strings(a, b &string) int {
-	aa := a.to_lower()
-	bb := b.to_lower()
-	return compare_strings(aa, bb)
+	mut n := a.len
+	if b.len < n {
+		n = b.len
+	}
+	for i := 0; i < n; i++ {
+		x := C.tolower(a.str[i])
+		y := C.tolower(b.str[i])
+		if x != y {
+			return x - y
+		}
+	}
+	return a.len - b.len
 }
 
-pub fn (s mut []string) sort() {
-	s.sort_with_compare(compare_strings)
+fn string_len_key(s &string) i64 {
+	return i64(s.len)
 }
 
 pub fn (s mut []string) sort_ignore_case() {
 	s.sort_with_compare(compare_lower_strings)
 }
 
+// Stable: strings of the same length stay in the same order
 pub fn (s mut []string) sort_by_len() {
-	s.sort_with_compare(compare_strings_by_len)
+	s.sort_by_key(string_len_key)
 }
 
+// The index of where each code point starts is only built if some of them
+// aren't ASCII, otherwise the code point `i` is the byte `i`. It's built
+// right away, so a ustring can be read by several threads.
 pub fn (s string) ustring() ustring {
+	len := utf8_str_len(s)
+	if len == s.len || len == 0 {
+		return ustring {
+			s: s
+			len: len
+		}
+	}
 	mut res := ustring {
 		s: s
-		// runes will have at least s.len elements, save reallocations
-		// TODO use VLA for small strings?
-		runes: new_array(0, s.len, sizeof(int))
+		runes: new_array(len, len, sizeof(int))
+		len: len
 	}
+	mut runes := &int(res.runes.data)
+	mut j := 0
 	for i := 0; i < s.len; i++ {
-		char_len := utf8_char_len(s.str[i])
-		res.runes << i
-		i += char_len - 1
-		res.len++
+		if (s.str[i] & 0xc0) != 0x80 {
+			runes[j] = i
+			j++
+		}
+	}
+	return res
+}
+
+// The byte offset of the code point `idx`
+fn (u ustring) rune_offset(idx int) int {
+	if u.runes.len == 0 {
+		return idx
+	}
+	return u.runes[idx]
+}
+
+// The byte offsets of all the code points, a new array for ASCII strings
+pub fn (u ustring) rune_offsets() []int {
+	if u.runes.len == u.len {
+		return u.runes
+	}
+	mut res := []int
+	for i := 0; i < u.len; i++ {
+		res << i
 	}
 	return res
 }
@@ -774,21 +1069,29 @@ pub fn (s string) ustring() ustring {
 // right away. Uses global buffer for storing runes []int array.
 __global g_ustring_runes []int
 pub fn (s string) ustring_tmp() ustring {
-	if g_ustring_runes.len == 0 {
-		g_ustring_runes = new_array(0, 128, sizeof(int))
+	len := utf8_str_len(s)
+	if len == s.len {
+		return ustring {
+			s: s
+			len: len
+		}
+	}
+	if g_ustring_runes.cap < len {
+		g_ustring_runes.free()
+		g_ustring_runes = new_array(0, len + 128, sizeof(int))
 	}
 	mut res := ustring {
 		s: s
+		len: len
 	}
 	res.runes = g_ustring_runes
-	res.runes.len = s.len
+	res.runes.len = len
 	mut j := 0
 	for i := 0; i < s.len; i++ {
-		char_len := utf8_char_len(s.str[i])
-		res.runes[j] = i
-		j++
-		i += char_len - 1
-		res.len++
+		if (s.str[i] & 0xc0) != 0x80 {
+			res.runes[j] = i
+			j++
+		}
 	}
 	return res
 }
@@ -821,26 +1124,7 @@ fn (u ustring) ge(a ustring) bool {
 }
 
 fn (u ustring) add(a ustring) ustring {
-	mut res := ustring {
-		s: u.s + a.s
-		runes: new_array(0, u.s.len + a.s.len, sizeof(int))
-	}
-	mut j := 0
-	for i := 0; i < u.s.len; i++ {
-		char_len := utf8_char_len(u.s.str[i])
-		res.runes << j
-		i += char_len - 1
-		j += char_len
-		res.len++
-	}
-	for i := 0; i < a.s.len; i++ {
-		char_len := utf8_char_len(a.s.str[i])
-		res.runes << j
-		i += char_len - 1
-		j += char_len
-		res.len++
-	}
-	return res
+	return (u.s + a.s).ustring()
 }
 
 pub fn (u ustring) index_after(p ustring, start int) int {
@@ -899,9 +1183,9 @@ pub fn (u ustring) substr(_start, _end int) string {
 		u.s.len
 	}
 	else {
-		u.runes[_end]
+		u.rune_offset(_end)
 	}
-	return u.s.substr(u.runes[_start], end)
+	return u.s.substr(u.rune_offset(_start), end)
 }
 
 pub fn (u ustring) left(pos int) string {
@@ -927,12 +1211,12 @@ fn (s string) at(idx int) byte {
 
 pub fn (u ustring) at(idx int) string {
 	if idx < 0 || idx >= u.len {
-		panic('string index out of range: $idx / $u.runes.len')
+		panic('string index out of range: $idx / $u.len')
 	}
 	return u.substr(idx, idx + 1)
 }
 
-fn (u ustring) free() {
+pub fn (u ustring) free() {
 	u.runes.free()
 }
 
@@ -952,7 +1236,11 @@ pub fn (c byte) is_letter() bool {
 	return (c >= `a` && c <= `z`) || (c >= `A` && c <= `Z`)
 }
 
+// Does nothing on substrings, their bytes belong to another string
 pub fn (s string) free() {
+	if s.is_view {
+		return
+	}
 	free(s.str)
 }
 
@@ -1060,15 +1348,10 @@ pub fn (c byte) is_white() bool {
 }
 
 
+// The same hash as the one used by `map` (see hash.v). It's seeded per
+// process, so don't store it or rely on its value between runs.
 pub fn (s string) hash() int {
-	//mut h := s.hash_cache
-	mut h := 0
-	if h == 0 && s.len > 0 {
-		for c in s {
-			h = h * 31 + int(c)
-		}
-	}
-	return h
+	return int(wyhash(s.str, s.len, hash_seed))
 }
 
 pub fn (s string) bytes() []byte {
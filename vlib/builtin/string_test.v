@@ -87,6 +87,42 @@ fn test_sort() {
 	assert vals[3] == 'arr'
 }
 
+fn test_sort_many() {
+	// Enough for the radix sort, with long shared prefixes, duplicates and
+	// strings that are prefixes of others
+	mut vals := ['']
+	mut seed := u32(1)
+	for i := 0; i < 2000; i++ {
+		seed = seed * u32(1103515245) + u32(12345)
+		n := int(u32(seed >> u32(16)) % u32(1000))
+		if i % 4 == 0 {
+			vals << n.str()
+		}
+		else if i % 4 == 1 {
+			vals << 'common/prefix/$n'
+		}
+		else if i % 4 == 2 {
+			vals << 'common/prefix/'
+		}
+		else {
+			vals << 'ab'.repeat(n % 40 + 1)
+		}
+	}
+	vals.sort()
+	for i := 1; i < vals.len; i++ {
+		assert vals[i - 1] <= vals[i]
+	}
+	assert vals[0] == ''
+	vals.sort_by_len()
+	for i := 1; i < vals.len; i++ {
+		assert vals[i - 1].len <= vals[i].len
+	}
+	mut names := ['bob', 'Alice', 'carol', 'Bob']
+	names.sort_ignore_case()
+	assert names[0] == 'Alice'
+	assert names[3] == 'carol'
+}
+
 fn test_split() {
 	mut s := 'volt/twitch.v:34'
 	mut vals := s.split(':')
@@ -220,6 +256,26 @@ fn test_runes() {
 	assert last.len == 2
 }
 
+fn test_ustring_index() {
+	// No index for ASCII, the offsets are the positions
+	a := 'hello'.ustring()
+	offsets := a.rune_offsets()
+	assert offsets.len == 5
+	assert offsets[4] == 4
+	assert a.at(4) == 'o'
+	assert a.substr(1, 3) == 'el'
+	u := 'h€llô'.ustring()
+	assert u.len == 5
+	assert u.rune_offsets()[2] == 4
+	u2 := u
+	assert u.at(1) == '€'
+	assert u2.rune_offsets()[4] == 6
+	assert u2.substr(2, 5) == 'llô'
+	assert (u + a).at(5) == 'h'
+	tmp := 'h€llô'.ustring_tmp()
+	assert tmp.at(4) == 'ô'
+}
+
 fn test_lower() {
 	mut s := 'A'
 	assert s.to_lower() == 'a'
@@ -266,6 +322,36 @@ fn test_contains() {
 	assert !s.contains('random')
 }
 
+fn test_index() {
+	s := 'hello, world! hello!'
+	assert s.index('hello') == 0
+	assert s.index('llo!') == 16
+	assert s.index('o') == 4
+	assert s.index('hello!!') == -1
+	assert s.index_after('hello', 1) == 14
+	assert s.index_after('!', 13) == 19
+	assert s.last_index('hello') == 14
+	assert s.last_index('l') == 17
+	assert s.last_index('x') == -1
+	assert s.index_any('w!') == 7
+	assert s.index_any('xyz,') == 5
+	assert s.index_any('xyz') == -1
+	assert s.index_any('xyz!,') == 5
+	assert s.index_any('xyzuv') == -1
+	assert s.starts_with('hello, ')
+	assert !s.starts_with('world')
+	assert s.ends_with('hello!')
+	assert !'lo!'.ends_with('hello!')
+	// Candidates that keep failing: KMP takes over
+	haystack := 'a'.repeat(10000)
+	half := 'a'.repeat(50)
+	needle := half + 'b' + half
+	assert haystack.index(needle) == -1
+	assert (haystack + needle).index(needle) == 10000
+	assert (haystack + needle).count(needle) == 1
+	assert (haystack + needle + haystack).index_kmp(needle) == 10000
+}
+
 fn test_arr_contains() {
 	a := ['a', 'b', 'c']
 	assert a.contains('b')
@@ -293,17 +379,28 @@ fn test_to_num() {
 
 fn test_hash() {
 	s := '10000'
-	assert s.hash() == 46730161
 	s2 := '24640'
-	assert s2.hash() == 47778736
-	s3 := 'Content-Type'
-	assert s3.hash() == 949037134
-	s4 := 'bad_key'
-	assert s4.hash() == -346636507
-	s5 := '24640'
-	// From a map collision test
-	assert s5.hash() % ((1 << 20) -1) == s.hash() % ((1 << 20) -1)
-	assert s5.hash() % ((1 << 20) -1) == 592861
+	assert s.hash() == '10000'.hash()
+	assert s.hash() != s2.hash()
+	assert ''.hash() != 'a'.hash()
+	// Every key length path: 0, 1-3, 4-16, 17-48 and longer
+	mut hashes := []int
+	mut key := ''
+	for i := 0; i < 200; i++ {
+		h := key.hash()
+		assert !(h in hashes)
+		assert h == key.clone().hash()
+		// A substring hashes the same as the whole string
+		assert h == (key + 'x').left(i).hash()
+		hashes << h
+		key += 'a'
+	}
+	// One different byte anywhere changes the hash
+	base := 'Content-Type: application/x-www-form-urlencoded; charset=utf-8'
+	for i := 0; i < base.len; i++ {
+		changed := base.left(i) + '_' + base.right(i + 1)
+		assert changed.hash() != base.hash()
+	}
 }
 
 fn test_trim() {
@@ -469,6 +566,93 @@ fn test_repeat() {
 	assert s.repeat(5) == 'V! V! V! V! V! '
 }
 
+fn test_split_iter() {
+	mut fields := []string
+	mut it := 'a,b,,c'.split_iter(',')
+	for it.next() {
+		fields << it.val
+	}
+	assert fields.len == 4
+	assert fields[0] == 'a'
+	assert fields[2] == ''
+	assert fields[3] == 'c'
+	mut it2 := 'key => val => x'.split_iter(' => ')
+	assert it2.next()
+	assert it2.val == 'key'
+	assert it2.next()
+	assert it2.val == 'val'
+	assert it2.next()
+	assert it2.val == 'x'
+	assert !it2.next()
+	mut it3 := ''.split_iter(',')
+	assert it3.next()
+	assert it3.val == ''
+	assert !it3.next()
+}
+
+fn test_lines_iter() {
+	mut lines := []string
+	mut it := 'one\ntwo\n\nfour\n'.lines_iter()
+	for it.next() {
+		lines << it.val
+	}
+	assert lines.len == 4
+	assert lines[0] == 'one'
+	assert lines[2] == ''
+	assert lines[3] == 'four'
+	mut it2 := ''.lines_iter()
+	assert !it2.next()
+	mut it3 := 'no newline'.lines_iter()
+	assert it3.next()
+	assert it3.val == 'no newline'
+	assert !it3.next()
+}
+
+fn test_split_n() {
+	s := 'GET /index.html HTTP/1.1'
+	assert s.split_n(' ', 2).len == 2
+	assert s.split_n(' ', 2)[1] == '/index.html HTTP/1.1'
+	assert s.split_n(' ', 10).len == 3
+	assert s.split_n(' ', 1)[0] == s
+	assert s.split_n(' ', 0).len == 0
+	parts := 'a::b::'.split_n('::', 5)
+	assert parts.len == 3
+	assert parts[2] == ''
+}
+
+fn test_substr_view() {
+	s := 'hello world'
+	hello := s.left(5)
+	world := s.right(6)
+	assert hello == 'hello'
+	assert world == 'world'
+	// Substrings share the parent's bytes
+	assert hello.str == s.str
+	assert world.str == s.str + 6
+	// Substrings are copied to be terminated with a 0, other strings aren't
+	assert s.cstr() == s.str
+	cworld := world.cstr()
+	assert cworld != world.str
+	assert tos_clone(cworld) == 'world'
+	world.free_cstr(cworld)
+	assert tos_clone(hello.cstr()) == 'hello'
+	copy := hello.clone()
+	assert copy == hello
+	assert copy.str != hello.str
+	assert s.substr(3, 3) == ''
+	empty := ''.cstr()
+	assert empty[0] == `\0`
+}
+
+fn test_free_substr() {
+	s := 'hello world'.clone()
+	t := s.substr(2, 5)
+	// Does nothing, the bytes belong to `s`
+	t.free()
+	assert t == 'llo'
+	s.free()
+}
+
 fn test_raw() {
 	raw := r'raw\nstring'
 	lines := raw.split('\n')
@@ -8,6 +8,94 @@ pub fn utf8_char_len(b byte) int {
 	return (( 0xe5000000 >> (( b >> 3 ) & 0x1e )) & 3 ) + 1
 }
 
+// The number of code points in `s`: the bytes that don't continue a
+// sequence (10xxxxxx). They are counted 8 at a time, in an u64.
+pub fn utf8_str_len(s string) int {
+	mut n := 0
+	mut i := 0
+	for ; i + 8 <= s.len; i += 8 {
+		w := u64(0)
+		C.memcpy(&w, s.str + i, 8)
+		// The high bit of each continuation byte
+		cont := w & u64(~w << u64(1)) & u64(0x8080808080808080)
+		n += 8 - int(u64(u64(cont >> u64(7)) * u64(0x0101010101010101)) >> u64(56))
+	}
+	for ; i < s.len; i++ {
+		if (s.str[i] & 0xc0) != 0x80 {
+			n++
+		}
+	}
+	return n
+}
+
+// Whether `len` bytes at `data` are well formed UTF-8: no overlong
+// encodings, surrogates (U+D800-U+DFFF) or code points above U+10FFFF, and
+// no truncated sequences. Runs of ASCII are checked 8 bytes at a time.
+pub fn utf8_validate(data byteptr, len int) bool {
+	mut i := 0
+	for i < len {
+		if i + 8 <= len {
+			w := u64(0)
+			C.memcpy(&w, data + i, 8)
+			if (w & u64(0x8080808080808080)) == 0 {
+				i += 8
+				continue
+			}
+		}
+		c := data[i]
+		if c < 0x80 {
+			i++
+			continue
+		}
+		mut n := 0 // continuation bytes
+		// The range of the second byte, narrower than 80..BF after some
+		// lead bytes to rule out overlongs, surrogates and > U+10FFFF
+		mut lo := 0x80
+		mut hi := 0xbf
+		if c < 0xc2 {
+			return false
+		}
+		else if c < 0xe0 {
+			n = 1
+		}
+		else if c < 0xf0 {
+			n = 2
+			if c == 0xe0 {
+				lo = 0xa0
+			}
+			else if c == 0xed {
+				hi = 0x9f
+			}
+		}
+		else if c < 0xf5 {
+			n = 3
+			if c == 0xf0 {
+				lo = 0x90
+			}
+			else if c == 0xf4 {
+				hi = 0x8f
+			}
+		}
+		else {
+			return false
+		}
+		if i + n >= len {
+			return false
+		}
+		b := int(data[i + 1])
+		if b < lo || b > hi {
+			return false
+		}
+		for j := 2; j <= n; j++ {
+			if (data[i + j] & 0xc0) != 0x80 {
+				return false
+			}
+		}
+		i += n + 1
+	}
+	return true
+}
+
 // Convert utf32 to utf8
 // utf32 == Codepoint
 pub fn utf32_to_str(code u32) string {
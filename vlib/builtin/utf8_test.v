@@ -3,3 +3,25 @@ fn test_utf8_char_len() {
 	s := 'п' 
 	assert utf8_char_len(s[0]) == 2 
 }
+
+fn test_utf8_str_len() {
+	assert utf8_str_len('') == 0
+	assert utf8_str_len('hello') == 5
+	assert utf8_str_len('привет, мир') == 11
+	assert utf8_str_len('h€llô wörld, ﷰ and 🙂 and more') == 29
+}
+
+fn test_utf8_validate() {
+	valid := ['', 'hello world, all of it ascii', 'привет', '€', 'ﷰ', '🙂',
+		'a long ascii prefix before the euro sign €']
+	for s in valid {
+		assert utf8_validate(s.str, s.len)
+	}
+	// overlong '/', overlong NUL, a surrogate, above U+10FFFF, a lone
+	// continuation byte, truncated sequences, and 0xff
+	invalid := ['\xc0\xaf', '\xe0\x80\x80', '\xed\xa0\x80', '\xf4\x90\x80\x80',
+		'abc\x80', '\xe2\x82', 'ascii text, then \xf0\x9f\x99', '\xff']
+	for s in invalid {
+		assert !utf8_validate(s.str, s.len)
+	}
+}
@@ -49,6 +49,9 @@ fn (v mut V) cc() {
 	}
 	$if windows {
 		if v.pref.ccompiler == 'msvc' {
+			if v.pref.pgo_gen || v.pref.pgo_use {
+				verror('-pgo-gen and -pgo-use are not supported with msvc')
+			}
 			v.cc_msvc()
 			return
 		}
@@ -122,6 +125,12 @@ fn (v mut V) cc() {
 	if v.pref.ccompiler != 'msvc' && v.os != .freebsd {
 		a << '-Werror=implicit-function-declaration'
 	}
+	// [parallel] loops. tcc doesn't support OpenMP and runs them serially,
+	// clang (and macOS) usually ship without libomp.
+	if v.table.has_parallel_for && !v.pref.ccompiler.contains('tcc') &&
+		!v.pref.ccompiler.contains('clang') && v.os != .mac {
+		a << '-fopenmp'
+	}
 
 	for f in v.generate_hotcode_reloading_compiler_flags() {
 		a << f
@@ -171,6 +180,13 @@ fn (v mut V) cc() {
 	*/
 	// Cross compiling windows
 	//
+	// -pgo-gen/-pgo-use compile a copy of the C file with a stable name
+	mut c_file := v.out_name_c
+	if v.pref.pgo_gen || v.pref.pgo_use {
+		pgo_flags, pgo_c_file := v.pgo_setup()
+		a << pgo_flags
+		c_file = pgo_c_file
+	}
 	// Output executable name
 	a << '-o "$v.out_name"'
 	if os.dir_exists(v.out_name) {
@@ -181,7 +197,7 @@ fn (v mut V) cc() {
 		a << '-x objective-c'
 	}
 	// The C file we are compiling
-	a << '"$v.out_name_c"'
+	a << '"$c_file"'
 	if v.os == .mac {
 		a << '-x none'
 	}
@@ -418,6 +434,28 @@ fn find_c_compiler_thirdparty_options() string {
 	return cflags
 }
 
+fn get_cmdline_pgo_train(args []string) string {
+	for ci, cv in args {
+		if cv == '-pgo-train' && ci + 1 < args.len {
+			return args[ci+1]
+		}
+	}
+	return ''
+}
+
+fn get_cmdline_allocator(args []string) string {
+	for arg in args {
+		if arg.starts_with('-allocator=') {
+			allocator := arg.right(11)
+			if !(allocator in ['libc', 'pool', 'arena']) {
+				verror('unknown allocator `$allocator`, use libc, pool or arena')
+			}
+			return allocator
+		}
+	}
+	return 'libc'
+}
+
 fn get_cmdline_cflags(args []string) string {
 	mut cflags := ''
 	for ci, cv in args {
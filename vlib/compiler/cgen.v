@@ -98,8 +98,12 @@ fn (g mut CGen) resetln(s string) {
 }
 
 fn (g mut CGen) save() {
-	s := g.lines.join('\n')
-	g.out.writeln(s)
+	// Streamed, the whole C code is never in one string
+	mut out := os.new_file_builder(g.out, 64 * 1024)
+	for line in g.lines {
+		out.writeln(line)
+	}
+	out.free()
 	g.out.close()
 }
 
@@ -224,6 +228,28 @@ fn (p &Parser) print_prof_counters() string {
 	return res.join(';\n')
 }
 
+// The number of the statement that starts at the current token, for
+// `v -profile_alloc`. 0 is for the allocations outside of statements.
+fn (p mut Parser) alloc_site() int {
+	site := '$p.file_path_id:${p.cur_tok().line_nr + 1}'
+	if site in p.table.alloc_site_ids {
+		return p.table.alloc_site_ids[site]
+	}
+	p.table.alloc_sites << site
+	id := p.table.alloc_sites.len
+	p.table.alloc_site_ids[site] = id
+	return id
+}
+
+fn (v &V) alloc_site_names() string {
+	mut res := []string
+	res << '"(no statement)"'
+	for site in v.table.alloc_sites {
+		res << '"' + site.replace('\\', '\\\\') + '"'
+	}
+	return 'char* _alloc_site_names[] = {\n' + res.join(',\n') + '\n};'
+}
+
 fn (p mut Parser) gen_typedef(s string) {
 	if !p.first_pass() {
 		return
@@ -308,7 +334,7 @@ fn (v &V) type_definitions() string {
 	mut types := []Type // structs that need to be sorted
 	mut builtin_types := []Type // builtin types
 	// builtin types need to be on top
-	builtins := ['string', 'array', 'map', 'Option']
+	builtins := ['string', 'array', 'map', 'intmap', 'Option']
 	for builtin in builtins {
 		typ := v.table.typesmap[builtin]
 		builtin_types << typ
@@ -65,6 +65,33 @@ CommonCHeaders = '
 
 #define OPTION_CAST(x) (x)
 
+// Branch hints and hot/cold functions (`[cold] fn panic()`), no-ops on tcc and msvc
+#if defined(__GNUC__) && !defined(__TINYC__)
+#define _likely_(x) __builtin_expect((x), 1)
+#define _unlikely_(x) __builtin_expect((x), 0)
+#define _V_COLD __attribute__((cold))
+#define _V_HOT __attribute__((hot))
+#else
+#define _likely_(x) (x)
+#define _unlikely_(x) (x)
+#define _V_COLD
+#define _V_HOT
+#endif
+
+// tcc 0.9.27 has neither the `__atomic` nor the `__sync` builtins. Those the
+// `go` scheduler (builtin) and the sync module use are done under a lock.
+#if defined(__TINYC__) && !defined(_WIN32)
+#include <pthread.h>
+pthread_mutex_t _v_atomic_mutex __attribute__((weak)) = PTHREAD_MUTEX_INITIALIZER;
+#define __ATOMIC_SEQ_CST 5
+#define _V_ATOMIC(expr) ({ pthread_mutex_lock(&_v_atomic_mutex); expr; pthread_mutex_unlock(&_v_atomic_mutex); })
+#define __atomic_load_n(p, o) ({ __typeof__(*(p)) _v_old; _V_ATOMIC(_v_old = *(p)); _v_old; })
+#define __atomic_store_n(p, v, o) _V_ATOMIC(*(p) = (v))
+#define __atomic_exchange_n(p, v, o) ({ __typeof__(*(p)) _v_old; _V_ATOMIC(_v_old = *(p); *(p) = (v)); _v_old; })
+#define __atomic_fetch_add(p, d, o) ({ __typeof__(*(p)) _v_old; _V_ATOMIC(_v_old = *(p); *(p) += (d)); _v_old; })
+#define __atomic_compare_exchange_n(p, e, v, weak, so, fo) ({ int _v_ok; _V_ATOMIC(_v_ok = *(p) == *(e); if (_v_ok) *(p) = (v); else *(e) = *(p)); _v_ok; })
+#endif
+
 #ifdef _WIN32
 #define WINVER 0x0600
 #define _WIN32_WINNT 0x0600
@@ -133,6 +160,7 @@ typedef map map_string;
 #define _PUSH_MANY(arr, val, tmp, tmp_typ) {tmp_typ tmp = (val); array_push_many(arr, tmp.data, tmp.len);}
 #define _IN(typ, val, arr) array_##typ##_contains(arr, val)
 #define _IN_MAP(val, m) map_exists(m, val)
+#define _IN_INTMAP(val, m) intmap_exists(m, (u64)(val))
 #define DEFAULT_EQUAL(a, b) (a == b)
 #define DEFAULT_NOT_EQUAL(a, b) (a != b)
 #define DEFAULT_LT(a, b) (a < b)
@@ -18,6 +18,7 @@ import (
 //     p.error(msg)
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
+[cold]
 fn (p mut Parser) error(s string) {
 	// no positioning info, so just assume that the last token was the culprit:
 	p.error_with_token_index(s, p.token_idx-1 )
@@ -39,6 +40,7 @@ fn (p mut Parser) production_error_with_token_index(e string, tokenindex int) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
+[cold]
 fn (p mut Parser) error_with_token_index(s string, tokenindex int) {
 	p.error_with_position(s, p.scanner.get_scanner_pos_of_token( p.tokens[ tokenindex ] ) )
 }
@@ -49,6 +51,7 @@ fn (p mut Parser) warn_with_token_index(s string, tokenindex int) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
+[cold]
 fn (p mut Parser) error_with_position(s string, sp ScannerPos) {
 	p.print_error_context()
 	e := normalized_error( s )
@@ -67,6 +70,7 @@ fn (p mut Parser) warn_with_position(s string, sp ScannerPos) {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////
 
+[cold]
 fn (s &Scanner) error(msg string) {
 	s.error_with_col(msg, 0)
 }
@@ -83,6 +87,7 @@ fn (s &Scanner) warn_with_col(msg string, col int) {
 	eprintln('warning: ${fullpath}:${s.line_nr+1}:${col}: $final_message')
 }
 
+[cold]
 fn (s &Scanner) error_with_col(msg string, col int) {
 	fullpath := s.get_error_filepath()		
 	color_on := s.is_color_output_on()
@@ -31,6 +31,7 @@ mut:
 	is_method     bool
 	returns_error bool
 	is_decl       bool // type myfn fn(int, int)
+	is_cold       bool // [cold], calls to it are unlikely (panic(), verror() etc)
 	defer_text    []string
 	//gen_types []string
 	fn_name_token_idx int // used by error reporting
@@ -154,6 +155,7 @@ fn (p mut Parser) fn_decl() {
 	mut f := Fn{
 		mod: p.mod
 		is_public: p.tok == .key_pub
+		is_cold: p.attr == 'cold'
 	}
 	is_live := p.attr == 'live' && !p.pref.is_so  && p.pref.is_live
 	if p.attr == 'live' &&  p.first_pass() && !p.pref.is_live && !p.pref.is_so {
@@ -330,6 +332,10 @@ fn (p mut Parser) fn_decl() {
 		'__declspec(dllexport) '
 	} else if p.attr == 'inline' {
 		'static inline '
+	} else if p.attr == 'cold' {
+		'_V_COLD '
+	} else if p.attr == 'hot' {
+		'_V_HOT '
 	} else {
 		''
 	}
@@ -531,81 +537,114 @@ fn (p mut Parser) check_unused_variables() {
 
 // user.register() => "User_register(user)"
 // method_ph - where to insert "user_register("
-// receiver_var - "user" (needed for pthreads)
+// receiver_var - "user" (the first argument of the task)
 // receiver_type - "User"
-fn (p mut Parser) async_fn_call(f Fn, method_ph int, receiver_var, receiver_type string) {
+// `go f(a, b)` => `f_go(joinable, a, b)`, which copies the arguments to a
+// task of the runtime (vlib/builtin/sched.v) and queues it. Returns the type
+// of the handle `wait()` is called on.
+fn (p mut Parser) async_fn_call(f Fn, method_ph int, receiver_var, receiver_type string, joinable bool) string {
 	// println('\nfn_call $f.name is_method=$f.is_method receiver_type=$f.receiver_type')
 	// p.print_tok()
-	mut thread_name := ''
 	// Normal function => just its name, method => TYPE_FN.name
 	mut fn_name := f.name
 	if f.is_method {
 		fn_name = receiver_type.replace('*', '') + '_' + f.name
 		//fn_name = '${receiver_type}_${f.name}'
 	}
-	// Generate tmp struct with args
+	// The task: its header, what the function returns, then the args. The
+	// handles of all the functions that return the same type find it at the
+	// same place.
 	arg_struct_name := 'thread_arg_$fn_name'
-	tmp_struct := p.get_tmp()
-	p.genln('$arg_struct_name * $tmp_struct = malloc(sizeof($arg_struct_name));')
-	mut arg_struct := 'typedef struct  $arg_struct_name   { '
+	mut arg_struct := 'typedef struct $arg_struct_name { GoTask task; '
+	if f.typ != 'void' {
+		arg_struct += '$f.typ ret; '
+	}
+	fn_name = p.table.fn_gen_name(f)
+	go_name := '${fn_name}_go'
+	p.gen('$go_name(')
+	if joinable {
+		p.gen('1')
+	}
+	else {
+		p.gen('0')
+	}
 	p.next()
 	p.check(.lpar)
 	// str_args contains the args for the wrapper function:
 	// wrapper(arg_struct * arg) { fn("arg->a, arg->b"); }
 	mut str_args := ''
-	mut did_gen_something := false
+	mut go_args := ''
+	mut set_args := ''
 	for i, arg in f.args {
 		arg_struct += '$arg.typ $arg.name ;'// Add another field (arg) to the tmp struct definition
 		str_args += 'arg $dot_ptr $arg.name'
+		go_args += ', $arg.typ $arg.name'
+		set_args += 'arg->$arg.name = $arg.name; '
+		if i < f.args.len - 1 {
+			str_args += ','
+		}
+		p.gen(', ')
 		if i == 0 && f.is_method {
-			p.genln('$tmp_struct $dot_ptr $arg.name =  $receiver_var ;')
-			if i < f.args.len - 1 {
-				str_args += ','
-			}
-			did_gen_something = true
+			p.gen(receiver_var)
 			continue
 		}
-		// Set the struct values (args)
-		p.genln('$tmp_struct $dot_ptr $arg.name =  ')
 		p.expression()
-		p.genln(';')
 		if i < f.args.len - 1 {
 			p.check(.comma)
-			str_args += ','
 		}
-		did_gen_something = true
 	}
-
-	if !did_gen_something {
-		// Msvc doesnt like empty struct
-		arg_struct += 'EMPTY_STRUCT_DECLARATION;'
-	}
-
+	p.gen(')')
 	arg_struct += '} $arg_struct_name ;'
 	// Also register the wrapper, so we can use the original function without modifying it
-	fn_name = p.table.fn_gen_name(f)
 	wrapper_name := '${fn_name}_thread_wrapper'
-	wrapper_text := 'void* $wrapper_name($arg_struct_name * arg) {$fn_name( /*f*/$str_args );  }'
+	mut call := '$fn_name( /*f*/$str_args )'
+	if f.typ != 'void' {
+		call = 'arg->ret = $call'
+	}
+	wrapper_text := 'void $wrapper_name($arg_struct_name * arg) { $call; }\n' +
+		'GoTask* $go_name(bool joinable $go_args) {\n' +
+		'$arg_struct_name * arg = ($arg_struct_name *)go_task_new(sizeof($arg_struct_name), (void*)$wrapper_name, joinable);\n' +
+		'$set_args\ngo_task_start(&arg->task);\nreturn (GoTask*)arg;\n}'
 	p.cgen.register_thread_fn(wrapper_name, wrapper_text, arg_struct)
-	// Create thread object
-	tmp_nr := p.get_tmp_counter()
-	thread_name = '_thread$tmp_nr'
-	if p.os != .windows {
-		p.genln('pthread_t $thread_name;')
-	}
-	tmp2 := p.get_tmp()
-	mut parg := 'NULL'
-	if f.args.len > 0 {
-		parg = ' $tmp_struct'
+	p.check(.rpar)
+	if !joinable {
+		return 'void'
 	}
-	// Call the wrapper
-	if p.os == .windows {
-		p.genln(' CreateThread(0,0, $wrapper_name, $parg, 0,0);')
+	return p.register_go_handle(f.typ)
+}
+
+// The type of the handles of `go` for functions that return `ret`, with a
+// `wait()` that returns what they returned. `GoTask_int` is a `GoTask*`.
+fn (p mut Parser) register_go_handle(ret string) string {
+	typ := 'GoTask_' + ret.replace('*', '_ptr')
+	if p.table.known_type(typ) {
+		return typ
+	}
+	wait_fn := Fn {
+		name: 'wait'
+		typ: ret
+		args: [Var{typ: typ, is_arg: true}]
+		is_method: true
+		is_public: true
+		receiver_typ: typ
+		mod: 'builtin'
+	}
+	p.table.register_type2(Type {
+		name: typ
+		mod: 'builtin'
+		methods: [wait_fn]
+	})
+	p.cgen.typedefs << 'typedef struct GoTask* $typ;'
+	mut wait := '$ret ${typ}_wait($typ t) {\ngo_task_wait(t);\n'
+	if ret == 'void' {
+		wait += 'go_task_release(t);\n}'
 	}
 	else {
-		p.genln('int $tmp2 = pthread_create(& $thread_name, NULL, $wrapper_name, $parg);')
+		wait += '$ret res = ((struct { GoTask task; $ret ret; } *)t)->ret;\n' +
+			'go_task_release(t);\nreturn res;\n}'
 	}
-	p.check(.rpar)
+	p.cgen.thread_args << wait
+	return typ
 }
 
 // p.tok == fn_name
@@ -625,6 +664,10 @@ fn (p mut Parser) fn_call(f Fn, method_ph int, receiver_var, receiver_type strin
 		}
 	}
 	mut cgen_name := p.table.fn_gen_name(f)
+	// `f32x4_load()` makes a SIMD value without naming its type
+	if is_simd_type(f.typ) {
+		p.table.has_simd = true
+	}
 	p.next()
 	mut gen_type := ''
 	if p.tok == .lt {
@@ -667,6 +710,10 @@ fn (p mut Parser) fn_call(f Fn, method_ph int, receiver_var, receiver_type strin
 		if !p.expr_var.is_changed {
 			p.mark_var_changed(p.expr_var)
 		}
+		if receiver.typ == 'array*' && f.name in ['insert', 'prepend', 'delete'] {
+			// `a.insert(`: the name of `a` is 3 tokens before `(`
+			p.parallel_array_change(p.expr_var, '${f.name}()', p.token_idx - 4)
+		}
 		p.gen_method_call(receiver_type, f.typ, cgen_name, receiver, method_ph)
 	}
 	// foo<Bar>()
@@ -889,10 +936,15 @@ fn (p mut Parser) fn_call_args(f mut Fn) &Fn {
 			T := p.table.find_type(typ)
 			$if !windows {
 			$if !js {
+				// `println(n)` => `println_i64(n)`, no format to parse
+				if f.name == 'println' && typ in ['int', 'i8', 'i16', 'i64', 'byte', 'u16', 'u32'] {
+					p.cgen.resetln(p.cgen.cur_line.replace('println (', '/*opt*/println_i64 ('))
+					continue
+				}
 				fmt := p.typ_to_fmt(typ, 0)
 				if fmt != '' {
 					nl := if f.name == 'println' { '\\n' } else { '' }
-					p.cgen.resetln(p.cgen.cur_line.replace(f.name + ' (', '/*opt*/printf ("' + fmt + '$nl", '))
+					p.cgen.resetln(p.cgen.cur_line.replace(f.name + ' (', '/*opt*/_PRINTF ("' + fmt + '$nl", '))
 					continue
 				}
 			}
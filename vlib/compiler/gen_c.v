@@ -35,7 +35,7 @@ fn (p mut Parser) gen_var_decl(name string, is_static bool) string {
 		typ = typ.replace('Option_', '')
 		p.next()
 		p.check(.lcbr)
-		p.genln('if (!$tmp .ok) {')
+		p.genln('if (_unlikely_(!$tmp .ok)) {')
 		p.register_var(Var {
 			name: 'err'
 			typ: 'string'
@@ -79,6 +79,10 @@ fn (p mut Parser) gen_fn_decl(f Fn, typ, str_args string) {
 		'__declspec(dllexport) '
 	} else if p.attr == 'inline' {
 		'static inline '
+	} else if p.attr == 'cold' {
+		'_V_COLD '
+	} else if p.attr == 'hot' {
+		'_V_HOT '
 	} else {
 		''
 	}
@@ -108,7 +112,7 @@ fn (p mut Parser) gen_blank_identifier_assign() {
 		typ = typ.replace('Option_', '')
 		p.next()
 		p.check(.lcbr)
-		p.genln('if (!$tmp .ok) {')
+		p.genln('if (_unlikely_(!$tmp .ok)) {')
 		p.register_var(Var {
 			name: 'err'
 			typ: 'string'
@@ -174,8 +178,9 @@ fn (p mut Parser) index_get(typ string, fn_ph int, cfg IndexCfg) {
 	if cfg.is_map {
 		p.gen('$tmp')
 		def := type_default(typ)
+		map_get := if cfg.is_int_map { 'intmap_get' } else { 'map_get' }
 		p.cgen.insert_before('$typ $tmp = $def; ' +
-			'bool $tmp_ok = map_get(/*$p.file_name : $p.scanner.line_nr*/$index_expr, & $tmp);')
+			'bool $tmp_ok = $map_get(/*$p.file_name : $p.scanner.line_nr*/$index_expr, & $tmp);')
 	}
 	else if cfg.is_arr {
 		if p.pref.translated && !p.builtin_mod {
@@ -315,13 +320,51 @@ fn (p mut Parser) gen_for_str_header(i, tmp, var_typ, val string) {
 }
 
 fn (p mut Parser) gen_for_range_header(i, range_end, tmp, var_type, val string) {
-	p.genln(';\nfor (int $i = $tmp; $i < $range_end; $i++) {')
+	p.genln('for (int $i = $tmp; $i < $range_end; $i++) {')
 	if val == '_' { return }
 	p.genln('$var_type $val = $i;')
 }
 
+/*
+`[parallel] for x in a..b {` and `[parallel] for i, x in arr {` are
+OpenMP worksharing loops: the C compiler outlines the body, and its runtime
+splits the iterations between a pool of threads (`schedule(guided)` hands out
+shrinking chunks to whichever thread is free). Accumulators (`sum += x`) are
+`reduction()` clauses, each thread adds to its own copy, see parallel_assign().
+Without OpenMP (tcc) the pragma is ignored and the loop runs serially.
+*/
+fn (p mut Parser) gen_parallel_for_pragma() int {
+	p.table.has_parallel_for = true
+	if p.pass != .main || p.cgen.nogen {
+		return 0
+	}
+	p.genln('#pragma omp parallel for schedule(guided)')
+	return p.cgen.lines.len - 1
+}
+
+// The reductions are only known after the body has been parsed.
+fn (p mut Parser) set_parallel_for_pragma(idx int) {
+	if p.pass != .main || p.cgen.nogen || p.parallel_reductions.len == 0 {
+		return
+	}
+	mut pragma := p.cgen.lines[idx]
+	for red in p.parallel_reductions {
+		pragma += ' reduction($red)'
+	}
+	p.cgen.lines[idx] = pragma
+}
+
 fn (p mut Parser) gen_for_map_header(i, tmp, var_typ, val, typ string) {
 	def := type_default(typ)
+	key := map_key_type(typ)
+	if key != 'string' {
+		p.genln('array_$key keys_$tmp = intmap_keys(& $tmp ); ')
+		p.genln('for (int l = 0; l < keys_$tmp .len; l++) {')
+		p.genln('$key $i = (($key*)keys_$tmp .data)[l];')
+		if val == '_' { return }
+		p.genln('$var_typ $val = $def; intmap_get($tmp, (u64)($i), & $val);')
+		return
+	}
 	p.genln('array_string keys_$tmp = map_keys(& $tmp ); ')
 	p.genln('for (int l = 0; l < keys_$tmp .len; l++) {')
 	p.genln('string $i = ((string*)keys_$tmp .data)[l];')
@@ -354,14 +397,17 @@ fn (p mut Parser) gen_array_init(typ string, no_alloc bool, new_arr_ph int, nr_e
 	}
 }
 
-fn (p mut Parser) gen_array_set(typ string, is_ptr, is_map bool,fn_ph, assign_pos int, is_cao bool) {
+fn (p mut Parser) gen_array_set(typ string, is_ptr, is_map, is_int_map bool,fn_ph, assign_pos int, is_cao bool) {
 	// `a[0] = 7`
 	// curline right now: `a , 0  =  7`
 	mut val := p.cgen.cur_line.right(assign_pos)
 	p.cgen.resetln(p.cgen.cur_line.left(assign_pos))
 	mut cao_tmp := p.cgen.cur_line
 	mut func := ''
-	if is_map {
+	if is_int_map {
+		func = 'intmap_set(&'
+	}
+	else if is_map {
 		func = 'map_set(&'
 		// CAO on map is a bit more complicated as it loads
 		// the value inside a pointer instead of returning it.
@@ -439,7 +485,13 @@ fn (p mut Parser) gen_struct_field_init(field string) {
 }
 
 fn (p mut Parser) gen_empty_map(typ string) {
-	p.gen('new_map(1, sizeof($typ))')
+	key := map_key_type(typ)
+	val := map_val_type(typ)
+	if key != 'string' {
+		p.gen('new_intmap(sizeof($key), sizeof($val))')
+		return
+	}
+	p.gen('new_map(1, sizeof($val))')
 }
 
 fn (p mut Parser) cast(typ string) {
@@ -502,7 +554,7 @@ fn (p mut Parser) cast(typ string) {
 
 fn type_default(typ string) string {
 	if typ.starts_with('array_') {
-		return 'new_array(0, 1, sizeof( ${typ.right(6)} ))'
+		return 'new_array(0, 0, sizeof( ${typ.right(6)} ))'
 	}
 	// Always set pointers to 0
 	if typ.ends_with('*') {
@@ -140,7 +140,7 @@ fn (p mut Parser) gen_array_init(typ string, no_alloc bool, new_arr_ph int, nr_e
 	p.gen(']')
 }
 
-fn (p mut Parser) gen_array_set(typ string, is_ptr, is_map bool,fn_ph, assign_pos int, is_cao bool) {
+fn (p mut Parser) gen_array_set(typ string, is_ptr, is_map, is_int_map bool,fn_ph, assign_pos int, is_cao bool) {
 	mut val := p.cgen.cur_line.right(assign_pos)
 	p.cgen.resetln(p.cgen.cur_line.left(assign_pos))
 	p.gen('] =')
@@ -107,6 +107,11 @@ pub mut:
 	building_v    bool
 	autofree      bool
 	compress      bool
+	pgo_gen       bool   // `v -pgo-gen` builds an instrumented binary, see pgo.v
+	pgo_use       bool   // `v -pgo-use` uses its profile
+	pgo_train     string // `v -pgo-train './app --bench'` runs both and the training command
+	allocator     string // `v -allocator=pool`, what `malloc()` uses, see vlib/builtin/alloc.v
+	profile_alloc bool   // `v -profile_alloc` counts the allocations of each statement, see vlib/builtin/alloc_prof.v
 	//skip_builtin  bool   // Skips re-compilation of the builtin module
 						 // to increase compilation time.
 						 // This is on by default, since a vast majority of users do not
@@ -267,9 +272,8 @@ pub fn (v mut V) compile() {
 	}
 
 	// parse generated V code (str() methods etc)
+	// The buffer isn't freed: the names of the tokens are substrings of it
 	mut vgen_parser := v.new_parser_from_string(v.vgen_buf.str(), 'vgen')
-	// free the string builder which held the generated methods
-	v.vgen_buf.free()
 	vgen_parser.parse(.main)
 	// v.parsers.add(vgen_parser)
 	
@@ -278,9 +282,13 @@ pub fn (v mut V) compile() {
 	$if !js {
 		def.writeln(cgen.includes.join_lines())
 		def.writeln(cgen.typedefs.join_lines())
+		if v.table.has_simd {
+			def.writeln(simd_c_header())
+		}
 		def.writeln(v.type_definitions())
 		def.writeln('\nstring _STR(const char*, ...);\n')
 		def.writeln('\nstring _STR_TMP(const char*, ...);\n')
+		def.writeln('\nvoid _PRINTF(const char*, ...);\n')
 		def.writeln(cgen.fns.join_lines()) // fn definitions
 	} $else {
 		def.writeln(v.type_definitions())
@@ -291,6 +299,9 @@ pub fn (v mut V) compile() {
 		def.writeln('; // Prof counters:')
 		def.writeln(v.prof_counters())
 	}
+	if v.pref.profile_alloc {
+		def.writeln(v.alloc_site_names())
+	}
 	cgen.lines[defs_pos] = def.str()
 	v.generate_init()
 	v.generate_main()
@@ -305,7 +316,12 @@ pub fn (v mut V) compile() {
 		cgen.genln('main__main();')
 	}	
 	cgen.save()
-	v.cc()
+	if v.pref.pgo_train != '' {
+		v.pgo_train()
+	}
+	else {
+		v.cc()
+	}
 }
 
 fn (v mut V) generate_init() {
@@ -336,8 +352,20 @@ fn (v mut V) generate_init() {
 			}
 		}
 		consts_init_body := v.cgen.consts_init.join_lines()
+		// Before anything is allocated
+		mut set_allocator := ''
+		if v.pref.allocator == 'pool' {
+			set_allocator = 'v_allocator = 1;'
+		}
+		else if v.pref.allocator == 'arena' {
+			set_allocator = 'v_allocator = 2;'
+		}
+		if v.pref.profile_alloc {
+			set_allocator += '\nalloc_prof_init(${v.table.alloc_sites.len + 1}, _alloc_site_names);'
+		}
 		// vlib can't have `init_consts()`
 		v.cgen.genln('void init() {
+$set_allocator
 g_str_buf=malloc(1000);
 $call_mod_init_consts
 $consts_init_body
@@ -351,7 +379,7 @@ string _STR(const char *fmt, ...) {
 	va_start(argptr, fmt);
 	size_t len = vsnprintf(0, 0, fmt, argptr) + 1;
 	va_end(argptr);
-	byte* buf = malloc(len);
+	byte* buf = v_malloc(len);
 	va_start(argptr, fmt);
 	vsprintf((char *)buf, fmt, argptr);
 	va_end(argptr);
@@ -377,6 +405,36 @@ string _STR_TMP(const char *fmt, ...) {
 	return tos2(g_str_buf);
 }
 
+// println() of numbers and interpolated strings, formatted right into its
+// buffer, see vlib/builtin/print.v
+void _PRINTF(const char *fmt, ...) {
+	va_list argptr;
+	PrintBuf* b = thread_print_buf();
+	int room = builtin__print_buf_size - b->len;
+	va_start(argptr, fmt);
+	int len = vsnprintf((char *)b->data + b->len, room, fmt, argptr);
+	va_end(argptr);
+	if (len >= room) {
+		PrintBuf_flush(b);
+		if (len < builtin__print_buf_size) {
+			va_start(argptr, fmt);
+			vsnprintf((char *)b->data, builtin__print_buf_size, fmt, argptr);
+			va_end(argptr);
+		}
+		else {
+			byte* big = v_malloc(len + 1);
+			va_start(argptr, fmt);
+			vsnprintf((char *)big, len + 1, fmt, argptr);
+			va_end(argptr);
+			PrintBuf_write(b, big, len);
+			v_free(big);
+			len = 0;
+		}
+	}
+	b->len += len;
+	PrintBuf_done(b);
+}
+
 ')
 	}
 }
@@ -888,6 +946,11 @@ pub fn new_v(args[]string) &V {
 		is_run: 'run' in args
 		autofree: '-autofree' in args
 		compress: '-compress' in args
+		pgo_gen: '-pgo-gen' in args
+		pgo_use: '-pgo-use' in args
+		pgo_train: get_cmdline_pgo_train(args)
+		allocator: get_cmdline_allocator(args)
+		profile_alloc: '-profile_alloc' in args
 		is_repl: is_repl
 		build_mode: build_mode
 		cflags: cflags
@@ -1014,6 +1077,7 @@ pub fn create_symlink() {
 	}
 }
 
+[cold]
 pub fn verror(s string) {
 	println('V error: $s')
 	os.flush_stdout()
@@ -240,6 +240,10 @@ pub fn (v mut V) cc_msvc() {
 		a << '/MDd'
 	}
 
+	if v.table.has_parallel_for {
+		a << '/openmp'
+	}
+
 	if v.pref.is_so {
 		if !v.out_name.ends_with('.dll') {
 			v.out_name = v.out_name + '.dll'
@@ -1,5 +1,7 @@
 module compiler
 
+import strings
+
 // `a in [1,2,3]` => `a == 1 || a == 2 || a == 3`
 // avoid allocation
 // `typ` is the type of `a`
@@ -10,6 +12,27 @@ fn (p mut Parser) in_optimization(typ string, ph int) {
 	// Get `a` expr value (can be a string literal, not a variable)
 	expr := p.cgen.cur_line.right(ph)
 	is_str := typ == 'string'
+	// `s in ['a', 'b', 'c']` => `_strset_0(s) >= 0`
+	if is_str && !p.is_js {
+		strs := p.const_strs_in_array()
+		if strs.len >= strset_min_len {
+			mut idxs := []int
+			for j := 0; j < strs.len; j++ {
+				idxs << j
+			}
+			p.cgen.set_placeholder(ph, '(' + p.gen_strset(strs, idxs) + '(')
+			p.gen(') >= 0)')
+			for p.tok != .rsbr {
+				p.fgen('\'$p.lit\'')
+				p.check(.str)
+				if p.tok != .rsbr {
+					p.check(.comma)
+				}
+			}
+			p.check(.rsbr)
+			return
+		}
+	}
 	//println('!! $p.expr_var.name => $name ($typ)')
 	for p.tok != .rsbr && p.tok != .eof {
 		if i > 0 {
@@ -18,23 +41,322 @@ fn (p mut Parser) in_optimization(typ string, ph int) {
 			}	else {
 				p.gen(' || $expr == ')
 			}
-		}	
+		}
 		if i == 0 {
 			if is_str {
 				p.cgen.set_placeholder(ph, ' string_eq(')
 				p.gen(', ')
 			} else {
 				p.gen(' ==')
-			}	
-		}	
+			}
+		}
 		p.check_types(p.bool_expression(), typ)
 		if is_str {
 			p.gen(')')
-		}	
+		}
 		if p.tok != .rsbr {
 			p.check(.comma)
 		}
 		i++
-	}	
+	}
 	p.check(.rsbr)
 }
+
+/*
+Constant string sets.
+
+`s in ['a', 'b', 'c']` and `match s { 'a' => ... }`, where every element/arm
+is a plain string literal, are compiled into a call to a generated C function
+instead of a chain of `string_eq()` calls. The function switches on the length,
+then on one or two byte positions that tell the candidates apart (or on a
+precomputed hash if there are none), and does one final memcmp():
+
+	static int _strset_0(string s) {
+		switch (s.len) {
+		case 2: switch (s.str[1]) {
+			case 118: return memcmp(s.str, "-v", 2) ? -1 : 0;
+			case 104: return memcmp(s.str, "-h", 2) ? -1 : 1;
+			} break;
+		...
+		}
+		return -1;
+	}
+
+It returns the index of the element (or the match arm) or -1.
+Strings of a length that no hash tells apart are compared one by one with
+string_eq().
+*/
+
+const (
+	strset_min_len = 2 // chains shorter than this are left to string_eq()
+	strset_max_pair_len = 32 // don't look for byte pairs in longer strings
+	strset_max_seeds = 1000 // some sets collide for all seeds, like a Thue-Morse string and its complement
+)
+
+// A literal can be hashed at compile time if its bytes are the same in V and in C.
+fn (p &Parser) is_const_str_tok(idx int) bool {
+	if idx + 1 >= p.tokens.len {
+		return false
+	}
+	tok := p.tokens[idx]
+	if tok.tok != .str || p.tokens[idx + 1].tok == .dollar {
+		return false
+	}
+	return !tok.lit.contains('\\') && !tok.lit.contains('\n') && !tok.lit.contains('\r')
+}
+
+// Returns the elements of `[...]` starting at the current token if they are
+// all string literals, otherwise an empty array.
+fn (p &Parser) const_strs_in_array() []string {
+	mut res := []string
+	mut i := p.token_idx - 1
+	for {
+		if !p.is_const_str_tok(i) {
+			return []string
+		}
+		res << p.tokens[i].lit
+		i++
+		if p.tokens[i].tok == .rsbr {
+			return res
+		}
+		if p.tokens[i].tok != .comma {
+			return []string
+		}
+		i++
+	}
+	return res
+}
+
+// Returns the patterns of all match arms starting at the current token,
+// and the arm index of each pattern, if they are all string literals.
+fn (p &Parser) const_strs_in_match() ([]string, []int) {
+	mut strs := []string
+	mut arms := []int
+	mut i := p.token_idx - 1
+	mut arm := 0
+	for p.tokens[i].tok != .rcbr && p.tokens[i].tok != .key_else {
+		for {
+			if !p.is_const_str_tok(i) {
+				return []string, []int
+			}
+			strs << p.tokens[i].lit
+			arms << arm
+			i++
+			if p.tokens[i].tok != .comma {
+				break
+			}
+			i++
+		}
+		if p.tokens[i].tok != .arrow || p.tokens[i + 1].tok != .lcbr {
+			return []string, []int
+		}
+		// Skip the body of the arm
+		i += 2
+		mut depth := 1
+		for depth > 0 {
+			if p.tokens[i].tok == .eof {
+				return []string, []int
+			}
+			if p.tokens[i].tok == .lcbr {
+				depth++
+			}
+			else if p.tokens[i].tok == .rcbr {
+				depth--
+			}
+			i++
+		}
+		arm++
+	}
+	return strs, arms
+}
+
+// Generates (once per distinct set) the lookup function for `strs`, that
+// returns `idxs[i]` for `strs[i]`, and returns its name.
+fn (p mut Parser) gen_strset(strs []string, idxs []int) string {
+	mut key := strings.new_builder(100)
+	for i, s in strs {
+		key.write(s)
+		key.write('\n')
+		key.write(idxs[i].str())
+		key.write('\n')
+	}
+	set_key := key.str()
+	if set_key in p.table.strsets {
+		return p.table.strsets[set_key]
+	}
+	name := '_strset_$p.table.strsets.size'
+	if p.pass != .main {
+		return name
+	}
+	p.table.strsets[set_key] = name
+	// Group the strings by length, the first occurrence of a string wins
+	mut lens := []int
+	for i, s in strs {
+		if strs.index(s) == i && !(s.len in lens) {
+			lens << s.len
+		}
+	}
+	mut out := strings.new_builder(1000)
+	out.writeln('static int ${name}(string s) {')
+	out.writeln('\tswitch (s.len) {')
+	for len in lens {
+		mut group := []string
+		mut group_idxs := []int
+		for i, s in strs {
+			if s.len == len && strs.index(s) == i {
+				group << s
+				group_idxs << idxs[i]
+			}
+		}
+		out.write('\tcase $len: ')
+		if group.len == 1 {
+			out.writeln(strset_cmp(group[0], group_idxs[0]))
+			continue
+		}
+		pos1, pos2 := strset_positions(group)
+		if pos1 < 0 && pos2 < 0 {
+			// No seed was found, compare the strings one by one
+			out.writeln('')
+			for i, s in group {
+				out.writeln('\t\tif (string_eq(s, tos3("${format_str(s)}"))) return ${group_idxs[i]};')
+			}
+			out.writeln('\t\tbreak;')
+			continue
+		}
+		if pos1 >= 0 && pos2 < 0 {
+			out.writeln('switch (s.str[$pos1]) {')
+		}
+		else if pos1 >= 0 {
+			out.writeln('switch (s.str[$pos1] << 8 | s.str[$pos2]) {')
+		}
+		else {
+			out.writeln('{ u32 h = 0; for (int i = 0; i < s.len; i++) h = h * ${pos2}u + s.str[i]; switch (h) {')
+		}
+		for i, s in group {
+			mut label := ''
+			if pos1 >= 0 && pos2 < 0 {
+				label = int(s[pos1]).str()
+			}
+			else if pos1 >= 0 {
+				label = (int(s[pos1]) << 8 | int(s[pos2])).str()
+			}
+			else {
+				label = strset_hash(s, u32(pos2)).str() + 'u'
+			}
+			out.writeln('\t\tcase $label: ' + strset_cmp(s, group_idxs[i]))
+		}
+		if pos1 < 0 {
+			out.write('\t\t} } ')
+		}
+		else {
+			out.write('\t\t} ')
+		}
+		out.writeln('break;')
+	}
+	out.writeln('\t}')
+	out.writeln('\treturn -1;')
+	out.writeln('}')
+	p.cgen.fns << out.str()
+	return name
+}
+
+fn strset_cmp(s string, idx int) string {
+	return 'return memcmp(s.str, "${format_str(s)}", $s.len) ? -1 : $idx;'
+}
+
+fn strset_hash(s string, seed u32) u32 {
+	mut h := u32(0)
+	for i := 0; i < s.len; i++ {
+		h = h * seed + u32(s[i])
+	}
+	return h
+}
+
+// Finds one (`pos, -1`) or two (`pos1, pos2`) byte positions that are
+// different in all strings of the same length. If there are none, returns
+// `-1, seed` for a hash without collisions, or `-1, -1` if no seed was found.
+fn strset_positions(strs []string) (int, int) {
+	len := strs[0].len
+	for pos := 0; pos < len; pos++ {
+		mut seen := [false].repeat(256)
+		mut ok := true
+		for s in strs {
+			if seen[int(s[pos])] {
+				ok = false
+				break
+			}
+			seen[int(s[pos])] = true
+		}
+		if ok {
+			return pos, -1
+		}
+	}
+	if len <= strset_max_pair_len {
+		for pos1 := 0; pos1 < len; pos1++ {
+			for pos2 := pos1 + 1; pos2 < len; pos2++ {
+				mut keys := []int
+				for s in strs {
+					k := int(s[pos1]) << 8 | int(s[pos2])
+					if k in keys {
+						break
+					}
+					keys << k
+				}
+				if keys.len == strs.len {
+					return pos1, pos2
+				}
+			}
+		}
+	}
+	for seed := 31; seed < 31 + 2 * strset_max_seeds; seed += 2 {
+		mut hashes := []int
+		for s in strs {
+			h := int(strset_hash(s, u32(seed)))
+			if h in hashes {
+				break
+			}
+			hashes << h
+		}
+		if hashes.len == strs.len {
+			return -1, seed
+		}
+	}
+	return -1, -1
+}
+
+// Returns true if the block starting at the current `{` begins with a call to
+// a [cold] function: `if i >= a.len { panic(...) }`, `{ return error(...) }`.
+// Such conditions are wrapped in `_unlikely_()`.
+fn (p &Parser) is_cold_block() bool {
+	if p.tok != .lcbr {
+		return false
+	}
+	mut i := p.token_idx
+	if p.tokens[i].tok == .key_return {
+		i++
+	}
+	if p.tokens[i].tok != .name {
+		return false
+	}
+	mut name := p.tokens[i].lit
+	i++
+	// `os.exit()`
+	if p.tokens[i].tok == .dot && p.tokens[i + 1].tok == .name {
+		if !p.import_table.known_alias(name) {
+			return false
+		}
+		mod := p.import_table.resolve_alias(name)
+		name = prepend_mod(mod_gen_name(mod), p.tokens[i + 1].lit)
+		i += 2
+	}
+	else if !p.table.known_fn(name) {
+		name = p.prepend_mod(name)
+	}
+	if p.tokens[i].tok != .lpar {
+		return false
+	}
+	f := p.table.find_fn(name) or {
+		return false
+	}
+	return f.is_cold
+}
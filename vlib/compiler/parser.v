@@ -55,6 +55,10 @@ mut:
 	is_struct_init bool
 	if_expr_cnt    int
 	for_expr_cnt   int // to detect whether `continue` can be used
+	is_parallel_for bool // the next `for` has the [parallel] attribute
+	parallel_scope int // scope level of the current [parallel] loop body, 0 outside
+	parallel_for_cnt int // for_expr_cnt of the current [parallel] loop
+	parallel_reductions []string // `+:sum` for every accumulator in the current [parallel] loop
 	ptr_cast       bool
 	calling_c      bool
 	cur_fn         Fn
@@ -1025,12 +1029,12 @@ fn (p mut Parser) get_type() string {
 		p.next()
 		p.check(.lsbr)
 		key_type := p.check_name()
-		if key_type != 'string' {
-			p.error('maps only support string keys for now')
+		if key_type != 'string' && !(key_type in int_map_key_types) {
+			p.error('maps only support string, integer and pointer keys')
 		}
 		p.check(.rsbr)
 		val_type := p.get_type()// p.check_name()
-		typ = 'map_$val_type'
+		typ = map_type_name(key_type, val_type)
 		p.register_map(typ)
 		return typ
 	}
@@ -1049,7 +1053,9 @@ fn (p mut Parser) get_type() string {
 		nr_muls++
 		p.check(.amp)
 	}
-	typ += p.lit
+	// `[10]Foo`: resolve `Foo`, and add `[10]` back at the end
+	fixed_arr := typ
+	typ = p.lit
 	if !p.is_struct_init {
 		// Otherwise we get `foo := FooFoo{` because `Foo` was already
 		// generated in name_expr()
@@ -1079,15 +1085,17 @@ fn (p mut Parser) get_type() string {
 			typ += '__$p.lit'
 		}
 		mut t := p.table.find_type(typ)
+		if is_simd_type(typ) {
+			p.table.has_simd = true
+		}
 		// "typ" not found? try "mod__typ"
 		if t.name == '' && !p.builtin_mod {
 			// && !p.first_pass() {
-			if !typ.contains('array_') && p.mod != 'main' && !typ.contains('__') &&
-				!typ.starts_with('[') {
+			if !typ.contains('array_') && p.mod != 'main' && !typ.contains('__') {
 				typ = p.prepend_mod(typ)
 			}
 			t = p.table.find_type(typ)
-			if t.name == '' && !p.pref.translated && !p.first_pass() && !typ.starts_with('[') {
+			if t.name == '' && !p.pref.translated && !p.first_pass() {
 				println('get_type() bad type')
 				// println('all registered types:')
 				// for q in p.table.types {
@@ -1100,6 +1108,7 @@ fn (p mut Parser) get_type() string {
 	if typ == 'void' {
 		p.error('unknown type `$typ`')
 	}
+	typ = fixed_arr + typ
 	if mul {
 		typ += strings.repeat(`*`, nr_muls)
 	}
@@ -1172,6 +1181,9 @@ fn (p mut Parser) statements_no_rcbr() string {
 		p.tok != .key_default && p.peek() != .arrow {
 		// println(p.tok.str())
 		// p.print_tok()
+		if p.pref.profile_alloc && !p.inside_if_expr && !p.builtin_mod {
+			p.genln('v_alloc_site = ${p.alloc_site()};')
+		}
 		last_st_typ = p.statement(true)
 		// println('last st typ=$last_st_typ')
 		if !p.inside_if_expr {
@@ -1264,6 +1276,20 @@ fn (p mut Parser) statement(add_semi bool) string {
 	p.cgen.is_tmp = false
 	tok := p.tok
 	mut q := ''
+	// `[parallel] for x in a..b {`
+	if tok == .lsbr && p.peek() == .name && p.token_idx + 2 < p.tokens.len &&
+		p.tokens[p.token_idx + 2].tok == .key_for {
+		p.check(.lsbr)
+		attr := p.check_name()
+		if attr != 'parallel' {
+			p.error('unknown `for` attribute `$attr`')
+		}
+		p.check(.rsbr)
+		p.fgenln('[parallel]')
+		p.is_parallel_for = true
+		p.for_st()
+		return ''
+	}
 	switch tok {
 	case .name:
 		next := p.peek()
@@ -1337,6 +1363,9 @@ fn (p mut Parser) statement(add_semi bool) string {
 		if p.for_expr_cnt == 0 {
 			p.error('`break` statement outside `for`')
 		}
+		if p.parallel_scope > 0 && p.for_expr_cnt == p.parallel_for_cnt {
+			p.error('`break` is not allowed in a [parallel] loop')
+		}
 		p.genln('break')
 		p.check(.key_break)
 	case TokenKind.key_go:
@@ -1385,6 +1414,9 @@ fn ($v.name mut $v.typ) $p.cur_fn.name (...) {
 	if !v.is_changed {
 		p.mark_var_changed(v)
 	}
+	if p.parallel_scope > 0 && v.scope_level < p.parallel_scope {
+		p.parallel_assign(v)
+	}
 	is_str := v.typ == 'string'
 	is_ustr := v.typ == 'ustring'
 	switch tok {
@@ -1445,6 +1477,51 @@ fn ($v.name mut $v.typ) $p.cur_fn.name (...) {
 	}
 }
 
+// Assignment to `v`, declared outside of the current [parallel] loop.
+// `sum += x` is fine, every thread gets its own `sum` and they are added
+// together at the end. `sum = x` would be a data race.
+// Fields and elements (`a[i] = x`) are up to the user.
+fn (p mut Parser) parallel_assign(v Var) {
+	prev := p.tokens[p.token_idx - 2]
+	if prev.tok != .name || prev.lit != v.name || p.tokens[p.token_idx - 3].tok == .dot {
+		return
+	}
+	op := p.tok.str()
+	is_reduction := p.tok in [TokenKind.plus_assign, .minus_assign, .mult_assign,
+		.and_assign, .or_assign, .xor_assign]
+	if !is_reduction || !is_number_type(v.typ) || v.ptr {
+		p.error('`$v.name` is shared by all iterations of a [parallel] loop, ' +
+			'only `+= -= *= &= |= ^=` on numbers are allowed')
+	}
+	// `-=` partial results are added up as well
+	mut red := if op == '-=' { '+' } else { op.left(1) }
+	red += ':' + p.table.var_cgen_name(v.name)
+	for r in p.parallel_reductions {
+		if r == red {
+			return
+		}
+		if r.all_after(':') == red.all_after(':') {
+			p.error('`$v.name` is combined with different operators in a [parallel] loop')
+		}
+	}
+	p.parallel_reductions << red
+}
+
+// `a << x`, `a.insert()` and `a.delete()` on an array `a` declared outside of
+// the current [parallel] loop, its name is the token at `name_idx`. They
+// change the length of the array, which all the threads share.
+fn (p mut Parser) parallel_array_change(v Var, op string, name_idx int) {
+	if p.parallel_scope == 0 || v.scope_level >= p.parallel_scope {
+		return
+	}
+	tok := p.tokens[name_idx]
+	if tok.tok != .name || tok.lit != v.name || p.tokens[name_idx - 1].tok == .dot {
+		return
+	}
+	p.error('`$v.name` is shared by all iterations of a [parallel] loop, ' +
+		'`$op` is not allowed on it')
+}
+
 fn (p mut Parser) var_decl() {
 	p.is_alloc = false
 	is_mut := p.tok == .key_mut || p.prev_tok == .key_for
@@ -1630,11 +1707,15 @@ fn (p mut Parser) bterm() string {
 	is_float := typ[0] == `f` && (typ in ['f64', 'f32']) &&
 		!(p.cur_fn.name in ['f64_abs', 'f32_abs']) &&
 		!(p.cur_fn.name == 'eq')
+	is_simd := is_simd_type(typ) && !p.is_js
 	expr_type := typ
 	tok := p.tok
 	if tok in [.eq, .gt, .lt, .le, .ge, .ne] {
 		p.fgen(' ${p.tok.str()} ')
-		if (is_float || is_str || is_ustr) && !p.is_js {
+		if is_simd && tok != .eq && tok != .ne {
+			p.error('`${tok.str()}` is not defined on `$typ`, use lane-wise `a.${simd_cmp_name(tok)}(b)`')
+		}
+		if (is_float || is_str || is_ustr || is_simd) && !p.is_js {
 			p.gen(',')
 		}
 		else if p.is_sql && tok == .eq {
@@ -1688,6 +1769,16 @@ fn (p mut Parser) bterm() string {
 			case TokenKind.lt: p.cgen.set_placeholder(ph, 'ustring_lt(')
 			}
 		}
+		// `a == b` is true if all lanes are equal
+		if is_simd {
+			p.gen(')')
+			if tok == .eq {
+				p.cgen.set_placeholder(ph, '${expr_type}_eq(')
+			}
+			else {
+				p.cgen.set_placeholder(ph, '${expr_type}_ne(')
+			}
+		}
 		if is_float && p.cur_fn.name != 'f32_abs' && p.cur_fn.name != 'f64_abs' {
 			p.gen(')')
 			switch tok {
@@ -1722,6 +1813,20 @@ fn (p mut Parser) name_expr() string {
 		return 'string'
 	}
 	p.fgen(name)
+	// Branch hints: `if _unlikely_(i >= a.len) {` => `if (__builtin_expect(i >= a.len, 0)) {`
+	if (name == '_likely_' || name == '_unlikely_') && p.peek() == .lpar {
+		p.next()
+		p.check(.lpar)
+		if p.is_js {
+			p.gen('(')
+		} else {
+			p.gen('$name(')
+		}
+		p.check_types(p.bool_expression(), 'bool')
+		p.check(.rpar)
+		p.gen(')')
+		return 'bool'
+	}
 	// known_type := p.table.known_type(name)
 	orig_name := name
 	is_c := name == 'C' && p.peek() == .dot
@@ -2258,6 +2363,8 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 	//}
 	is_variadic_arg := typ.starts_with('...')
 	is_map := typ.starts_with('map_')
+	map_key := if is_map { map_key_arg_type(typ) } else { '' }
+	is_int_map := is_map && map_key != 'string'
 	is_str := typ == 'string'
 	is_arr0 := typ.starts_with('array_')
 	is_arr := is_arr0 || typ == 'array'
@@ -2317,11 +2424,15 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 		// need to replace "m[key]"       with "tmp = val; map_get(&m, key, &tmp)"
 		// can only do that later once we know whether there's an "=" or not
 		if is_map {
-			typ = typ.replace('map_', '')
+			typ = map_val_type(typ)
 			if typ == 'map' {
 				typ = 'void*'
 			}
 			p.gen(',')
+			// `intmap` keys are u64
+			if is_int_map && !p.is_js {
+				p.gen('(u64)(')
+			}
 		}
 		// expression inside [ ]
 		if is_arr || is_str {
@@ -2337,8 +2448,13 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 		}
 		else {
 			T := p.table.find_type(p.expression())
-			// TODO: Get the key type of the map instead of only string.
-			if is_map && T.parent != 'string' {
+			if is_int_map {
+				p.check_types(T.name, map_key)
+				if !p.is_js {
+					p.gen(')')
+				}
+			}
+			else if is_map && T.parent != 'string' {
 				p.check_types(T.name, 'string')
 			}
 		}
@@ -2380,7 +2496,7 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 		p.assign_statement(v, fn_ph, is_indexer && (is_map || is_arr))
 		// `m[key] = val`
 		if is_indexer && (is_map || is_arr) {
-			p.gen_array_set(typ, is_ptr, is_map, fn_ph, assign_pos, is_cao)
+			p.gen_array_set(typ, is_ptr, is_map, is_int_map, fn_ph, assign_pos, is_cao)
 		}
 		return typ
 	}
@@ -2392,6 +2508,7 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 		p.index_get(typ, fn_ph, IndexCfg{
 			is_arr: is_arr
 			is_map: is_map
+			is_int_map: is_int_map
 			is_ptr: is_ptr
 			is_str: is_str
 		})
@@ -2402,6 +2519,7 @@ fn (p mut Parser) index_expr(typ_ string, fn_ph int) string {
 
 struct IndexCfg {
 	is_map bool
+	is_int_map bool
 	is_str bool
 	is_ptr bool
 	is_arr bool
@@ -2442,7 +2560,10 @@ fn (p mut Parser) indot_expr() string {
 			p.error('$arr_typ has no method `contains`')
 		}
 		// `typ` is element's type
-		if is_map {
+		if is_map && map_key_type(arr_typ) != 'string' {
+			p.cgen.set_placeholder(ph, '_IN_INTMAP( (')
+		}
+		else if is_map {
 			p.cgen.set_placeholder(ph, '_IN_MAP( (')
 		}
 		else {
@@ -2487,6 +2608,7 @@ fn (p mut Parser) expression() string {
 			if !p.expr_var.is_changed {
 				p.mark_var_changed(p.expr_var)
 			}
+			p.parallel_array_change(p.expr_var, '<<', p.token_idx - 3)
 			p.gen('/*typ = $typ   tmp_typ=$tmp_typ*/')
 			ph_clone := p.cgen.add_placeholder()
 			expr_type := p.expression()
@@ -2518,8 +2640,18 @@ fn (p mut Parser) expression() string {
 			p.error('operator ${p.tok.str()} not defined on bool ')
 		}
 		is_num := typ == 'void*' || typ == 'byte*' || is_number_type(typ)
+		is_simd := is_simd_type(typ) && !p.is_js
 		p.check_space(p.tok)
-		if is_str && tok_op == .plus && !p.is_js {
+		// f32x4 + f32x4 => f32x4_add(a, b)
+		if is_simd {
+			is_bitwise := tok_op in [TokenKind.pipe, .amp, .xor]
+			if is_bitwise && simd_elem_type(typ) == 'f32' {
+				p.error('operator ${tok_op.str()} not defined on `$typ`')
+			}
+			p.cgen.set_placeholder(ph, '${typ}_${simd_op_name(tok_op)}(')
+			p.gen(',')
+		}
+		else if is_str && tok_op == .plus && !p.is_js {
 			p.cgen.set_placeholder(ph, 'string_add(')
 			p.gen(',')
 		}
@@ -2546,11 +2678,11 @@ fn (p mut Parser) expression() string {
 			}
 		}
 		p.check_types(p.term(), typ)
-		if (is_str || is_ustr) && tok_op == .plus && !p.is_js {
+		if ((is_str || is_ustr) && tok_op == .plus && !p.is_js) || is_simd {
 			p.gen(')')
 		}
 		// Make sure operators are used with correct types
-		if !p.pref.translated && !is_str && !is_ustr && !is_num {
+		if !p.pref.translated && !is_str && !is_ustr && !is_num && !is_simd {
 			T := p.table.find_type(typ)
 			if tok_op == .plus {
 				if T.has_method('+') {
@@ -2580,6 +2712,7 @@ fn (p mut Parser) term() string {
 	//if p.fileis('fn_test') {
 		//println('\nterm() $line_nr')
 	//}
+	ph := p.cgen.add_placeholder()
 	typ := p.unary()
 	//if p.fileis('fn_test') {
 		//println('2: $line_nr')
@@ -2593,8 +2726,16 @@ fn (p mut Parser) term() string {
 		is_div := tok == .div
 		is_mod := tok == .mod
 		// is_mul := tok == .mod
+		is_simd := is_simd_type(typ) && !p.is_js
 		p.next()
-		p.gen(tok.str())// + ' /*op2*/ ')
+		// f32x4 * f32x4 => f32x4_mul(a, b)
+		if is_simd && !is_mod {
+			p.cgen.set_placeholder(ph, '${typ}_${simd_op_name(tok)}(')
+			p.gen(',')
+		}
+		else {
+			p.gen(tok.str())// + ' /*op2*/ ')
+		}
 		p.fgen(' ' + tok.str() + ' ')
 		if (is_div || is_mod) && p.tok == .number && p.lit == '0' {
 			p.error('division or modulo by zero')
@@ -2603,6 +2744,9 @@ fn (p mut Parser) term() string {
 			p.error('operator .mod requires integer types')
 		}
 		p.check_types(p.unary(), typ)
+		if is_simd {
+			p.gen(')')
+		}
 	}
 	return typ
 }
@@ -2665,6 +2809,8 @@ fn (p mut Parser) factor() string {
 		p.next()
 		return p.factor()
 		// Variable
+	case TokenKind.key_go:
+		return p.go_expr(true)
 	case TokenKind.key_sizeof:
 		p.gen('sizeof(')
 		p.fgen('sizeof(')
@@ -2910,7 +3056,14 @@ fn (p mut Parser) string_expr() {
 				if typ != 'string' {
 					p.error('only V strings can be formatted with a :${cformat} format, but you have given "${val}", which has type ${typ}')
 				}
-				args = args.all_before_last('${val}.len, ${val}.str') + '${val}.str'
+				// Substrings are not 0 terminated: pass the length as the
+				// precision, unless there's one already
+				if cformat.contains('.') {
+					args = args.all_before_last('${val}.len, ${val}.str') + 'string_cstr(${val})'
+				}
+				else {
+					cformat = cformat.left(cformat.len - 1) + '.*s'
+				}
 			}
 			format += '%$cformat'
 			p.next()
@@ -2948,7 +3101,7 @@ fn (p mut Parser) string_expr() {
 	$if !windows {
 		cur_line := p.cgen.cur_line.trim_space()
 		if cur_line == 'println (' && p.tok != .plus {
-			p.cgen.resetln(cur_line.replace('println (', 'printf('))
+			p.cgen.resetln(cur_line.replace('println (', '_PRINTF('))
 			p.gen('$format\\n$args')
 			return
 		}
@@ -3010,17 +3163,17 @@ fn (p mut Parser) map_init() string {
 	p.next()
 	p.check(.lsbr)
 	key_type := p.check_name()
-	if key_type != 'string' {
-		p.error('only string key maps allowed for now')
+	if key_type != 'string' && !(key_type in int_map_key_types) {
+		p.error('maps only support string, integer and pointer keys')
 	}
 	p.check(.rsbr)
 	val_type = p.get_type()/// p.check_name()
 	//if !p.table.known_type(val_type) {
 		//p.error('map init unknown type "$val_type"')
 	//}
-	typ := 'map_$val_type'
+	typ := map_type_name(key_type, val_type)
 	p.register_map(typ)
-	p.gen('new_map(1, sizeof($val_type))')
+	p.gen_empty_map(typ)
 	if p.tok == .lcbr {
 		p.check(.lcbr)
 		p.check(.rcbr)
@@ -3154,6 +3307,9 @@ fn (p mut Parser) array_init() string {
 fn (p mut Parser) struct_init(typ string) string {
 	p.is_struct_init = true
 	t := p.table.find_type(typ)
+	if is_simd_type(typ) {
+		p.table.has_simd = true
+	}
 	if p.gen_struct_init(typ, t) { return typ }
 	p.scanner.fmt_out.cut(typ.len)
 	ptr := typ.contains('*')
@@ -3209,7 +3365,7 @@ fn (p mut Parser) struct_init(typ string) string {
 			// init map fields
 			if field_typ.starts_with('map_') {
 				p.gen_struct_field_init(sanitized_name)
-				p.gen_empty_map(field_typ.right(4))
+				p.gen_empty_map(field_typ)
 				inited_fields << sanitized_name
 				if i != t.fields.len - 1 {
 					p.gen(',')
@@ -3304,6 +3460,7 @@ fn (p mut Parser) if_st(is_expr bool, elif_depth int) string {
 		p.gen('if (')
 		p.fgen('if ')
 	}
+	cond_ph := p.cgen.add_placeholder()
 	p.next()
 	// `if a := opt() { }` syntax
 	if p.tok == .name && p.peek() == .decl_assign {
@@ -3338,6 +3495,11 @@ fn (p mut Parser) if_st(is_expr bool, elif_depth int) string {
 	if is_expr {
 		p.gen(') ? (')
 	}
+	// `if i >= a.len { panic(...) }` => `if (_unlikely_(i >= a.len)) {`
+	else if !p.is_js && p.is_cold_block() {
+		p.cgen.set_placeholder(cond_ph, '_unlikely_(')
+		p.genln(')) {')
+	}
 	else {
 		p.genln(') {')
 	}
@@ -3409,6 +3571,17 @@ fn (p mut Parser) for_st() {
 	next_tok := p.peek()
 	//debug := p.scanner.file_path.contains('r_draw')
 	p.open_scope()
+	is_parallel := p.is_parallel_for && !p.is_js
+	p.is_parallel_for = false
+	mut pragma_idx := -1
+	if is_parallel {
+		if p.parallel_scope > 0 {
+			p.error('nested [parallel] loops are not supported')
+		}
+		p.parallel_scope = p.cur_fn.scope_level
+		p.parallel_for_cnt = p.for_expr_cnt
+		p.parallel_reductions = []string
+	}
 	if p.tok == .lcbr {
 		// Infinite loop
 		p.gen('while (1) {')
@@ -3483,6 +3656,7 @@ fn (p mut Parser) for_st() {
 		pad := if is_arr { 6 } else  { 4 }
 		var_typ := if is_str { 'byte' }
 			else if is_variadic_arg { typ }
+			else if is_map { map_val_type(typ) }
 			else { typ.right(pad) }
 		// typ = strings.Replace(typ, "_ptr", "*", -1)
 		mut i_var_type := 'int'
@@ -3490,10 +3664,13 @@ fn (p mut Parser) for_st() {
 			p.gen_for_varg_header(i, expr, typ, val)
 		}
 		else if is_arr {
+			if is_parallel {
+				pragma_idx = p.gen_parallel_for_pragma()
+			}
 			p.gen_for_header(i, tmp, var_typ, val)
 		}
 		else if is_map {
-			i_var_type = 'string'
+			i_var_type = map_key_type(typ)
 			p.gen_for_map_header(i, tmp, var_typ, val, typ)
 		}
 		else if is_str {
@@ -3558,10 +3735,16 @@ fn (p mut Parser) for_st() {
 		}
 		else if is_range {
 			var_type = 'int'
+			if is_parallel {
+				pragma_idx = p.gen_parallel_for_pragma()
+			}
 			p.gen_for_range_header(i, range_end, tmp, var_type, val)
 		}
 		else if is_arr {
 			var_type = typ.right(6)// all after `array_`
+			if is_parallel {
+				pragma_idx = p.gen_parallel_for_pragma()
+			}
 			p.gen_for_header(i, tmp, var_type, val)
 		}
 		else if is_str {
@@ -3584,10 +3767,17 @@ fn (p mut Parser) for_st() {
 		p.check_types(p.bool_expression(), 'bool')
 		p.genln(') {')
 	}
+	if is_parallel && pragma_idx == -1 && p.pass == .main {
+		p.error('[parallel] only works with `for x in a..b` and `for i, x in array` loops')
+	}
 	p.fspace()
 	p.check(.lcbr)
 	p.genln('')
 	p.statements()
+	if is_parallel {
+		p.set_parallel_for_pragma(pragma_idx)
+		p.parallel_scope = 0
+	}
 	p.close_scope()
 	p.for_expr_cnt--
 	p.returns = false // TODO handle loops that are guaranteed to return
@@ -3683,6 +3873,16 @@ fn (p mut Parser) match_statement(is_expr bool) string {
 	mut i := 0
 	mut all_cases_return := true
 
+	// `match s { 'a' => ... 'b', 'c' => ... }` => `int arm = _strset_0(s)`, see optimization.v
+	mut strset_var := ''
+	if typ == 'string' && !p.is_js {
+		strs, arms := p.const_strs_in_match()
+		if strs.len >= strset_min_len {
+			strset_var = p.get_tmp()
+			p.cgen.insert_before('int $strset_var = ' + p.gen_strset(strs, arms) + '($tmp_var);')
+		}
+	}
+
 	// stores typ of resulting variable
 	mut res_typ := ''
 
@@ -3782,7 +3982,18 @@ fn (p mut Parser) match_statement(is_expr bool) string {
 		// Multiple checks separated by comma
 		mut got_comma := false
 
-		for {
+		if strset_var != '' {
+			p.gen('($strset_var == $i')
+			for {
+				p.fgen('\'$p.lit\'')
+				p.check(.str)
+				if p.tok != .comma {
+					break
+				}
+				p.check(.comma)
+			}
+		}
+		for strset_var == '' {
 			if got_comma {
 				p.gen(') || (')
 			}
@@ -3887,6 +4098,9 @@ if (!$tmp) {
 }
 
 fn (p mut Parser) return_st() {
+	if p.parallel_scope > 0 {
+		p.error('`return` is not allowed in a [parallel] loop')
+	}
 	p.check(.key_return)
 	p.fgen(' ')
 	deferred_text := p.get_deferred_text()
@@ -3995,7 +4209,14 @@ fn (p &Parser) prepend_mod(name string) string {
 	return prepend_mod(mod_gen_name(p.mod), name)
 }
 
+// `go f(x)` as a statement, nothing waits for the task
 fn (p mut Parser) go_statement() {
+	p.go_expr(false)
+}
+
+// `go f(x)`: runs `f(x)` on the workers of the runtime. If it's `joinable`,
+// it's a handle that `wait()` is called on.
+fn (p mut Parser) go_expr(joinable bool) string {
 	p.check(.key_go)
 	mut gotoken_idx := p.cur_tok_index()
 	// TODO copypasta of name_expr() ?
@@ -4003,7 +4224,7 @@ fn (p mut Parser) go_statement() {
 		// Method
 		var_name := p.lit
 		v := p.find_var(var_name) or {
-			return
+			return 'void'
 		}
 		p.mark_var_used(v)
 		gotoken_idx = p.cur_tok_index()
@@ -4012,9 +4233,9 @@ fn (p mut Parser) go_statement() {
 		typ := p.table.find_type(v.typ)
 		method := p.table.find_method(typ, p.lit) or {
 			p.error_with_token_index('go method missing $var_name', gotoken_idx)
-			return
+			return 'void'
 		}
-		p.async_fn_call(method, 0, var_name, v.typ)
+		return p.async_fn_call(method, 0, var_name, v.typ, joinable)
 	}
 	else {
 		f_name := p.lit
@@ -4022,12 +4243,12 @@ fn (p mut Parser) go_statement() {
 		f := p.table.find_fn(p.prepend_mod(f_name)) or {
 			println( p.table.debug_fns() )
 			p.error_with_token_index('can not find function $f_name', gotoken_idx)
-			return
+			return 'void'
 		}
 		if f.name == 'println' || f.name == 'print' {
 			p.error_with_token_index('`go` cannot be used with `println`', gotoken_idx)
 		}
-		p.async_fn_call(f, 0, '', '')
+		return p.async_fn_call(f, 0, '', '', joinable)
 	}
 }
 
@@ -73,12 +73,12 @@ fn (p mut Parser) get_type2() Type {
 		p.next()
 		p.check(.lsbr)
 		key_type := p.check_name()
-		if key_type != 'string' {
-			p.error('maps only support string keys for now')
+		if key_type != 'string' && !(key_type in int_map_key_types) {
+			p.error('maps only support string, integer and pointer keys')
 		}
 		p.check(.rsbr)
 		val_type := p.get_type()// p.check_name()
-		typ = 'map_$val_type'
+		typ = map_type_name(key_type, val_type)
 		p.register_map(typ)
 		return Type{name: typ}
 	}
@@ -0,0 +1,118 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module compiler
+
+import (
+	os
+	hash.crc32
+)
+
+/*
+Profile-guided optimization.
+
+	v -pgo-gen -o app app.v                     # instrumented build
+	./app --typical-workload                    # writes the profile
+	v -pgo-use -o app app.v                     # optimized build
+	v -pgo-train './app --bench' -o app app.v   # all three steps
+
+Profiles live in ~/.vmodules/cache/pgo/<app>/<hash>/, where <hash> is the
+checksum of the generated C code. gcc names the profile files after the C
+file and the binary, so the C code is compiled from a copy in that directory
+(`main.c`) instead of the temporary `app.tmp.c`. If the program has changed
+since `-pgo-gen`, there's no profile for the new hash, and `-pgo-use` warns
+and does a regular build.
+*/
+
+fn (v &V) pgo_dir(c_code string) string {
+	sum := crc32.sum(c_code.bytes())
+	return v.pgo_app_dir() + os.path_separator + sum.str()
+}
+
+fn (v &V) pgo_app_dir() string {
+	return '$v_modules_path${os.path_separator}cache${os.path_separator}pgo' +
+		os.path_separator + os.filename(v.out_name)
+}
+
+// Returns the C compiler flags for -pgo-gen/-pgo-use and the C file that
+// has to be compiled with them.
+fn (v mut V) pgo_setup() (string, string) {
+	if v.pref.ccompiler.contains('tcc') {
+		verror('-pgo-gen and -pgo-use require gcc or clang, use `-cc gcc`')
+	}
+	c_code := os.read_file(v.out_name_c) or {
+		verror(err)
+		return '', ''
+	}
+	dir := v.pgo_dir(c_code)
+	c_file := dir + os.path_separator + 'main.c'
+	is_clang := v.pref.ccompiler.contains('clang')
+	// Profiles collected without optimizations are useless
+	opt := if v.pref.is_prod { '' } else { '-O2 ' }
+	if v.pref.pgo_gen {
+		if !os.dir_exists(dir) {
+			os.mkdir_all(dir)
+		}
+		// Start with an empty profile, the counters of all runs are added up
+		for f in os.ls(dir) {
+			if f.ends_with('.gcda') || f.ends_with('.profraw') || f.ends_with('.profdata') {
+				os.rm(dir + os.path_separator + f)
+			}
+		}
+		os.write_file(c_file, c_code)
+		return opt + '-fprofile-generate="$dir"', c_file
+	}
+	// -pgo-use
+	if !pgo_has_profile(dir) {
+		if os.dir_exists(v.pgo_app_dir()) && os.ls(v.pgo_app_dir()).len > 0 {
+			println('warning: the PGO profile of `$v.out_name` is stale, the program has ' +
+				'changed since `-pgo-gen`. Building without it.')
+		}
+		else {
+			println('warning: no PGO profile for `$v.out_name`, build it with `-pgo-gen` ' +
+				'and run it first. Building without it.')
+		}
+		return opt, v.out_name_c
+	}
+	os.write_file(c_file, c_code)
+	if is_clang {
+		profdata := dir + os.path_separator + 'default.profdata'
+		ret := os.system('llvm-profdata merge -output="$profdata" "$dir"/*.profraw')
+		if ret != 0 {
+			verror('`llvm-profdata merge` failed, it is needed for `-pgo-use` with clang')
+		}
+		return opt + '-fprofile-use="$profdata"', c_file
+	}
+	// -fprofile-correction: counters of multithreaded programs can be
+	// slightly inconsistent
+	return opt + '-fprofile-use="$dir" -fprofile-correction -Wno-missing-profile', c_file
+}
+
+fn pgo_has_profile(dir string) bool {
+	if !os.dir_exists(dir) {
+		return false
+	}
+	for f in os.ls(dir) {
+		if f.ends_with('.gcda') || f.ends_with('.profraw') {
+			return true
+		}
+	}
+	return false
+}
+
+// `-pgo-train cmd`: instrumented build, `cmd`, optimized build
+fn (v mut V) pgo_train() {
+	keep_c := v.pref.is_keep_c
+	v.pref.is_keep_c = true
+	v.pref.pgo_gen = true
+	v.cc()
+	println('PGO training: $v.pref.pgo_train')
+	if os.system(v.pref.pgo_train) != 0 {
+		verror('PGO training command `$v.pref.pgo_train` failed')
+	}
+	v.pref.pgo_gen = false
+	v.pref.pgo_use = true
+	v.pref.is_keep_c = keep_c
+	v.cc()
+}
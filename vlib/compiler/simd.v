@@ -0,0 +1,232 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module compiler
+
+import strings
+
+/*
+Builtin SIMD vector types.
+
+With GCC and Clang they are vector extension types
+(`typedef f32 f32x4 __attribute__((vector_size(16)))`), so `a + b` is
+a single instruction. tcc and msvc get a struct with a plain array and
+scalar loops instead, the V code is the same.
+
+	a := f32x4_load(xs.data)       // unaligned load of 4 f32s
+	b := f32x4_splat(2.0)          // all lanes set to 2.0
+	c := a * b + a                 // `+ - * /`, `& | ^` on integer vectors
+	mask := c.cmp_gt(b)            // i32x4, -1 in lanes where c > b
+	d := c.shuffle(idx)            // d[i] = c[idx[i] % 4]
+	c.store(ys.data)
+	x := c.sum() + c.at(0)
+
+`a == b` and `a != b` compare all lanes and return bool.
+Nothing here is V code, all operations are static inline C functions
+from simd_c_header(), registered in the table by register_simd_types().
+The header is only added to programs that use the types (`has_simd`).
+*/
+
+const (
+	simd_types = ['f32x4', 'f32x8', 'i32x4', 'i32x8', 'u8x16', 'u8x32']
+)
+
+fn is_simd_type(typ string) bool {
+	return typ in simd_types
+}
+
+// f32x4 => f32, i32x4 => int, u8x16 => byte
+fn simd_elem_type(typ string) string {
+	if typ.starts_with('f32') {
+		return 'f32'
+	}
+	if typ.starts_with('i32') {
+		return 'int'
+	}
+	return 'byte'
+}
+
+fn simd_elem_size(elm string) int {
+	if elm == 'byte' {
+		return 1
+	}
+	return 4
+}
+
+fn simd_lanes(typ string) int {
+	return typ.all_after('x').int()
+}
+
+// The type of lane-wise comparison results and of shuffle indexes:
+// an integer vector with the same number and size of lanes.
+fn simd_mask_type(typ string) string {
+	if typ.starts_with('f32') {
+		return 'i32x' + simd_lanes(typ).str()
+	}
+	return typ
+}
+
+// `+` => `add` for `f32x4_add(a, b)`
+fn simd_op_name(tok TokenKind) string {
+	switch tok {
+	case TokenKind.plus: return 'add'
+	case TokenKind.minus: return 'sub'
+	case TokenKind.mul: return 'mul'
+	case TokenKind.div: return 'div'
+	case TokenKind.amp: return 'and'
+	case TokenKind.pipe: return 'or'
+	case TokenKind.xor: return 'xor'
+	}
+	return ''
+}
+
+// `<` => `cmp_lt`
+fn simd_cmp_name(tok TokenKind) string {
+	switch tok {
+	case TokenKind.lt: return 'cmp_lt'
+	case TokenKind.le: return 'cmp_le'
+	case TokenKind.gt: return 'cmp_gt'
+	case TokenKind.ge: return 'cmp_ge'
+	case TokenKind.ne: return 'cmp_ne'
+	}
+	return 'cmp_eq'
+}
+
+fn (t mut Table) register_simd_types() {
+	for typ in simd_types {
+		t.register_type(typ)
+		elm := simd_elem_type(typ)
+		mask := simd_mask_type(typ)
+		for cmp in ['eq', 'ne', 'lt', 'le', 'gt', 'ge'] {
+			t.register_simd_method(typ, 'cmp_$cmp', mask, [typ])
+		}
+		t.register_simd_method(typ, 'min', typ, [typ])
+		t.register_simd_method(typ, 'max', typ, [typ])
+		t.register_simd_method(typ, 'shuffle', typ, [mask])
+		t.register_simd_method(typ, 'sum', elm, []string)
+		t.register_simd_method(typ, 'at', elm, ['int'])
+		t.register_simd_method(typ, 'with', typ, ['int', elm])
+		t.register_simd_method(typ, 'store', 'void', ['void*'])
+		t.register_fn(Fn {
+			name: '${typ}_load'
+			mod: 'builtin'
+			typ: typ
+			is_public: true
+			args: [Var{name: 'ptr', typ: 'void*', is_arg: true}]
+		})
+		t.register_fn(Fn {
+			name: '${typ}_splat'
+			mod: 'builtin'
+			typ: typ
+			is_public: true
+			args: [Var{name: 'x', typ: elm, is_arg: true}]
+		})
+	}
+}
+
+fn (t mut Table) register_simd_method(typ, name, ret_typ string, arg_types []string) {
+	mut args := [Var{name: 'a', typ: typ, is_arg: true}]
+	for i, arg_typ in arg_types {
+		args << Var{name: 'arg$i', typ: arg_typ, is_arg: true}
+	}
+	mut T := t.typesmap[typ]
+	T.methods << Fn {
+		name: name
+		mod: 'builtin'
+		typ: ret_typ
+		receiver_typ: typ
+		is_method: true
+		is_public: true
+		args: args
+	}
+	t.typesmap[typ] = T
+}
+
+// Generates the C types and functions for all SIMD types
+fn simd_c_header() string {
+	mut sb := strings.new_builder(20000)
+	sb.writeln('
+//================================== SIMD ====================================*/
+#if defined(__GNUC__) && !defined(__TINYC__)
+#define _SIMD_VEC 1
+#define _SIMD_AT(v, i) (v)[i]
+#else
+#define _SIMD_AT(v, i) (v).e[i]
+#endif')
+	// Types first, f32x4 functions use i32x4 masks
+	for typ in simd_types {
+		elm := simd_elem_type(typ)
+		n := simd_lanes(typ)
+		sb.writeln('#ifdef _SIMD_VEC')
+		sb.writeln('typedef $elm $typ __attribute__((vector_size(${n * simd_elem_size(elm)})));')
+		sb.writeln('#else')
+		sb.writeln('typedef struct { $elm e[$n]; } $typ;')
+		sb.writeln('#endif')
+	}
+	for typ in simd_types {
+		elm := simd_elem_type(typ)
+		mask := simd_mask_type(typ)
+		n := simd_lanes(typ)
+		loop := 'for (int i = 0; i < $n; i++)'
+		mut ops := ['add', 'sub', 'mul', 'div']
+		mut c_ops := ['+', '-', '*', '/']
+		if elm != 'f32' {
+			ops << 'and'
+			ops << 'or'
+			ops << 'xor'
+			c_ops << '&'
+			c_ops << '|'
+			c_ops << '^'
+		}
+		for i, op in ops {
+			c_op := c_ops[i]
+			sb.writeln('static inline $typ ${typ}_$op($typ a, $typ b) {
+#ifdef _SIMD_VEC
+	return a $c_op b;
+#else
+	$typ r; $loop r.e[i] = a.e[i] $c_op b.e[i]; return r;
+#endif
+}')
+		}
+		cmps := ['eq', 'ne', 'lt', 'le', 'gt', 'ge']
+		c_cmps := ['==', '!=', '<', '<=', '>', '>=']
+		for i, cmp in cmps {
+			c_cmp := c_cmps[i]
+			sb.writeln('static inline $mask ${typ}_cmp_$cmp($typ a, $typ b) {
+#ifdef _SIMD_VEC
+	return ($mask)(a $c_cmp b);
+#else
+	$mask r; $loop r.e[i] = a.e[i] $c_cmp b.e[i] ? -1 : 0; return r;
+#endif
+}')
+		}
+		sb.writeln('static inline bool ${typ}_eq($typ a, $typ b) {
+	$loop if (_SIMD_AT(a, i) != _SIMD_AT(b, i)) return 0;
+	return 1;
+}
+static inline bool ${typ}_ne($typ a, $typ b) { return !${typ}_eq(a, b); }
+static inline $typ ${typ}_min($typ a, $typ b) {
+	$typ r; $loop _SIMD_AT(r, i) = _SIMD_AT(a, i) < _SIMD_AT(b, i) ? _SIMD_AT(a, i) : _SIMD_AT(b, i); return r;
+}
+static inline $typ ${typ}_max($typ a, $typ b) {
+	$typ r; $loop _SIMD_AT(r, i) = _SIMD_AT(a, i) > _SIMD_AT(b, i) ? _SIMD_AT(a, i) : _SIMD_AT(b, i); return r;
+}
+static inline $typ ${typ}_shuffle($typ a, $mask idx) {
+#if defined(_SIMD_VEC) && !defined(__clang__)
+	return __builtin_shuffle(a, idx);
+#else
+	$typ r; $loop _SIMD_AT(r, i) = _SIMD_AT(a, _SIMD_AT(idx, i) & ${n - 1}); return r;
+#endif
+}
+static inline $elm ${typ}_sum($typ a) {
+	$elm s = 0; $loop s += _SIMD_AT(a, i); return s;
+}
+static inline $elm ${typ}_at($typ a, int i) { return _SIMD_AT(a, i & ${n - 1}); }
+static inline $typ ${typ}_with($typ a, int i, $elm x) { _SIMD_AT(a, i & ${n - 1}) = x; return a; }
+static inline $typ ${typ}_load(void* p) { $typ r; memcpy(&r, p, sizeof(r)); return r; }
+static inline void ${typ}_store($typ a, void* p) { memcpy(p, &a, sizeof(a)); }
+static inline $typ ${typ}_splat($elm x) { $typ r; $loop _SIMD_AT(r, i) = x; return r; }')
+	}
+	return sb.str()
+}
@@ -21,6 +21,11 @@ mut:
 	fn_cnt       int //atomic
 	obfuscate    bool
 	varg_access  []VargAccess
+	strsets      map[string]string // generated lookup fns for constant string sets, see optimization.v
+	has_parallel_for bool // [parallel] loops are used, needs -fopenmp
+	has_simd     bool // SIMD types are used, needs simd_c_header()
+	alloc_sites  []string // "file:line" of the statements of `v -profile_alloc`, see cgen.v
+	alloc_site_ids map[string]int
 	//names        []Name
 }
 
@@ -261,6 +266,7 @@ fn new_table(obfuscate bool) &Table {
 	t.register_const('errno', 'int', 'main')
 	t.register_type_with_parent('map_string', 'map')
 	t.register_type_with_parent('map_int', 'map')
+	t.register_simd_types()
 	return t
 }
 
@@ -297,10 +303,92 @@ fn (p mut Parser) register_map(typ string) {
 		println('bad map $typ')
 		return
 	}
-	if !p.table.known_type(typ) {
+	if p.table.known_type(typ) {
+		return
+	}
+	key := map_key_type(typ)
+	if key == 'string' {
 		p.register_type_with_parent(typ, 'map')
 		p.cgen.typedefs << 'typedef map $typ;'
+		return
+	}
+	// `map[int]User` is an `intmap` with typed `keys()` and `delete()`
+	// wrappers, they convert the keys from/to u64
+	p.register_type_with_parent(typ, 'intmap')
+	p.register_array('array_$key')
+	p.cgen.typedefs << 'typedef intmap $typ;'
+	keys_fn := Fn {
+		name: 'keys'
+		mod: 'builtin'
+		typ: 'array_$key'
+		receiver_typ: typ
+		is_method: true
+		is_public: true
+		args: [Var{name: 'm', typ: typ + '*', is_arg: true, ref: true}]
+	}
+	delete_fn := Fn {
+		name: 'delete'
+		mod: 'builtin'
+		typ: 'void'
+		receiver_typ: typ
+		is_method: true
+		is_public: true
+		args: [Var{name: 'm', typ: typ + '*', is_arg: true, is_mut: true, ptr: true},
+			Var{name: 'key', typ: map_key_arg_type(typ), is_arg: true}]
+	}
+	// `delete` is a C++ keyword, get the C names from fn_gen_name()
+	mut intmap_delete := delete_fn
+	intmap_delete.receiver_typ = 'intmap'
+	p.cgen.typedefs << '#define ${p.table.fn_gen_name(keys_fn)}(m) intmap_keys(m)'
+	p.cgen.typedefs << '#define ${p.table.fn_gen_name(delete_fn)}(m, key) ' +
+		'${p.table.fn_gen_name(intmap_delete)}(m, (u64)(key))'
+	mut T := p.table.typesmap[typ]
+	T.methods << keys_fn
+	T.methods << delete_fn
+	p.table.typesmap[typ] = T
+}
+
+// `map[K]V` key types other than string, see vlib/builtin/intmap.v
+const (
+	int_map_key_types = ['int', 'i8', 'i16', 'i64', 'byte', 'u16', 'u32', 'u64',
+		'voidptr', 'byteptr']
+)
+
+// `map[string]User` => `map_User`, `map[int]User` => `map_int_User`
+fn map_type_name(key, val string) string {
+	if key == 'string' {
+		return 'map_$val'
+	}
+	return 'map_${key}_$val'
+}
+
+// `map_int_User` => `int`, `map_User` => `string`
+fn map_key_type(typ string) string {
+	for key in int_map_key_types {
+		if typ.starts_with('map_${key}_') {
+			return key
+		}
+	}
+	return 'string'
+}
+
+// The type `m[key]` and `m.delete(key)` check `key` against,
+// any pointer is a `map[voidptr]T` key
+fn map_key_arg_type(typ string) string {
+	key := map_key_type(typ)
+	if key == 'voidptr' {
+		return 'void*'
+	}
+	return key
+}
+
+// `map_int_User` => `User`
+fn map_val_type(typ string) string {
+	key := map_key_type(typ)
+	if key == 'string' {
+		return typ.right(4)
 	}
+	return typ.right(key.len + 5)
 }
 
 fn (table &Table) known_mod(mod string) bool {
@@ -0,0 +1,79 @@
+import os
+
+const (
+	prog = 'fn items(n int) []string {
+	mut a := []string
+	for i := 0; i < n; i++ {
+		a << \'item \$i\'
+	}
+	return a
+}
+
+fn main() {
+	for r := 0; r < 10; r++ {
+		a := items(100)
+		a.free()
+	}
+	s := \'x\'.repeat(100000)
+	println(s.len)
+}
+'
+	// The report is written by the first allocation after the signal
+	signal_prog = 'import os
+
+fn exists() string {
+	return if os.file_exists(\'alloc_profile.txt\') { \'yes\' } else { \'no\' }
+}
+
+fn main() {
+	C.kill(C.getpid(), C.SIGUSR1)
+	println(exists())
+	s := \'x\'.repeat(10)
+	println(exists() + s.len.str())
+}
+'
+)
+
+fn test_profile_alloc() {
+	vroot := os.dir(os.dir(os.dir(os.dir(os.executable()))))
+	vexe := vroot + os.path_separator + 'v'
+	dir := os.dir(os.executable())
+	src := dir + os.path_separator + 'alloc_prof_prog.v'
+	exe := dir + os.path_separator + 'alloc_prof_prog'
+	report_path := dir + os.path_separator + 'alloc_profile.txt'
+	os.write_file(src, prog)
+	build := os.exec('$vexe -profile_alloc -o $exe $src') or { panic(err) }
+	os.rm(src)
+	assert build.exit_code == 0
+	res := os.exec('cd $dir && $exe') or { panic(err) }
+	os.rm(exe)
+	assert res.output.trim_space() == '100000'
+	report := os.read_file(report_path) or { panic(err) }
+	os.rm(report_path)
+	lines := report.split_into_lines()
+	assert lines[0].contains(' allocations, ')
+	// The repeat() is first by bytes, the interpolation by allocations
+	assert lines[4].ends_with('  $src:14')
+	assert lines[4].contains(' 100001 ')
+	by_count := lines.index('By allocations:') + 2
+	assert lines[by_count].ends_with('  $src:4')
+}
+
+fn test_profile_alloc_signal() {
+	$if windows {
+		return
+	}
+	vroot := os.dir(os.dir(os.dir(os.dir(os.executable()))))
+	vexe := vroot + os.path_separator + 'v'
+	dir := os.dir(os.executable())
+	src := dir + os.path_separator + 'alloc_prof_signal_prog.v'
+	exe := dir + os.path_separator + 'alloc_prof_signal_prog'
+	os.write_file(src, signal_prog)
+	build := os.exec('$vexe -profile_alloc -o $exe $src') or { panic(err) }
+	os.rm(src)
+	assert build.exit_code == 0
+	res := os.exec('cd $dir && $exe') or { panic(err) }
+	os.rm(exe)
+	os.rm(dir + os.path_separator + 'alloc_profile.txt')
+	assert res.output.trim_space() == 'no\nyes10'
+}
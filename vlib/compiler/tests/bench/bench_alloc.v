@@ -0,0 +1,106 @@
+// A string heavy workload (formatting, `to_upper()`, maps, `join()`) on 1
+// and 4 threads, and 1 million small blocks allocated and freed one by one
+// or with an `Arena`. Build it with each allocator to compare them:
+//
+// v -prod -allocator=libc -o bench_alloc vlib/compiler/tests/bench/bench_alloc.v
+// ./bench_alloc
+// v -prod -allocator=pool -o bench_alloc vlib/compiler/tests/bench/bench_alloc.v
+// ./bench_alloc
+//
+// For the compiler itself, build it with each allocator (the executable has
+// to be next to vlib/) and time it generating its own C code:
+//
+// v -prod -allocator=arena -o v_arena v.v
+// time ./v_arena -o /tmp/v.c v.v
+module main
+
+import (
+	benchmark
+	parallel
+)
+
+const (
+	records = 102400
+	rounds  = 10
+)
+
+struct Job {
+	sums []int
+}
+
+fn process_records(start, end int) int {
+	mut lines := []string
+	for i := start; i < end; i++ {
+		lines << 'user$i,name${i % 97},city${i % 13},${i * 7}'
+	}
+	mut counts := map[string]int
+	mut total := 0
+	for line in lines {
+		fields := line.split(',')
+		city := fields[2].to_upper()
+		counts[city] = counts[city] + 1
+		total += fields[3].int()
+		fields.free()
+	}
+	joined := lines.join('\n')
+	total += joined.len + counts.size
+	joined.free()
+	for line in lines {
+		line.free()
+	}
+	lines.free()
+	counts.free()
+	return total
+}
+
+fn process_chunk(job &Job, start, end int) {
+	mut sums := job.sums
+	for i := start; i < end; i += 1000 {
+		mut e := i + 1000
+		if e > end {
+			e = end
+		}
+		sums[i / 1000] = process_records(i, e)
+	}
+}
+
+fn main() {
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	n := records * rounds
+	job := Job{ sums: [0].repeat(n / 1000) }
+	for threads in [1, 4] {
+		parallel.set_threads(threads)
+		bmark.step()
+		parallel.pfor_each(n, &job, process_chunk)
+		bmark.ok()
+		println(bmark.step_message('strings, $threads threads  $n records'))
+		for x in job.sums {
+			sum += x
+		}
+	}
+	mut blocks := [byteptr(0)].repeat(1000 * 1000)
+	bmark.step()
+	for r := 0; r < 10; r++ {
+		for i := 0; i < blocks.len; i++ {
+			blocks[i] = malloc(32 + i % 64)
+		}
+		for b in blocks {
+			free(voidptr(b))
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('malloc/free         10 x 1M blocks'))
+	mut arena := new_arena(1024 * 1024)
+	bmark.step()
+	for r := 0; r < 10; r++ {
+		for i := 0; i < blocks.len; i++ {
+			blocks[i] = arena.alloc(32 + i % 64)
+		}
+		arena.reset()
+	}
+	bmark.ok()
+	println(bmark.step_message('Arena               10 x 1M blocks'))
+	arena.free()
+	println('checksum: $sum')
+}
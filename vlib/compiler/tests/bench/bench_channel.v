@@ -0,0 +1,105 @@
+// Throughput of `sync.Channel`: ints from 1 producer to 1 consumer, from 4
+// producers to 1 consumer, and from 4 producers to 4 consumers, 10 million
+// through a channel of 1024 ints and 1 million through an unbuffered one,
+// where each one is a handoff. Latency: the round trip of an int sent back
+// and forth between 2 threads.
+//
+// v -prod -o bench_channel vlib/compiler/tests/bench/bench_channel.v
+// ./bench_channel
+module main
+
+import (
+	benchmark
+	sync
+)
+
+const (
+	nr_ping_pong = 100 * 1000
+)
+
+fn produce(ch sync.Channel, nr int, wg &sync.WaitGroup) {
+	for i := 0; i < nr; i++ {
+		ch.push(&i)
+	}
+	wg.done()
+}
+
+fn consume(ch sync.Channel, sum &sync.AtomicU64, wg &sync.WaitGroup) {
+	x := 0
+	mut s := u64(0)
+	for ch.pop(&x) {
+		s += u64(x)
+	}
+	sum.fetch_add(s)
+	wg.done()
+}
+
+fn close_when_done(ch sync.Channel, wg &sync.WaitGroup) {
+	wg.wait()
+	ch.close()
+}
+
+fn throughput(cap, n, nr_producers, nr_consumers int) {
+	ch := sync.new_channel(cap, sizeof(int))
+	producers := &sync.WaitGroup{}
+	consumers := &sync.WaitGroup{}
+	sum := &sync.AtomicU64{}
+	producers.add(nr_producers)
+	consumers.add(nr_consumers)
+	nr := n / nr_producers
+	mut bmark := benchmark.new_benchmark()
+	bmark.step()
+	for i := 0; i < nr_consumers; i++ {
+		go consume(ch, sum, consumers)
+	}
+	for i := 0; i < nr_producers; i++ {
+		go produce(ch, nr, producers)
+	}
+	go close_when_done(ch, producers)
+	consumers.wait()
+	bmark.ok()
+	if sum.load() != u64(nr_producers) * u64(nr) * u64(nr - 1) / u64(2) {
+		panic('lost values')
+	}
+	println(bmark.step_message('cap $cap, $nr_producers to $nr_consumers, $n values'))
+	ch.free()
+}
+
+fn pong(ping, pong sync.Channel) {
+	x := 0
+	for ping.pop(&x) {
+		pong.push(&x)
+	}
+}
+
+fn latency(cap int) {
+	ping := sync.new_channel(cap, sizeof(int))
+	pong := sync.new_channel(cap, sizeof(int))
+	go pong(ping, pong)
+	x := 0
+	mut bmark := benchmark.new_benchmark()
+	bmark.step()
+	for i := 0; i < nr_ping_pong; i++ {
+		ping.push(&i)
+		pong.pop(&x)
+	}
+	bmark.ok()
+	ping.close()
+	ms := bmark.step_end_time - bmark.step_start_time
+	ns := ms * i64(1000000) / i64(nr_ping_pong)
+	println(bmark.step_message('cap $cap, $nr_ping_pong round trips, $ns ns each'))
+}
+
+fn main() {
+	for cap in [1024, 0] {
+		mut n := 10 * 1000 * 1000
+		if cap == 0 {
+			n = 1000 * 1000
+		}
+		throughput(cap, n, 1, 1)
+		throughput(cap, n, 4, 1)
+		throughput(cap, n, 4, 4)
+	}
+	latency(1)
+	latency(0)
+}
@@ -0,0 +1,97 @@
+// Starts 100 thousand tasks that do nothing with `go`, then with a thread
+// each (`pthread_create()`, what `go` did before it had a pool), and waits
+// for them. Then fork-join: `fib(27)` starting a task for each call above
+// the cutoff and waiting for it with `wait()`.
+//
+// v -prod -o bench_go vlib/compiler/tests/bench/bench_go.v
+// ./bench_go
+module main
+
+import (
+	benchmark
+	sync
+)
+
+const (
+	nr_tasks   = 100 * 1000
+	fib_n      = 27
+	fib_cutoff = 10
+)
+
+#include <pthread.h>
+
+// `C.pthread_t` is declared in builtin
+struct Thread {
+	thread C.pthread_t
+}
+
+fn nothing(wg &sync.WaitGroup) {
+	wg.done()
+}
+
+fn thread_nothing(wg &sync.WaitGroup) voidptr {
+	wg.done()
+	return voidptr(0)
+}
+
+fn fib_serial(n int) int {
+	if n < 2 {
+		return n
+	}
+	return fib_serial(n - 1) + fib_serial(n - 2)
+}
+
+fn fib(n int) int {
+	if n < fib_cutoff {
+		return fib_serial(n)
+	}
+	h := go fib(n - 1)
+	b := fib(n - 2)
+	return h.wait() + b
+}
+
+fn main() {
+	wg := &sync.WaitGroup{}
+	mut bmark := benchmark.new_benchmark()
+	// The pool starts with the first task
+	wg.add(1)
+	go nothing(wg)
+	wg.wait()
+	wg.add(nr_tasks)
+	bmark.step()
+	for i := 0; i < nr_tasks; i++ {
+		go nothing(wg)
+	}
+	bmark.ok()
+	ms := bmark.step_end_time - bmark.step_start_time
+	println(bmark.step_message('go, $nr_tasks tasks started, ${ms * i64(1000000) / i64(nr_tasks)} ns each'))
+	bmark.step()
+	wg.wait()
+	bmark.ok()
+	println(bmark.step_message('go, waiting for them'))
+	wg.add(nr_tasks)
+	t := &Thread(malloc(sizeof(Thread)))
+	bmark.step()
+	for i := 0; i < nr_tasks; i++ {
+		C.pthread_create(&t.thread, 0, thread_nothing, wg)
+		C.pthread_detach(t.thread)
+	}
+	bmark.ok()
+	ms2 := bmark.step_end_time - bmark.step_start_time
+	println(bmark.step_message('pthread_create, $nr_tasks threads started, ${ms2 * i64(1000000) / i64(nr_tasks)} ns each'))
+	bmark.step()
+	wg.wait()
+	bmark.ok()
+	println(bmark.step_message('pthread_create, waiting for them'))
+	bmark.step()
+	f := fib(fib_n)
+	bmark.ok()
+	if f != fib_serial(fib_n) {
+		panic('fib($fib_n) = $f')
+	}
+	println(bmark.step_message('fib($fib_n) with go and wait()'))
+	bmark.step()
+	fib_serial(fib_n)
+	bmark.ok()
+	println(bmark.step_message('fib($fib_n) serial'))
+}
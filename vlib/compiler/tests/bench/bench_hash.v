@@ -0,0 +1,66 @@
+// Hashing throughput of `string.hash()` (wyhash, see vlib/builtin/hash.v)
+// and of the byte at a time hashes it replaced: `h * 31 + c`, the old
+// `string.hash()`, and FNV-1a, the old map hash. Each key length is hashed
+// until about `total` bytes have been read.
+//
+// v -prod -o bench_hash vlib/compiler/tests/bench/bench_hash.v
+// ./bench_hash 1000000000
+module main
+
+import (
+	os
+	benchmark
+)
+
+fn hash31(s string) int {
+	mut h := 0
+	for i := 0; i < s.len; i++ {
+		h = h * 31 + int(s.str[i])
+	}
+	return h
+}
+
+fn fnv1a(s string) u32 {
+	mut h := u32(2166136261)
+	for i := 0; i < s.len; i++ {
+		h = (h ^ u32(s.str[i])) * u32(16777619)
+	}
+	return h
+}
+
+fn main() {
+	mut total := 200000000
+	if os.args.len > 1 {
+		total = os.args[1].int()
+	}
+	mut bmark := benchmark.new_benchmark()
+	for len in [3, 8, 16, 32, 64, 256, 4096] {
+		// A few different keys, so the loop can't be hoisted
+		mut keys := []string
+		for i := 0; i < 16; i++ {
+			keys << 'k'.repeat(len - 1) + i.str().left(1)
+		}
+		n := total / len
+		mb := total / 1000000
+		mut sum := u64(0)
+		bmark.step()
+		for i := 0; i < n; i++ {
+			sum += u64(hash31(keys[i & 15]))
+		}
+		bmark.ok()
+		println(bmark.step_message('h*31+c   len=$len  $mb MB'))
+		bmark.step()
+		for i := 0; i < n; i++ {
+			sum += u64(fnv1a(keys[i & 15]))
+		}
+		bmark.ok()
+		println(bmark.step_message('FNV-1a   len=$len  $mb MB'))
+		bmark.step()
+		for i := 0; i < n; i++ {
+			sum += u64(keys[i & 15].hash())
+		}
+		bmark.ok()
+		println(bmark.step_message('wyhash   len=$len  $mb MB'))
+		println('checksum: $sum')
+	}
+}
@@ -0,0 +1,211 @@
+// Compares the builtin `map[string]int` (an open addressing hash table, see
+// vlib/builtin/map.v) with the unbalanced binary search tree it replaced,
+// for insert, get, delete and iteration. Keys are inserted in random order,
+// and in sorted order, which degrades the tree into a list.
+// `map[int]int` is compared with `map[string]int` keyed by `id.str()`.
+//
+// v -prod -o bench_map vlib/compiler/tests/bench/bench_map.v
+// ./bench_map 10000000
+module main
+
+import (
+	os
+	benchmark
+)
+
+// The old map, with int values
+struct BstNode {
+mut:
+	left     &BstNode
+	right    &BstNode
+	is_empty bool
+	key      string
+	val      int
+}
+
+struct BstMap {
+mut:
+	root &BstNode
+	size int
+}
+
+fn (m mut BstMap) set(key string, val int) {
+	if isnil(m.root) {
+		m.root = &BstNode{key: key, val: val, left: 0, right: 0}
+		m.size++
+		return
+	}
+	mut n := m.root
+	for {
+		if n.key == key {
+			n.val = val
+			return
+		}
+		if n.key > key {
+			if isnil(n.left) {
+				n.left = &BstNode{key: key, val: val, left: 0, right: 0}
+				m.size++
+				return
+			}
+			n = n.left
+		}
+		else {
+			if isnil(n.right) {
+				n.right = &BstNode{key: key, val: val, left: 0, right: 0}
+				m.size++
+				return
+			}
+			n = n.right
+		}
+	}
+}
+
+fn (m &BstMap) find(key string) &BstNode {
+	mut n := m.root
+	for !isnil(n) {
+		if n.key == key {
+			return n
+		}
+		n = if n.key > key { n.left } else { n.right }
+	}
+	return 0
+}
+
+fn (m &BstMap) get(key string) int {
+	n := m.find(key)
+	if isnil(n) || n.is_empty {
+		return 0
+	}
+	return n.val
+}
+
+fn (m mut BstMap) delete(key string) {
+	mut n := m.find(key)
+	if !isnil(n) {
+		n.is_empty = true
+		n.val = 0
+	}
+	m.size--
+}
+
+fn bst_sum(n &BstNode) int {
+	if isnil(n) {
+		return 0
+	}
+	mut sum := bst_sum(n.left) + bst_sum(n.right)
+	if !n.is_empty {
+		sum += n.val
+	}
+	return sum
+}
+
+fn bench(keys []string, label string, with_bst bool) {
+	mut bmark := benchmark.new_benchmark()
+	mut m := map[string]int
+	mut sum := 0
+	bmark.step()
+	for i, key in keys {
+		m[key] = i
+	}
+	bmark.ok()
+	println(bmark.step_message('map   insert  $label'))
+	bmark.step()
+	for key in keys {
+		sum += m[key]
+	}
+	bmark.ok()
+	println(bmark.step_message('map   get     $label'))
+	bmark.step()
+	for _, val in m {
+		sum += val
+	}
+	bmark.ok()
+	println(bmark.step_message('map   iterate $label'))
+	bmark.step()
+	for i := 0; i < keys.len; i += 2 {
+		m.delete(keys[i])
+	}
+	bmark.ok()
+	println(bmark.step_message('map   delete  $label, size=$m.size'))
+	if !with_bst {
+		println('')
+		return
+	}
+	mut bst := BstMap{root: 0}
+	bmark.step()
+	for i, key in keys {
+		bst.set(key, i)
+	}
+	bmark.ok()
+	println(bmark.step_message('bst   insert  $label'))
+	bmark.step()
+	for key in keys {
+		sum -= bst.get(key)
+	}
+	bmark.ok()
+	println(bmark.step_message('bst   get     $label'))
+	bmark.step()
+	sum -= bst_sum(bst.root)
+	bmark.ok()
+	println(bmark.step_message('bst   iterate $label'))
+	bmark.step()
+	for i := 0; i < keys.len; i += 2 {
+		bst.delete(keys[i])
+	}
+	bmark.ok()
+	println(bmark.step_message('bst   delete  $label, size=$bst.size'))
+	println('checksum: $sum\n')
+}
+
+fn bench_int_keys(keys []int) {
+	n := keys.len
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	mut m := map[int]int
+	bmark.step()
+	for i, key in keys {
+		m[key] = i
+	}
+	for key in keys {
+		sum += m[key]
+	}
+	bmark.ok()
+	println(bmark.step_message('map[int]           set+get n=$n'))
+	mut sm := map[string]int
+	bmark.step()
+	for i, key in keys {
+		sm[key.str()] = i
+	}
+	for key in keys {
+		sum -= sm[key.str()]
+	}
+	bmark.ok()
+	println(bmark.step_message('map[string] .str() set+get n=$n'))
+	println('checksum: $sum\n')
+}
+
+fn main() {
+	mut max := 1000000
+	if os.args.len > 1 {
+		max = os.args[1].int()
+	}
+	for n := 1000; n <= max; n *= 10 {
+		// A permutation of 0..n: 7919 is a prime that doesn't divide n
+		mut keys := []string
+		mut int_keys := []int
+		for i := 0; i < n; i++ {
+			k := int(i64(i) * i64(7919) % i64(n))
+			keys << 'key_' + k.str()
+			int_keys << k
+		}
+		bench(keys, 'n=$n random', true)
+		mut sorted := []string
+		for i := 0; i < n; i++ {
+			k := n + i
+			sorted << 'key_' + k.str()
+		}
+		// The tree is a list with sorted keys, O(n^2)
+		bench(sorted, 'n=$n sorted', n <= 10000)
+		bench_int_keys(int_keys)
+	}
+}
@@ -0,0 +1,45 @@
+// Formats and parses 1 million ints and floats with `str()`, `int()` and
+// `f64()`:
+//
+// v -prod -o bench_numbers vlib/compiler/tests/bench/bench_numbers.v
+// ./bench_numbers
+module main
+
+import benchmark
+
+const (
+	n = 1000 * 1000
+)
+
+fn main() {
+	mut ints := []string
+	mut floats := []string
+	mut bmark := benchmark.new_benchmark()
+	bmark.step()
+	for i := 0; i < n; i++ {
+		ints << (i * 7919 - n).str()
+	}
+	bmark.ok()
+	println(bmark.step_message('int.str()  $n ints'))
+	bmark.step()
+	for i := 0; i < n; i++ {
+		floats << (f64(i) / f64(100)).str()
+	}
+	bmark.ok()
+	println(bmark.step_message('f64.str()  $n floats'))
+	mut sum := i64(0)
+	bmark.step()
+	for s in ints {
+		sum += i64(s.int())
+	}
+	bmark.ok()
+	println(bmark.step_message('int()      $n ints'))
+	mut fsum := f64(0)
+	bmark.step()
+	for s in floats {
+		fsum += s.f64()
+	}
+	bmark.ok()
+	println(bmark.step_message('f64()      $n floats'))
+	println('$sum $fsum')
+}
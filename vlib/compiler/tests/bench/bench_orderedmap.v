@@ -0,0 +1,129 @@
+// Compares range queries on an `orderedmap.OrderedMap` (a B-tree) with the
+// usual workaround on a `map`: sorting `m.keys()` for every query, and
+// binary searching the sorted keys for the start of the range.
+//
+// v -prod -o bench_orderedmap vlib/compiler/tests/bench/bench_orderedmap.v
+// ./bench_orderedmap 100000
+module main
+
+import (
+	os
+	benchmark
+	orderedmap
+)
+
+const (
+	nr_queries = 100
+	range_len  = 100
+)
+
+fn key(i int) string {
+	n := i + 10000000
+	return 'key_' + n.str()
+}
+
+// The first index in sorted `keys` with a key >= `k`
+fn lower_bound(keys []string, k string) int {
+	mut lo := 0
+	mut hi := keys.len
+	for lo < hi {
+		mid := (lo + hi) / 2
+		if keys[mid] < k {
+			lo = mid + 1
+		}
+		else {
+			hi = mid
+		}
+	}
+	return lo
+}
+
+fn main() {
+	mut n := 100000
+	if os.args.len > 1 {
+		n = os.args[1].int()
+	}
+	mut bmark := benchmark.new_benchmark()
+	// A permutation of 0..n: 7919 is a prime that doesn't divide n
+	mut keys := []string
+	for i := 0; i < n; i++ {
+		keys << key(int(i64(i) * i64(7919) % i64(n)))
+	}
+	mut m := map[string]int
+	bmark.step()
+	for i, k in keys {
+		m[k] = i
+	}
+	bmark.ok()
+	println(bmark.step_message('map         insert     n=$n'))
+	mut om := orderedmap.new(sizeof(int))
+	bmark.step()
+	for i, k in keys {
+		om.set(k, &i)
+	}
+	bmark.ok()
+	println(bmark.step_message('OrderedMap  insert     n=$n'))
+	mut sum := 0
+	bmark.step()
+	for k in keys {
+		sum += m[k]
+	}
+	bmark.ok()
+	println(bmark.step_message('map         get        n=$n'))
+	bmark.step()
+	x := 0
+	for k in keys {
+		om.get(k, &x)
+		sum -= x
+	}
+	bmark.ok()
+	println(bmark.step_message('OrderedMap  get        n=$n'))
+	mut sorted := keys.clone()
+	sorted.sort()
+	vals := [0].repeat(n)
+	bmark.step()
+	bulk := orderedmap.from_sorted(sorted, vals.data, sizeof(int))
+	bmark.ok()
+	println(bmark.step_message('OrderedMap  from_sorted n=$bulk.size'))
+	// `nr_queries` ranges of `range_len` keys
+	bmark.step()
+	for q := 0; q < nr_queries; q++ {
+		from := key(q * (n / nr_queries))
+		mut ks := m.keys()
+		ks.sort()
+		start := lower_bound(ks, from)
+		for i := start; i < start + range_len && i < ks.len; i++ {
+			sum += m[ks[i]]
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('map         $nr_queries ranges (sort keys each time)'))
+	bmark.step()
+	for q := 0; q < nr_queries; q++ {
+		from := key(q * (n / nr_queries))
+		mut it := om.range(from, key(q * (n / nr_queries) + range_len))
+		for it.next() {
+			val := &int(it.val)
+			sum -= *val
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('OrderedMap  $nr_queries ranges'))
+	bmark.step()
+	mut ks := m.keys()
+	ks.sort()
+	for k in ks {
+		sum += m[k]
+	}
+	bmark.ok()
+	println(bmark.step_message('map         sorted iteration'))
+	bmark.step()
+	mut it := om.iter()
+	for it.next() {
+		val := &int(it.val)
+		sum -= *val
+	}
+	bmark.ok()
+	println(bmark.step_message('OrderedMap  sorted iteration'))
+	println('checksum: $sum')
+}
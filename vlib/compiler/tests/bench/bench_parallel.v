@@ -0,0 +1,83 @@
+// Times `pmap()`, `pfilter()`, `preduce()` and `psort()` of the parallel
+// module on 10 million ints with 1, 2, 4, 8 and 16 threads. With 1 thread
+// they run on the calling thread, like a plain loop or `sort()`.
+// The speedup can't be higher than the number of CPUs.
+//
+// v -prod -o bench_parallel vlib/compiler/tests/bench/bench_parallel.v
+// ./bench_parallel
+module main
+
+import (
+	benchmark
+	parallel
+	runtime
+)
+
+const (
+	n = 10 * 1000 * 1000
+)
+
+fn next_rand(seed u32) u32 {
+	return seed * u32(1103515245) + u32(12345)
+}
+
+// A bit of work per element, so that the memory bandwidth isn't all that
+// is measured
+fn hash(x int) int {
+	mut h := u32(x)
+	for i := 0; i < 8; i++ {
+		h = (h ^ (h >> u32(15))) * u32(2246822519)
+	}
+	return int(h >> u32(1))
+}
+
+fn is_odd(x int) bool {
+	return hash(x) % 2 == 1
+}
+
+fn max(a, b int) int {
+	if a > b {
+		return a
+	}
+	return b
+}
+
+fn main() {
+	cpus := runtime.nr_cpus()
+	println('$cpus CPUs')
+	mut a := []int
+	mut seed := u32(1)
+	for i := 0; i < n; i++ {
+		seed = next_rand(seed)
+		a << int(seed >> u32(1))
+	}
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	for threads in [1, 2, 4, 8, 16] {
+		parallel.set_threads(threads)
+		bmark.step()
+		m := parallel.pmap(a, hash)
+		sum += m[n / 2]
+		bmark.ok()
+		println(bmark.step_message('pmap     $threads threads'))
+		m.free()
+		bmark.step()
+		f := parallel.pfilter(a, is_odd)
+		sum += f.len
+		bmark.ok()
+		println(bmark.step_message('pfilter  $threads threads'))
+		f.free()
+		bmark.step()
+		sum += parallel.preduce(a, max, 0)
+		bmark.ok()
+		println(bmark.step_message('preduce  $threads threads'))
+		mut b := a.clone()
+		bmark.step()
+		parallel.psort(mut b)
+		sum += b[n / 2]
+		bmark.ok()
+		println(bmark.step_message('psort    $threads threads'))
+		b.free()
+	}
+	println('checksum: $sum')
+}
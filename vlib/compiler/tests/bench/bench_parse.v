@@ -0,0 +1,56 @@
+// Parsing throughput of `csv.Reader` and `http.parse_headers()`, which are
+// mostly `substr()`, `left()` and `right()` calls, so they show the cost of
+// taking substrings (views into the parent string, see vlib/builtin/string.v).
+//
+// v -prod -o bench_parse vlib/compiler/tests/bench/bench_parse.v
+// ./bench_parse 100
+module main
+
+import (
+	os
+	benchmark
+	strings
+	encoding.csv
+	http
+)
+
+fn main() {
+	mut n := 100
+	if os.args.len > 1 {
+		n = os.args[1].int()
+	}
+	mut sb := strings.new_builder(1024 * 1024)
+	for sb.len < 1024 * 1024 {
+		sb.write('1024,Tom,Jerry,2019-11-02 12:34:56,"GET /index.html",200,0.125\n')
+	}
+	data := sb.str()
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	bmark.step()
+	for i := 0; i < n; i++ {
+		mut r := csv.new_reader(data)
+		for {
+			record := r.read() or {
+				break
+			}
+			sum += record.len
+			record.free()
+		}
+		free(r)
+	}
+	bmark.ok()
+	println(bmark.step_message('csv.Reader.read()     $n x 1 MB'))
+	mut lines := []string
+	for i := 0; i < 20; i++ {
+		lines << 'X-Header-$i: some value for the header number $i'
+	}
+	bmark.step()
+	for i := 0; i < n * 1000; i++ {
+		mut headers := http.parse_headers(lines)
+		sum += headers.size
+		headers.free()
+	}
+	bmark.ok()
+	println(bmark.step_message('http.parse_headers()  ${n * 1000} x 20 headers'))
+	println('checksum: $sum')
+}
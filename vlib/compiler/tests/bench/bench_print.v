@@ -0,0 +1,44 @@
+// Prints 10 million lines with `println()` of a string, of an int, of an
+// interpolated string, and with `print_many()`. The times go to stderr, so
+// stdout can be a pipe, where the output is written in blocks, or a terminal,
+// where it is written at every call:
+//
+// v -prod -o bench_print vlib/compiler/tests/bench/bench_print.v
+// ./bench_print | wc -l
+// ./bench_print > /dev/null
+module main
+
+import benchmark
+
+const (
+	n = 10 * 1000 * 1000
+)
+
+fn main() {
+	mut bmark := benchmark.new_benchmark()
+	bmark.step()
+	for i := 0; i < n; i++ {
+		println('hello world')
+	}
+	bmark.ok()
+	eprintln(bmark.step_message('println(string)    $n lines'))
+	bmark.step()
+	for i := 0; i < n; i++ {
+		println(i)
+	}
+	bmark.ok()
+	eprintln(bmark.step_message('println(int)       $n lines'))
+	bmark.step()
+	for i := 0; i < n; i++ {
+		println('line $i')
+	}
+	bmark.ok()
+	eprintln(bmark.step_message('println(\'line \$i\') $n lines'))
+	lines := ['hello world'].repeat(1000)
+	bmark.step()
+	for i := 0; i < n / 1000; i++ {
+		print_many(lines)
+	}
+	bmark.ok()
+	eprintln(bmark.step_message('print_many()       $n lines'))
+}
@@ -0,0 +1,74 @@
+// Compares `strings.Replacer` (one pass over the string with an Aho-Corasick
+// automaton, see vlib/strings/aho_corasick.v) with a chain of `replace()`
+// calls, escaping 10 characters in a 1 MB body, and `strings.MultiSearcher`
+// with calling `index()` for each pattern.
+//
+// v -prod -o bench_replacer vlib/compiler/tests/bench/bench_replacer.v
+// ./bench_replacer 100
+module main
+
+import (
+	os
+	benchmark
+	strings
+)
+
+const (
+	escapes = ['&', '&amp;', '<', '&lt;', '>', '&gt;', '"', '&quot;', '\'', '&#39;',
+		'\n', '<br>', '\t', '&#9;', '=', '&#61;', '`', '&#96;', '\\', '&#92;']
+)
+
+fn main() {
+	mut n := 100
+	if os.args.len > 1 {
+		n = os.args[1].int()
+	}
+	line := '<p class="msg">Tom & Jerry\'s "best" <b>episodes</b>\tare here</p>\n'
+	body := line.repeat(1024 * 1024 / line.len)
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	bmark.step()
+	for i := 0; i < n; i++ {
+		mut s := body
+		for j := 0; j < escapes.len; j += 2 {
+			next := s.replace(escapes[j], escapes[j + 1])
+			if s.str != body.str && next.str != s.str {
+				s.free()
+			}
+			s = next
+		}
+		sum += s.len
+		s.free()
+	}
+	bmark.ok()
+	println(bmark.step_message('10 x replace()       $n x 1 MB'))
+	r := strings.new_replacer(escapes)
+	bmark.step()
+	for i := 0; i < n; i++ {
+		s := r.replace(body)
+		sum -= s.len
+		s.free()
+	}
+	bmark.ok()
+	println(bmark.step_message('Replacer.replace()   $n x 1 MB'))
+	mut patterns := []string
+	for i := 0; i < 20; i++ {
+		patterns << 'missing pattern $i'
+	}
+	m := strings.new_multi_searcher(patterns)
+	bmark.step()
+	for i := 0; i < n; i++ {
+		for p in patterns {
+			sum += body.index(p)
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('20 x index()         $n x 1 MB'))
+	bmark.step()
+	for i := 0; i < n; i++ {
+		sum -= m.index(body) * patterns.len
+	}
+	bmark.ok()
+	println(bmark.step_message('MultiSearcher.index() $n x 1 MB'))
+	println('checksum: $sum')
+}
@@ -0,0 +1,156 @@
+// `sort()` of `[]int`, `[]f64` and `[]string` (radix sorts, see
+// vlib/builtin/sort.v), `sort_with_compare()` (pdqsort) and `sort_by_key()`,
+// compared with C's `qsort()`, which `sort()` used to call, on random
+// arrays from 1e3 elements up to `max` (1e7 by default, 1e8 needs about
+// 10 GB of memory for the strings). The smaller arrays are sorted many times,
+// so that each size sorts about `max` elements in total.
+//
+// v -prod -o bench_sort vlib/compiler/tests/bench/bench_sort.v
+// ./bench_sort 100000000
+module main
+
+import (
+	os
+	benchmark
+)
+
+struct Item {
+	key  int
+	name string
+}
+
+fn compare_ints(a, b &int) int {
+	if *a < *b {
+		return -1
+	}
+	if *a > *b {
+		return 1
+	}
+	return 0
+}
+
+fn compare_f64s(a, b &f64) int {
+	if *a < *b {
+		return -1
+	}
+	if *a > *b {
+		return 1
+	}
+	return 0
+}
+
+fn compare_strings(a, b &string) int {
+	if *a < *b {
+		return -1
+	}
+	if *a > *b {
+		return 1
+	}
+	return 0
+}
+
+fn compare_items(a, b &Item) int {
+	if a.key < b.key {
+		return -1
+	}
+	if a.key > b.key {
+		return 1
+	}
+	return 0
+}
+
+fn item_key(it &Item) i64 {
+	return i64(it.key)
+}
+
+fn main() {
+	mut max := 10000000
+	if os.args.len > 1 {
+		max = os.args[1].int()
+	}
+	mut bmark := benchmark.new_benchmark()
+	mut seed := u64(42)
+	for n := 1000; n <= max; n *= 10 {
+		reps := max / n
+		mut ints := []int
+		mut floats := []f64
+		mut strs := []string
+		mut items := []Item
+		for i := 0; i < n; i++ {
+			seed = seed * u64(6364136223846793005) + u64(1442695040888963407)
+			x := int(u64(seed >> u64(33)))
+			ints << x
+			floats << f64(x) / 7.0
+			strs << 'user_${x}_name'
+			items << Item{ key: x, name: '' }
+		}
+		mut a := ints.clone()
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(a.data, ints.data, n * sizeof(int))
+			C.qsort(a.data, n, sizeof(int), compare_ints)
+		}
+		bmark.ok()
+		println(bmark.step_message('qsort []int              n=$n x $reps'))
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(a.data, ints.data, n * sizeof(int))
+			a.sort()
+		}
+		bmark.ok()
+		println(bmark.step_message('[]int.sort()             n=$n x $reps'))
+		mut f := floats.clone()
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(f.data, floats.data, n * sizeof(f64))
+			C.qsort(f.data, n, sizeof(f64), compare_f64s)
+		}
+		bmark.ok()
+		println(bmark.step_message('qsort []f64              n=$n x $reps'))
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(f.data, floats.data, n * sizeof(f64))
+			f.sort()
+		}
+		bmark.ok()
+		println(bmark.step_message('[]f64.sort()             n=$n x $reps'))
+		mut s := strs.clone()
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(s.data, strs.data, n * sizeof(string))
+			C.qsort(s.data, n, sizeof(string), compare_strings)
+		}
+		bmark.ok()
+		println(bmark.step_message('qsort []string           n=$n x $reps'))
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(s.data, strs.data, n * sizeof(string))
+			s.sort()
+		}
+		bmark.ok()
+		println(bmark.step_message('[]string.sort()          n=$n x $reps'))
+		mut it := items.clone()
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(it.data, items.data, n * sizeof(Item))
+			C.qsort(it.data, n, sizeof(Item), compare_items)
+		}
+		bmark.ok()
+		println(bmark.step_message('qsort []Item             n=$n x $reps'))
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(it.data, items.data, n * sizeof(Item))
+			it.sort_with_compare(compare_items)
+		}
+		bmark.ok()
+		println(bmark.step_message('sort_with_compare()      n=$n x $reps'))
+		bmark.step()
+		for r := 0; r < reps; r++ {
+			C.memcpy(it.data, items.data, n * sizeof(Item))
+			it.sort_by_key(item_key)
+		}
+		bmark.ok()
+		println(bmark.step_message('sort_by_key()            n=$n x $reps'))
+		println('')
+	}
+}
@@ -0,0 +1,59 @@
+// Reads 3 of the 20 columns of a tab-separated log with `split()` and with
+// `split_iter()`, which stops after the last column that's needed, and the
+// lines with `split_into_lines()` and `lines_iter()`.
+//
+// v -prod -o bench_split vlib/compiler/tests/bench/bench_split.v
+// ./bench_split 100
+module main
+
+import (
+	os
+	benchmark
+	strings
+)
+
+fn main() {
+	mut n := 100
+	if os.args.len > 1 {
+		n = os.args[1].int()
+	}
+	mut cols := []string
+	for i := 0; i < 20; i++ {
+		cols << 'column$i'
+	}
+	line := cols.join('\t') + '\n'
+	mut sb := strings.new_builder(1024 * 1024 + line.len)
+	for sb.len < 1024 * 1024 {
+		sb.write(line)
+	}
+	log := sb.str()
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	bmark.step()
+	for i := 0; i < n; i++ {
+		lines := log.split_into_lines()
+		for l in lines {
+			fields := l.split('\t')
+			sum += fields[0].len + fields[3].len + fields[7].len
+			fields.free()
+		}
+		lines.free()
+	}
+	bmark.ok()
+	println(bmark.step_message('split()       $n x 1 MB'))
+	bmark.step()
+	for i := 0; i < n; i++ {
+		mut lines := log.lines_iter()
+		for lines.next() {
+			mut fields := lines.val.split_iter('\t')
+			for col := 0; col <= 7 && fields.next(); col++ {
+				if col == 0 || col == 3 || col == 7 {
+					sum -= fields.val.len
+				}
+			}
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('split_iter()  $n x 1 MB'))
+	println('checksum: $sum')
+}
@@ -0,0 +1,201 @@
+// Compares a 50-arm `match` on string literals (compiled into a length
+// switch plus a perfect hash, see vlib/compiler/optimization.v) with the
+// equivalent chain of `==` comparisons.
+//
+// v -prod -o bench_string_match vlib/compiler/tests/bench/bench_string_match.v
+// ./bench_string_match
+module main
+
+import benchmark
+
+const (
+	nr_iterations = 2000000
+)
+
+fn by_match(s string) int {
+	match s {
+		'assert' => { return 0 }
+		'break' => { return 1 }
+		'case' => { return 2 }
+		'const' => { return 3 }
+		'continue' => { return 4 }
+		'default' => { return 5 }
+		'defer' => { return 6 }
+		'else' => { return 7 }
+		'embed' => { return 8 }
+		'enum' => { return 9 }
+		'false' => { return 10 }
+		'for' => { return 11 }
+		'fn' => { return 12 }
+		'global' => { return 13 }
+		'go' => { return 14 }
+		'goto' => { return 15 }
+		'if' => { return 16 }
+		'import' => { return 17 }
+		'in' => { return 18 }
+		'interface' => { return 19 }
+		'match' => { return 20 }
+		'module' => { return 21 }
+		'mut' => { return 22 }
+		'none' => { return 23 }
+		'return' => { return 24 }
+		'select' => { return 25 }
+		'sizeof' => { return 26 }
+		'struct' => { return 27 }
+		'switch' => { return 28 }
+		'true' => { return 29 }
+		'type' => { return 30 }
+		'union' => { return 31 }
+		'pub' => { return 32 }
+		'static' => { return 33 }
+		'get' => { return 34 }
+		'post' => { return 35 }
+		'put' => { return 36 }
+		'patch' => { return 37 }
+		'delete' => { return 38 }
+		'head' => { return 39 }
+		'options' => { return 40 }
+		'index' => { return 41 }
+		'login' => { return 42 }
+		'logout' => { return 43 }
+		'users' => { return 44 }
+		'posts' => { return 45 }
+		'comments' => { return 46 }
+		'search' => { return 47 }
+		'admin' => { return 48 }
+		'static_files' => { return 49 }
+	}
+	return -1
+}
+
+fn by_eq(s string) int {
+	if s == 'assert' {
+		return 0
+	} else if s == 'break' {
+		return 1
+	} else if s == 'case' {
+		return 2
+	} else if s == 'const' {
+		return 3
+	} else if s == 'continue' {
+		return 4
+	} else if s == 'default' {
+		return 5
+	} else if s == 'defer' {
+		return 6
+	} else if s == 'else' {
+		return 7
+	} else if s == 'embed' {
+		return 8
+	} else if s == 'enum' {
+		return 9
+	} else if s == 'false' {
+		return 10
+	} else if s == 'for' {
+		return 11
+	} else if s == 'fn' {
+		return 12
+	} else if s == 'global' {
+		return 13
+	} else if s == 'go' {
+		return 14
+	} else if s == 'goto' {
+		return 15
+	} else if s == 'if' {
+		return 16
+	} else if s == 'import' {
+		return 17
+	} else if s == 'in' {
+		return 18
+	} else if s == 'interface' {
+		return 19
+	} else if s == 'match' {
+		return 20
+	} else if s == 'module' {
+		return 21
+	} else if s == 'mut' {
+		return 22
+	} else if s == 'none' {
+		return 23
+	} else if s == 'return' {
+		return 24
+	} else if s == 'select' {
+		return 25
+	} else if s == 'sizeof' {
+		return 26
+	} else if s == 'struct' {
+		return 27
+	} else if s == 'switch' {
+		return 28
+	} else if s == 'true' {
+		return 29
+	} else if s == 'type' {
+		return 30
+	} else if s == 'union' {
+		return 31
+	} else if s == 'pub' {
+		return 32
+	} else if s == 'static' {
+		return 33
+	} else if s == 'get' {
+		return 34
+	} else if s == 'post' {
+		return 35
+	} else if s == 'put' {
+		return 36
+	} else if s == 'patch' {
+		return 37
+	} else if s == 'delete' {
+		return 38
+	} else if s == 'head' {
+		return 39
+	} else if s == 'options' {
+		return 40
+	} else if s == 'index' {
+		return 41
+	} else if s == 'login' {
+		return 42
+	} else if s == 'logout' {
+		return 43
+	} else if s == 'users' {
+		return 44
+	} else if s == 'posts' {
+		return 45
+	} else if s == 'comments' {
+		return 46
+	} else if s == 'search' {
+		return 47
+	} else if s == 'admin' {
+		return 48
+	} else if s == 'static_files' {
+		return 49
+	}
+	return -1
+}
+
+fn main() {
+	// Hits at the start, middle and end of the arms, plus misses
+	keys := ('assert return union static_files comments options x typo statics ' +
+		'defer goto in mut pub head admin search index match struct 1234567').split(' ')
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	bmark.step()
+	for i := 0; i < nr_iterations; i++ {
+		for key in keys {
+			sum += by_match(key)
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('match (perfect hash), sum=$sum'))
+	sum = 0
+	bmark.step()
+	for i := 0; i < nr_iterations; i++ {
+		for key in keys {
+			sum += by_eq(key)
+		}
+	}
+	bmark.ok()
+	println(bmark.step_message('chain of string_eq(), sum=$sum'))
+	bmark.stop()
+	println(bmark.total_message('50-arm string match'))
+}
@@ -0,0 +1,205 @@
+// Compares `string.index()`, `index_any()`, `count()`, `split()` and
+// `replace()` (memchr/memcmp based, see vlib/builtin/string.v) with the
+// byte at a time versions they replaced, on log lines from 1 KB to 100 MB.
+// Every size is searched until about 100 MB have been read.
+//
+// v -prod -o bench_string_search vlib/compiler/tests/bench/bench_string_search.v
+// ./bench_string_search
+module main
+
+import (
+	benchmark
+	strings
+)
+
+const (
+	total = 100 * 1024 * 1024
+)
+
+fn old_index_after(s string, p string, start int) int {
+	mut i := start
+	for i < s.len {
+		mut j := 0
+		mut ii := i
+		for j < p.len && s[ii] == p[j] {
+			j++
+			ii++
+		}
+		if j == p.len {
+			return i
+		}
+		i++
+	}
+	return -1
+}
+
+fn old_index_any(s string, chars string) int {
+	for c in chars {
+		index := old_index_after(s, c.str(), 0)
+		if index != -1 {
+			return index
+		}
+	}
+	return -1
+}
+
+fn old_count(s string, p string) int {
+	mut n := 0
+	mut i := 0
+	for {
+		i = old_index_after(s, p, i)
+		if i == -1 {
+			return n
+		}
+		i += p.len
+		n++
+	}
+	return 0
+}
+
+fn old_replace(s string, rep, with string) string {
+	mut sb := strings.new_builder(s.len)
+	mut rem := s
+	for {
+		i := old_index_after(rem, rep, 0)
+		if i < 0 {
+			break
+		}
+		sb.write(rem.left(i))
+		sb.write(with)
+		// `substr()` used to copy
+		next := rem.substr(i + rep.len, rem.len).clone()
+		if rem.str != s.str {
+			rem.free()
+		}
+		rem = next
+	}
+	sb.write(rem)
+	return sb.str()
+}
+
+fn old_split(s string, delim string) []string {
+	mut res := []string
+	mut i := 0
+	mut start := 0
+	for i < s.len {
+		mut a := s[i] == delim[0]
+		mut j := 1
+		for j < delim.len && a {
+			a = a && s[i + j] == delim[j]
+			j++
+		}
+		last := i == s.len - 1
+		if a || last {
+			if last {
+				i++
+			}
+			mut val := s.substr(start, i)
+			if val.len > 0 {
+				if val.starts_with(delim) {
+					val = val.right(delim.len)
+				}
+				res << val.trim_space()
+			}
+			start = i
+		}
+		i++
+	}
+	return res
+}
+
+fn log_text(size int) string {
+	line := '2019-11-02 12:34:56 INFO request served method=GET path=/index.html status=200\n'
+	mut sb := strings.new_builder(size + line.len)
+	for sb.len < size {
+		sb.write(line)
+	}
+	// What is searched for is at the very end
+	sb.write('ERROR disk full;')
+	return sb.str()
+}
+
+fn main() {
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	for size in [1024, 64 * 1024, 1024 * 1024, 100 * 1024 * 1024] {
+		s := log_text(size)
+		reps := total / size
+		kb := size / 1024
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += old_index_after(s, 'ERROR disk', 0)
+		}
+		bmark.ok()
+		println(bmark.step_message('old index      $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += s.index('ERROR disk')
+		}
+		bmark.ok()
+		println(bmark.step_message('new index      $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += old_index_any(s, ';!')
+			sum += old_index_any(s, '!#$%&;')
+		}
+		bmark.ok()
+		println(bmark.step_message('old index_any  $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += s.index_any(';!')
+			sum += s.index_any('!#$%&;')
+		}
+		bmark.ok()
+		println(bmark.step_message('new index_any  $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += old_count(s, 'status=')
+		}
+		bmark.ok()
+		println(bmark.step_message('old count      $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			sum += s.count('status=')
+		}
+		bmark.ok()
+		println(bmark.step_message('new count      $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			parts := old_split(s, ' INFO ')
+			sum += parts.len
+			parts.free()
+		}
+		bmark.ok()
+		println(bmark.step_message('old split      $kb KB'))
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			parts := s.split(' INFO ')
+			sum += parts.len
+			parts.free()
+		}
+		bmark.ok()
+		println(bmark.step_message('new split      $kb KB'))
+		// The old `replace()` copied the rest of the string after every
+		// match, so it only runs on the smaller inputs
+		if size <= 64 * 1024 {
+			bmark.step()
+			for i := 0; i < reps; i++ {
+				res := old_replace(s, 'GET', 'POST')
+				sum += res.len
+				res.free()
+			}
+			bmark.ok()
+			println(bmark.step_message('old replace    $kb KB'))
+		}
+		bmark.step()
+		for i := 0; i < reps; i++ {
+			res := s.replace('GET', 'POST')
+			sum += res.len
+			res.free()
+		}
+		bmark.ok()
+		println(bmark.step_message('new replace    $kb KB'))
+	}
+	println('checksum: $sum')
+}
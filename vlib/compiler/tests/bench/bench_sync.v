@@ -0,0 +1,102 @@
+// Times 10 million increments of a shared counter by 1, 2, 4 and 8 threads,
+// under a `sync.Mutex`, a pthread mutex, a `sync.RwMutex` and with
+// `sync.AtomicInt`. With 1 thread the locks are never contended, which is
+// the case the futex fast path is for.
+//
+// v -prod -o bench_sync vlib/compiler/tests/bench/bench_sync.v
+// ./bench_sync
+module main
+
+import (
+	benchmark
+	sync
+)
+
+const (
+	n = 10 * 1000 * 1000
+)
+
+#include <pthread.h>
+
+// `C.pthread_mutex_t` is declared in builtin
+struct Counter {
+mut:
+	n       int
+	mutex   sync.Mutex
+	pmutex  C.pthread_mutex_t
+	rw      sync.RwMutex
+	hits    sync.AtomicInt
+}
+
+fn inc_mutex(c &Counter, nr int, wg &sync.WaitGroup) {
+	for i := 0; i < nr; i++ {
+		c.mutex.lock()
+		c.n++
+		c.mutex.unlock()
+	}
+	wg.done()
+}
+
+fn inc_pthread(c &Counter, nr int, wg &sync.WaitGroup) {
+	for i := 0; i < nr; i++ {
+		C.pthread_mutex_lock(&c.pmutex)
+		c.n++
+		C.pthread_mutex_unlock(&c.pmutex)
+	}
+	wg.done()
+}
+
+fn inc_rw(c &Counter, nr int, wg &sync.WaitGroup) {
+	for i := 0; i < nr; i++ {
+		c.rw.lock()
+		c.n++
+		c.rw.unlock()
+	}
+	wg.done()
+}
+
+fn inc_atomic(c &Counter, nr int, wg &sync.WaitGroup) {
+	for i := 0; i < nr; i++ {
+		c.hits.fetch_add(1)
+	}
+	wg.done()
+}
+
+fn run(name string, kind, nr_threads int) {
+	c := &Counter{}
+	C.pthread_mutex_init(&c.pmutex, 0)
+	wg := &sync.WaitGroup{}
+	wg.add(nr_threads)
+	mut bmark := benchmark.new_benchmark()
+	bmark.step()
+	for i := 0; i < nr_threads; i++ {
+		if kind == 0 {
+			go inc_mutex(c, n / nr_threads, wg)
+		}
+		else if kind == 1 {
+			go inc_pthread(c, n / nr_threads, wg)
+		}
+		else if kind == 2 {
+			go inc_rw(c, n / nr_threads, wg)
+		}
+		else {
+			go inc_atomic(c, n / nr_threads, wg)
+		}
+	}
+	wg.wait()
+	bmark.ok()
+	total := c.n + c.hits.load()
+	if total != n / nr_threads * nr_threads {
+		panic('$name: $total increments')
+	}
+	println(bmark.step_message('$name $nr_threads threads'))
+}
+
+fn main() {
+	for nr_threads in [1, 2, 4, 8] {
+		run('sync.Mutex       ', 0, nr_threads)
+		run('pthread_mutex_t  ', 1, nr_threads)
+		run('sync.RwMutex     ', 2, nr_threads)
+		run('sync.AtomicInt   ', 3, nr_threads)
+	}
+}
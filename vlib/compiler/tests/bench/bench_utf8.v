@@ -0,0 +1,65 @@
+// `string.ustring()`, which counts the code points 8 bytes at a time and
+// only builds the rune index for non-ASCII text (see vlib/builtin/string.v),
+// compared with building the index byte by byte, as it used to, and the
+// throughput of `utf8_validate()`, on 1 MB of ASCII and of Cyrillic text.
+//
+// v -prod -o bench_utf8 vlib/compiler/tests/bench/bench_utf8.v
+// ./bench_utf8 100
+module main
+
+import (
+	os
+	benchmark
+)
+
+// The rune index of the old `ustring()`
+fn old_ustring(s string) []int {
+	mut runes := []int
+	for i := 0; i < s.len; i++ {
+		char_len := utf8_char_len(s.str[i])
+		runes << i
+		i += char_len - 1
+	}
+	return runes
+}
+
+fn main() {
+	mut n := 100
+	if os.args.len > 1 {
+		n = os.args[1].int()
+	}
+	ascii := 'The quick brown fox jumps over the lazy dog. '.repeat(1024 * 1024 / 45)
+	cyrillic := 'Съешь же ещё этих мягких французских булок. '.repeat(1024 * 1024 / 80)
+	texts := [ascii, cyrillic]
+	names := ['ASCII   ', 'Cyrillic']
+	mut bmark := benchmark.new_benchmark()
+	mut sum := 0
+	for t, s in texts {
+		name := names[t]
+		bmark.step()
+		for i := 0; i < n; i++ {
+			u := old_ustring(s)
+			sum += u.len
+			u.free()
+		}
+		bmark.ok()
+		println(bmark.step_message('old ustring()   $name $n x 1 MB'))
+		bmark.step()
+		for i := 0; i < n; i++ {
+			u := s.ustring()
+			sum -= u.len
+			u.free()
+		}
+		bmark.ok()
+		println(bmark.step_message('new ustring()   $name $n x 1 MB'))
+		bmark.step()
+		for i := 0; i < n; i++ {
+			if utf8_validate(s.str, s.len) {
+				sum++
+			}
+		}
+		bmark.ok()
+		println(bmark.step_message('utf8_validate() $name $n x 1 MB'))
+	}
+	println('checksum: $sum')
+}
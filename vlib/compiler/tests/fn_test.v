@@ -119,3 +119,32 @@ fn test_fns() {
 	// no asserts for now, just test function declarations above
 }
 
+
+[cold]
+fn cold_fail(n int) int {
+	println('cold_fail($n)')
+	return -1
+}
+
+[hot]
+fn hot_sum(a []int) int {
+	mut sum := 0
+	for x in a {
+		if x < 0 {
+			return cold_fail(x)
+		}
+		if _unlikely_(x == 1000) {
+			continue
+		}
+		sum += x
+	}
+	return sum
+}
+
+fn test_hot_cold_fns() {
+	assert hot_sum([1, 2, 3]) == 6
+	assert hot_sum([1, 1000, 3]) == 4
+	assert hot_sum([1, -2, 3]) == -1
+	assert _likely_(hot_sum([]int) == 0)
+	assert !_unlikely_(false)
+}
@@ -0,0 +1,87 @@
+import sync
+
+struct Point {
+	x int
+	y int
+}
+
+fn add(a, b int) int {
+	return a + b
+}
+
+fn (p Point) str2() string {
+	return '$p.x,$p.y'
+}
+
+fn double_all(a []int) []int {
+	mut res := []int
+	for x in a {
+		res << x * 2
+	}
+	return res
+}
+
+fn fib(n int) int {
+	if n < 2 {
+		return n
+	}
+	// Tasks that start tasks, most of them run on the waiting thread
+	h := go fib(n - 1)
+	b := fib(n - 2)
+	return h.wait() + b
+}
+
+fn inc(n &sync.AtomicInt, wg &sync.WaitGroup) {
+	n.fetch_add(1)
+	wg.done()
+}
+
+fn set(n &sync.AtomicInt, v int) {
+	n.store(v)
+}
+
+fn test_wait_returns() {
+	h := go add(2, 3)
+	assert h.wait() == 5
+	p := Point{1, 2}
+	s := go p.str2()
+	assert s.wait() == '1,2'
+	a := go double_all([1, 2, 3])
+	doubled := a.wait()
+	assert doubled.len == 3 && doubled[2] == 6
+	n := &sync.AtomicInt{}
+	v := go set(n, 7)
+	v.wait()
+	assert n.load() == 7
+	assert fib(20) == 6765
+}
+
+fn test_many_tasks() {
+	n := &sync.AtomicInt{}
+	wg := &sync.WaitGroup{}
+	wg.add(10000)
+	for i := 0; i < 10000; i++ {
+		go inc(n, wg)
+	}
+	wg.wait()
+	assert n.load() == 10000
+}
+
+// Each task waits for all of them to start, so they must all run at once,
+// on more workers than the pool starts with
+fn barrier(start, done &sync.WaitGroup) {
+	start.done()
+	start.wait()
+	done.done()
+}
+
+fn test_blocking_tasks() {
+	start := &sync.WaitGroup{}
+	done := &sync.WaitGroup{}
+	start.add(16)
+	done.add(16)
+	for i := 0; i < 16; i++ {
+		go barrier(start, done)
+	}
+	done.wait()
+}
@@ -86,3 +86,81 @@ fn test_match_enums(){
     }
     assert b == .blue
 }
+
+fn http_method(s string) int {
+	return match s {
+		'GET' => { 1 }
+		'PUT' => { 2 }
+		'POST', 'PATCH' => { 3 }
+		'DELETE' => { 4 }
+		'' => { 5 }
+		else => { 0 }
+	}
+}
+
+fn binary3(s string) int {
+	// every pair of positions collides, so the perfect hash is used
+	match s {
+		'aaa' => { return 0 }
+		'aab' => { return 1 }
+		'aba' => { return 2 }
+		'abb' => { return 3 }
+		'baa' => { return 4 }
+		'bab' => { return 5 }
+		'bba' => { return 6 }
+		'bbb' => { return 7 }
+	}
+	return -1
+}
+
+fn test_match_strings() {
+	assert http_method('GET') == 1
+	assert http_method('PUT') == 2
+	assert http_method('POST') == 3
+	assert http_method('PATCH') == 3
+	assert http_method('DELETE') == 4
+	assert http_method('') == 5
+	assert http_method('GE') == 0
+	assert http_method('GETS') == 0
+	assert http_method('PET') == 0
+	assert http_method('get') == 0
+	assert binary3('aaa') == 0
+	assert binary3('bab') == 5
+	assert binary3('bbb') == 7
+	assert binary3('abc') == -1
+	assert binary3('ab') == -1
+	s := 'b'
+	assert match s + 'ba' {
+		'aba', 'bab' => { 1 }
+		'bba' => { 2 }
+		else => { 3 }
+	} == 2
+}
+
+fn test_in_strings() {
+	methods := 'POST PUT PATCH'.split(' ')
+	for m in methods {
+		assert m in ['POST', 'PUT', 'PATCH', 'DELETE']
+		assert !(m in ['GET', 'HEAD'])
+	}
+	assert 'abb' in ['aaa', 'aab', 'aba', 'abb', 'baa', 'bab', 'bba', 'bbb']
+	assert !('abc' in ['aaa', 'aab', 'aba', 'abb', 'baa', 'bab', 'bba', 'bbb'])
+	assert 'x' in ['y', 'x', 'x']
+	name := 'v'
+	assert !('$name' in ['a', 'b'])
+	assert '-$name' in ['-h', '-$name']
+}
+
+// Strings of the same length that collide for every seed of the hash: a
+// Thue-Morse string and its complement
+fn thue_morse(s string) bool {
+	return s in ['abbabaabbaababbabaababbaabbabaabbaababbaabbabaababbabaabbaababbabaababbaabbabaababbabaabbaababbaabbabaabbaababbabaababbaabbabaabbaababbaabbabaababbabaabbaababbaabbabaabbaababbabaababbaabbabaababbabaabbaababbabaababbaabbabaabbaababbaabbabaababbabaabbaababba',
+		'baababbaabbabaababbabaabbaababbaabbabaabbaababbabaababbaabbabaababbabaabbaababbabaababbaabbabaabbaababbaabbabaababbabaabbaababbaabbabaabbaababbabaababbaabbabaabbaababbaabbabaababbabaabbaababbabaababbaabbabaababbabaabbaababbaabbabaabbaababbabaababbaabbabaab',
+		'aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa']
+}
+
+fn test_in_strings_without_hash() {
+	assert thue_morse('a'.repeat(256))
+	assert !thue_morse('b'.repeat(256))
+	assert !thue_morse('a')
+}
@@ -0,0 +1,69 @@
+import os
+
+fn test_parallel_range_reduction() {
+	mut sum := 0
+	mut prod := 1.0
+	[parallel]
+	for i in 0..10000 {
+		sum += i
+		if i < 10 {
+			prod *= 2.0
+		}
+	}
+	assert sum == 49995000
+	assert prod == 1024.0
+}
+
+fn test_parallel_array() {
+	nums := [1, 2, 3, 4, 5, 6, 7, 8, 9, 10]
+	mut squares := [0].repeat(nums.len)
+	mut total := i64(0)
+	mut odd := 0
+	[parallel]
+	for i, n in nums {
+		squares[i] = n * n
+		total += i64(n)
+		if n % 2 == 1 {
+			odd -= 1
+		}
+	}
+	assert squares[9] == 100
+	assert total == 55
+	assert odd == -5
+}
+
+fn test_parallel_values() {
+	words := ['a', 'bb', 'ccc']
+	mut n := 0
+	[parallel]
+	for w in words {
+		n += w.len
+	}
+	assert n == 6
+}
+
+// `<<`, `insert()` and `delete()` on an array of the enclosing scope change
+// its length from all the threads, they don't compile
+fn test_parallel_array_change() {
+	vroot := os.dir(os.dir(os.dir(os.dir(os.executable()))))
+	vexe := vroot + os.path_separator + 'v'
+	dir := os.dir(os.executable())
+	src := dir + os.path_separator + 'parallel_change_prog.v'
+	exe := dir + os.path_separator + 'parallel_change_prog'
+	for change in ['a << i', 'a.insert(0, i)', 'a.delete(0)'] {
+		prog := 'fn main() {
+	mut a := [0].repeat(10)
+	[parallel]
+	for i in 0..10 {
+		$change
+	}
+	println(a.len)
+}
+'
+		os.write_file(src, prog)
+		build := os.exec('$vexe -o $exe $src') or { panic(err) }
+		os.rm(src)
+		assert build.exit_code != 0
+		assert build.output.contains('`a` is shared by all iterations of a [parallel] loop')
+	}
+}
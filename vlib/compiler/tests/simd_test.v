@@ -0,0 +1,58 @@
+struct Particle {
+mut:
+	pos f32x4
+	vel f32x4
+}
+
+fn test_simd_arithmetic() {
+	xs := [f32(1.0), 2.0, 3.0, 4.0]
+	a := f32x4_load(xs.data)
+	b := f32x4_splat(2.0)
+	c := a * b + a - b / b
+	assert c.at(0) == 2.0
+	assert c.at(3) == 11.0
+	assert c.sum() == 26.0
+	ys := [f32(0.0)].repeat(4)
+	c.store(ys.data)
+	assert ys[1] == 5.0
+	assert a == f32x4_load(xs.data)
+	assert a != b
+	assert a.with(1, 2.0).at(1) == 2.0
+}
+
+fn test_simd_int_vectors() {
+	xs := [1, 2, 3, 4, 5, 6, 7, 8]
+	a := i32x8_load(xs.data)
+	b := i32x8_splat(6)
+	c := (a & b) | i32x8_splat(1)
+	assert c.at(0) == 1
+	assert c.at(5) == 7
+	assert (a ^ a).sum() == 0
+	assert a.min(b).sum() == 1 + 2 + 3 + 4 + 5 + 6 + 6 + 6
+	assert a.max(b).at(0) == 6
+	mask := a.cmp_gt(b)
+	assert mask.at(5) == 0
+	assert mask.at(6) == -1
+}
+
+fn test_simd_shuffle() {
+	xs := [f32(10.0), 20.0, 30.0, 40.0]
+	idx := [3, 2, 1, 0]
+	r := f32x4_load(xs.data).shuffle(i32x4_load(idx.data))
+	assert r.at(0) == 40.0
+	assert r.at(3) == 10.0
+	s := 'abcdefghijklmnop'
+	bytes := u8x16_load(s.str)
+	assert bytes.cmp_eq(u8x16_splat(`c`)).at(2) == 255
+}
+
+fn test_simd_struct_fields() {
+	mut p := Particle{
+		pos: f32x4_splat(1.0)
+		vel: f32x4_splat(0.5)
+	}
+	for i := 0; i < 4; i++ {
+		p.pos = p.pos + p.vel
+	}
+	assert p.pos.sum() == 12.0
+}
@@ -46,6 +46,17 @@ Options/commands:
                     It very significantly speeds up secondary compilations.
 
   -obf              Obfuscate the resulting binary.
+
+  -pgo-gen          Build an instrumented executable. Running it collects a profile for -pgo-use.
+  -pgo-use          Build an executable optimized with the profile collected by the -pgo-gen build.
+                    If the program has changed since -pgo-gen, the stale profile is ignored.
+  -pgo-train <cmd>  Build with -pgo-gen, run <cmd> (e.g. \'./app --bench\'), then build with -pgo-use.
+
+  -allocator=<a>    The memory allocator: libc (C\'s malloc, the default), pool (size classes with
+                    caches per thread) or arena (blocks are never freed, for short running programs).
+  -profile_alloc    Count the allocations and bytes of each statement, and the peak heap. The report
+                    is written to alloc_profile.txt at exit and on SIGUSR1.
+
   -                 Shorthand for `v runrepl`.
 
 Options for debugging/troubleshooting v programs:
@@ -180,7 +180,8 @@ pub fn new_context(cfg gg.Cfg) &Context {
 	}
 	println('Trying to load font from $font_path')
 	face := C.FT_Face{}
-	ret = int(C.FT_New_Face(ft, font_path.str, 0, &face))
+	// Not freed, FreeType keeps the path of the stream
+	ret = int(C.FT_New_Face(ft, font_path.cstr(), 0, &face))
 	if ret != 0	{
 		println('freetype: failed to load the font (error=$ret)')
 		exit(1)
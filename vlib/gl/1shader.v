@@ -154,7 +154,10 @@ pub fn (s Shader) use() {
 }
 
 pub fn (s Shader) uni_location(key string) int {
-	return C.glGetUniformLocation(s.program_id, key.str)
+	ckey := key.cstr()
+	loc := C.glGetUniformLocation(s.program_id, ckey)
+	key.free_cstr(ckey)
+	return loc
 }
 
 // fn (s Shader) set_mat4(str string, f *f32) {
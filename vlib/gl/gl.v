@@ -40,7 +40,9 @@ pub fn create_program() int {
 }
 
 pub fn shader_source(shader, a int, source string, b int) {
-	C.glShaderSource(shader, a, &source.str, b)
+	src := source.cstr()
+	C.glShaderSource(shader, a, &src, b)
+	source.free_cstr(src)
 }
 
 pub fn compile_shader(shader int) {
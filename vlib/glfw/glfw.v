@@ -119,7 +119,9 @@ pub fn create_window(c WinCfg) &Window {
 	if c.always_on_top {
 		window_hint(C.GLFW_FLOATING, 1)
 	}
-	cwindow := C.glfwCreateWindow(c.width, c.height, c.title.str, 0, 0)
+	ctitle := c.title.cstr()
+	cwindow := C.glfwCreateWindow(c.width, c.height, ctitle, 0, 0)
+	c.title.free_cstr(ctitle)
 	if isnil(cwindow) {
 		println('failed to create a glfw window, make sure you have a GPU driver installed')
 		C.glfwTerminate()
@@ -134,7 +136,9 @@ pub fn create_window(c WinCfg) &Window {
 }
 
 pub fn (w &Window) set_title(title string) {
-	C.glfwSetWindowTitle(w.data, title.str)
+	ctitle := title.cstr()
+	C.glfwSetWindowTitle(w.data, ctitle)
+	title.free_cstr(ctitle)
 }
 
 pub fn (w &Window) make_context_current() {
@@ -210,7 +214,9 @@ pub fn (w &Window) get_clipboard_text() string {
 }
 
 pub fn (w &Window) set_clipboard_text(s string) {
-	C.glfwSetClipboardString(w.data, s.str)
+	cs := s.cstr()
+	C.glfwSetClipboardString(w.data, cs)
+	s.free_cstr(cs)
 }
 
 pub fn (w &Window) get_cursor_pos() Pos {
@@ -50,7 +50,7 @@ fn (req &Request) ssl_do(port int, method, host_name, path string) ?Response {
 	if isnil(ctx) { 
 	} 
 	addr := host_name + ':' + port.str()
-	res = C.BIO_set_conn_hostname(web, addr.str) 
+	res = C.BIO_set_conn_hostname(web, addr.cstr()) 
 	if res != 1 {
 	} 
 	ssl := &C.SSL{!} 
@@ -58,17 +58,19 @@ fn (req &Request) ssl_do(port int, method, host_name, path string) ?Response {
 	if isnil(ssl) { 
 	} 
 	preferred_ciphers := 'HIGH:!aNULL:!kRSA:!PSK:!SRP:!MD5:!RC4' 
-	res = C.SSL_set_cipher_list(ssl, preferred_ciphers.str) 
+	res = C.SSL_set_cipher_list(ssl, preferred_ciphers.cstr()) 
 	if res != 1 {
 	} 
-	res = C.SSL_set_tlsext_host_name(ssl, host_name.str) 
+	chost := host_name.cstr()
+	res = C.SSL_set_tlsext_host_name(ssl, chost) 
+	host_name.free_cstr(chost)
 	res = C.BIO_do_connect(web) 
 	res = C.BIO_do_handshake(web) 
 	cert := C.SSL_get_peer_certificate(ssl) 
 	res = C.SSL_get_verify_result(ssl) 
 	///////
 	s := req.build_request_headers(method, host_name, path)
-	C.BIO_puts(web, s.str) 
+	C.BIO_puts(web, s.cstr()) 
 	mut sb := strings.new_builder(100) 
 	for {
 		buff := [1536]byte 
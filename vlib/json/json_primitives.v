@@ -158,7 +158,10 @@ fn jsencode_string(val string) &C.cJSON {
 // ///////////////////////
 // user := decode_User(json_parse(js_string_var))
 fn json_parse(s string) &C.cJSON {
-	return C.cJSON_Parse(s.str)
+	cs := s.cstr()
+	root := C.cJSON_Parse(cs)
+	s.free_cstr(cs)
+	return root
 }
 
 // json_string := json_print(encode_User(user))
@@ -177,14 +177,14 @@ fn test_complex_mod() {
 	mut c1 := cmplx.complex(5,7)
 	mut result := c1.mod()
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert result.str().eq('8.602325')
+	assert '${result:.6f}'.eq('8.602325')
 	c1 = cmplx.complex(-3,4)
 	result = c1.mod()
 	assert result == 5
 	c1 = cmplx.complex(-1,-2)
 	result = c1.mod()
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert result.str().eq('2.236068')
+	assert '${result:.6f}'.eq('2.236068')
 }
 
 fn test_complex_pow() {
@@ -269,17 +269,17 @@ fn test_complex_arg() {
 	mut c2 := cmplx.complex(2.152033,0.950547)
 	mut result := c1.arg()
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert result.str().eq('0.950547')
+	assert '${result:.6f}'.eq('0.950547')
 	c1 = cmplx.complex(-3,4)
 	c2 = cmplx.complex(1.609438,2.214297)
 	result = c1.arg()
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert result.str().eq('2.214297')
+	assert '${result:.6f}'.eq('2.214297')
 	c1 = cmplx.complex(-1,-2)
 	c2 = cmplx.complex(0.804719,-2.034444)
 	result = c1.arg()
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert result.str().eq('-2.034444')
+	assert '${result:.6f}'.eq('-2.034444')
 }
 
 fn test_complex_log() {
@@ -16,15 +16,15 @@ fn test_mean() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('5.762500')
+	assert '${o:.6f}'.eq('5.762500')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('17.650000')
+	assert '${o:.6f}'.eq('17.650000')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('37.708000')
+	assert '${o:.6f}'.eq('37.708000')
 }
 
 fn test_geometric_mean() {
@@ -32,7 +32,7 @@ fn test_geometric_mean() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.geometric_mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('5.159932')
+	assert '${o:.6f}'.eq('5.159932')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.geometric_mean(data)
 	println(o)
@@ -41,7 +41,7 @@ fn test_geometric_mean() {
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.geometric_mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('25.064496')
+	assert '${o:.6f}'.eq('25.064496')
 }
 
 fn test_harmonic_mean() {
@@ -49,15 +49,15 @@ fn test_harmonic_mean() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.harmonic_mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('4.626519')
+	assert '${o:.6f}'.eq('4.626519')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.harmonic_mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('9.134577')
+	assert '${o:.6f}'.eq('9.134577')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.harmonic_mean(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('16.555477')
+	assert '${o:.6f}'.eq('16.555477')
 }
 
 fn test_median() {
@@ -68,15 +68,15 @@ fn test_median() {
 	mut data := [f64(2.7),f64(4.45),f64(5.9),f64(10.0)]
 	mut o := stats.median(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('5.175000')
+	assert '${o:.6f}'.eq('5.175000')
 	data = [f64(-3.0),f64(1.89),f64(4.4),f64(67.31)]
 	o = stats.median(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('3.145000')
+	assert '${o:.6f}'.eq('3.145000')
 	data = [f64(7.88),f64(12.0),f64(54.83),f64(76.122)]
 	o = stats.median(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('33.415000')
+	assert '${o:.6f}'.eq('33.415000')
 
 	// Odd
 	data = [f64(2.7),f64(4.45),f64(5.9),f64(10.0),f64(22)]
@@ -109,15 +109,15 @@ fn test_rms() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.rms(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('6.362046')
+	assert '${o:.6f}'.eq('6.362046')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.rms(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('33.773393')
+	assert '${o:.6f}'.eq('33.773393')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.rms(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('47.452561')
+	assert '${o:.6f}'.eq('47.452561')
 }
 
 fn test_population_variance() {
@@ -125,15 +125,15 @@ fn test_population_variance() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.population_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('7.269219')
+	assert '${o:.6f}'.eq('7.269219')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.population_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('829.119550')
+	assert '${o:.6f}'.eq('829.119550')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.population_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('829.852282')
+	assert '${o:.6f}'.eq('829.852282')
 }
 
 fn test_sample_variance() {
@@ -141,15 +141,15 @@ fn test_sample_variance() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.sample_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('9.692292')
+	assert '${o:.6f}'.eq('9.692292')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.sample_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('1105.492733')
+	assert '${o:.6f}'.eq('1105.492733')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.sample_variance(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('1106.469709')
+	assert '${o:.6f}'.eq('1106.469709')
 }
 
 fn test_population_stddev() {
@@ -157,15 +157,15 @@ fn test_population_stddev() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.population_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('2.696149')
+	assert '${o:.6f}'.eq('2.696149')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.population_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('28.794436')
+	assert '${o:.6f}'.eq('28.794436')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.population_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('28.807157')
+	assert '${o:.6f}'.eq('28.807157')
 }
 
 fn test_sample_stddev() {
@@ -173,15 +173,15 @@ fn test_sample_stddev() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.sample_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('3.113245')
+	assert '${o:.6f}'.eq('3.113245')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.sample_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('33.248951')
+	assert '${o:.6f}'.eq('33.248951')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.sample_stddev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('33.263639')
+	assert '${o:.6f}'.eq('33.263639')
 }
 
 fn test_mean_absdev() {
@@ -189,15 +189,15 @@ fn test_mean_absdev() {
 	mut data := [f64(10.0),f64(4.45),f64(5.9),f64(2.7)]
 	mut o := stats.mean_absdev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('2.187500')
+	assert '${o:.6f}'.eq('2.187500')
 	data = [f64(-3.0),f64(67.31),f64(4.4),f64(1.89)]
 	o = stats.mean_absdev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('24.830000')
+	assert '${o:.6f}'.eq('24.830000')
 	data = [f64(12.0),f64(7.88),f64(76.122),f64(54.83)]
 	o = stats.mean_absdev(data)
 	// Some issue with precision comparison in f64 using == operator hence serializing to string
-	assert o.str().eq('27.768000')
+	assert '${o:.6f}'.eq('27.768000')
 }
 
 fn test_min() {
@@ -162,7 +162,9 @@ pub fn (s Socket) connect(address string, port int) ?int {
 
 	info := &C.addrinfo{!}
 	sport := '$port'
-	info_res := C.getaddrinfo(address.str, sport.str, &hints, &info)
+	caddress := address.cstr()
+	info_res := C.getaddrinfo(caddress, sport.cstr(), &hints, &info)
+	address.free_cstr(caddress)
 	if info_res != 0 {
 		error_message := os.get_error_msg(net.error_code())
 		return error('socket: getaddrinfo failed ($error_message)')
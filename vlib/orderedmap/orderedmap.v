@@ -0,0 +1,602 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module orderedmap
+
+/*
+OrderedMap is a string keyed map that keeps its keys sorted.
+
+It's a B-tree with wide nodes: up to 31 keys per node, stored inline in
+the node together with the values, so a lookup touches a few nodes instead
+of a node per key. Like the builtin `map`, values are stored by value,
+`elm_size` bytes each, and passed by pointer:
+
+	mut m := orderedmap.new(sizeof(int))
+	x := 7
+	m.set('seven', &x)
+	y := 0
+	if m.get('seven', &y) { ... }
+	mut it := m.range('a', 'n') // keys >= 'a' and < 'n', in order
+	for it.next() {
+		val := &int(it.val)
+		println('$it.key => ${*val}')
+	}
+
+`from_sorted()` builds a map from sorted keys in O(n).
+*/
+
+const (
+	degree   = 16 // minimum number of children of a non-root node
+	max_keys = 2 * degree - 1
+	min_keys = degree - 1
+)
+
+struct Node {
+mut:
+	len      int
+	is_leaf  bool
+	keys     [31]string
+	children [32]&Node
+	vals     byteptr // max_keys * elm_size bytes
+}
+
+struct OrderedMap {
+	elm_size int
+mut:
+	root     &Node
+pub:
+	size     int
+}
+
+// Iterates over the keys of a map in order, see `iter()` and `range()`.
+// The iterator is invalidated by `set()` and `delete()`.
+struct Iterator {
+	elm_size int
+mut:
+	nodes    [16]&Node // the path to the next key, enough for 16^16 keys
+	idxs     [16]int
+	depth    int
+	to       string
+	has_to   bool
+pub:
+	key      string
+	val      voidptr // points to the value in the map
+}
+
+pub fn new(elm_size int) OrderedMap {
+	return OrderedMap {
+		elm_size: elm_size
+		root: 0
+	}
+}
+
+// Builds a map from sorted and unique `keys`, `vals` points to `keys.len`
+// values, e.g. `orderedmap.from_sorted(keys, vals.data, sizeof(int))`.
+// The nodes are filled completely, so this is best for maps that are mostly read.
+pub fn from_sorted(keys []string, vals voidptr, elm_size int) OrderedMap {
+	for i := 1; i < keys.len; i++ {
+		if compare(keys[i - 1], keys[i]) >= 0 {
+			panic('orderedmap.from_sorted(): keys are not sorted or not unique: ' +
+				'"${keys[i - 1]}", "${keys[i]}"')
+		}
+	}
+	mut m := new(elm_size)
+	if keys.len == 0 {
+		return m
+	}
+	// The lowest tree that can hold all keys
+	mut height := 1
+	mut cap := max_keys
+	for cap < keys.len {
+		cap = (cap + 1) * (max_keys + 1) - 1
+		height++
+	}
+	m.root = m.build(keys, vals, 0, keys.len, height, cap)
+	m.size = keys.len
+	return m
+}
+
+// Builds a subtree of `height` from keys[start..end], `cap` is the
+// number of keys a full subtree of that height holds.
+fn (m &OrderedMap) build(keys []string, vals voidptr, start, end, height, cap int) &Node {
+	mut n := m.new_node(height == 1)
+	if height == 1 {
+		for i := start; i < end; i++ {
+			n.keys[i - start] = keys[i]
+		}
+		C.memcpy(n.vals, vals + start * m.elm_size, (end - start) * m.elm_size)
+		n.len = end - start
+		return n
+	}
+	// As few children as possible, with the keys split evenly between them,
+	// so every child is at least half full
+	child_cap := (cap + 1) / (max_keys + 1) - 1
+	count := end - start
+	nr_children := (count + child_cap + 1) / (child_cap + 1)
+	per_child := (count - nr_children + 1) / nr_children
+	extra := (count - nr_children + 1) % nr_children
+	mut pos := start
+	for i := 0; i < nr_children; i++ {
+		mut child_len := per_child
+		if i < extra {
+			child_len++
+		}
+		n.children[i] = m.build(keys, vals, pos, pos + child_len, height - 1, child_cap)
+		pos += child_len
+		if i < nr_children - 1 {
+			n.keys[i] = keys[pos]
+			C.memcpy(n.vals + i * m.elm_size, vals + pos * m.elm_size, m.elm_size)
+			pos++
+		}
+	}
+	n.len = nr_children - 1
+	return n
+}
+
+fn (m &OrderedMap) new_node(is_leaf bool) &Node {
+	return &Node {
+		is_leaf: is_leaf
+		vals: malloc(max_keys * m.elm_size)
+	}
+}
+
+// Three-way comparison, one pass over the shorter string
+fn compare(a, b string) int {
+	n := if a.len < b.len { a.len } else { b.len }
+	res := C.memcmp(a.str, b.str, n)
+	if res != 0 {
+		return res
+	}
+	return a.len - b.len
+}
+
+// Returns the index of the first key >= `key`, and whether it's `key`
+fn (n &Node) find(key string) (int, bool) {
+	mut lo := 0
+	mut hi := n.len
+	for lo < hi {
+		mid := (lo + hi) / 2
+		c := compare(n.keys[mid], key)
+		if c == 0 {
+			return mid, true
+		}
+		if c < 0 {
+			lo = mid + 1
+		}
+		else {
+			hi = mid
+		}
+	}
+	return lo, false
+}
+
+fn (m &OrderedMap) val(n &Node, i int) voidptr {
+	return n.vals + i * m.elm_size
+}
+
+// Moves keys, values and children of `n` starting at `i` by `by` positions
+fn (m &OrderedMap) shift(n mut Node, i, by int) {
+	if by > 0 {
+		for j := n.len - 1; j >= i; j-- {
+			n.keys[j + by] = n.keys[j]
+		}
+		if !n.is_leaf {
+			for j := n.len; j >= i; j-- {
+				n.children[j + by] = n.children[j]
+			}
+		}
+	}
+	else {
+		for j := i; j < n.len; j++ {
+			n.keys[j + by] = n.keys[j]
+		}
+		if !n.is_leaf {
+			for j := i; j <= n.len; j++ {
+				n.children[j + by] = n.children[j]
+			}
+		}
+	}
+	if i < n.len {
+		C.memmove(n.vals + (i + by) * m.elm_size, n.vals + i * m.elm_size,
+			(n.len - i) * m.elm_size)
+	}
+}
+
+pub fn (m mut OrderedMap) set(key string, val voidptr) {
+	if isnil(m.root) {
+		m.root = m.new_node(true)
+	}
+	if m.root.len == max_keys {
+		mut root := m.new_node(false)
+		root.children[0] = m.root
+		m.split_child(mut root, 0)
+		m.root = root
+	}
+	mut n := m.root
+	for {
+		mut i, found := n.find(key)
+		if found {
+			C.memcpy(m.val(n, i), val, m.elm_size)
+			return
+		}
+		if n.is_leaf {
+			m.shift(mut n, i, 1)
+			n.keys[i] = key
+			C.memcpy(m.val(n, i), val, m.elm_size)
+			n.len++
+			m.size++
+			return
+		}
+		// Split full nodes on the way down, so that there's always room for
+		// the key moved up by a split
+		if n.children[i].len == max_keys {
+			m.split_child(mut n, i)
+			c := compare(key, n.keys[i])
+			if c == 0 {
+				C.memcpy(m.val(n, i), val, m.elm_size)
+				return
+			}
+			if c > 0 {
+				i++
+			}
+		}
+		n = n.children[i]
+	}
+}
+
+// Splits the full child `i` of `n` in two, and moves its middle key to `n`
+fn (m &OrderedMap) split_child(n mut Node, i int) {
+	mut left := n.children[i]
+	mut right := m.new_node(left.is_leaf)
+	for j := 0; j < min_keys; j++ {
+		right.keys[j] = left.keys[j + degree]
+	}
+	C.memcpy(right.vals, m.val(left, degree), min_keys * m.elm_size)
+	if !left.is_leaf {
+		for j := 0; j < degree; j++ {
+			right.children[j] = left.children[j + degree]
+		}
+	}
+	right.len = min_keys
+	left.len = min_keys
+	m.shift(mut n, i, 1)
+	n.keys[i] = left.keys[min_keys]
+	C.memcpy(m.val(n, i), m.val(left, min_keys), m.elm_size)
+	n.children[i + 1] = right
+	n.len++
+}
+
+pub fn (m &OrderedMap) get(key string, out voidptr) bool {
+	mut n := m.root
+	for !isnil(n) {
+		i, found := n.find(key)
+		if found {
+			C.memcpy(out, m.val(n, i), m.elm_size)
+			return true
+		}
+		if n.is_leaf {
+			return false
+		}
+		n = n.children[i]
+	}
+	return false
+}
+
+pub fn (m &OrderedMap) exists(key string) bool {
+	mut n := m.root
+	for !isnil(n) {
+		i, found := n.find(key)
+		if found {
+			return true
+		}
+		if n.is_leaf {
+			return false
+		}
+		n = n.children[i]
+	}
+	return false
+}
+
+pub fn (m mut OrderedMap) delete(key string) {
+	if isnil(m.root) {
+		return
+	}
+	mut n := m.root
+	mut k := key
+	for {
+		mut i, found := n.find(k)
+		if found && n.is_leaf {
+			m.shift(mut n, i + 1, -1)
+			n.len--
+			m.size--
+			break
+		}
+		if found {
+			// Replace the key with its predecessor or successor from a child
+			// that can lose a key, and delete that one instead
+			if n.children[i].len > min_keys {
+				mut p := n.children[i]
+				for !p.is_leaf {
+					p = p.children[p.len]
+				}
+				n.keys[i] = p.keys[p.len - 1]
+				C.memcpy(m.val(n, i), m.val(p, p.len - 1), m.elm_size)
+				k = n.keys[i]
+				n = n.children[i]
+				continue
+			}
+			if n.children[i + 1].len > min_keys {
+				mut s := n.children[i + 1]
+				for !s.is_leaf {
+					s = s.children[0]
+				}
+				n.keys[i] = s.keys[0]
+				C.memcpy(m.val(n, i), m.val(s, 0), m.elm_size)
+				k = n.keys[i]
+				n = n.children[i + 1]
+				continue
+			}
+			// Both children are minimal: merge them around the key
+			m.merge(mut n, i)
+			n = n.children[i]
+			continue
+		}
+		if n.is_leaf {
+			break
+		}
+		// Make sure the child can lose a key before going down
+		if n.children[i].len == min_keys {
+			i = m.fill(mut n, i)
+		}
+		n = n.children[i]
+	}
+	if m.root.len == 0 {
+		old := m.root
+		if old.is_leaf {
+			m.root = 0
+		}
+		else {
+			m.root = old.children[0]
+		}
+		free(old.vals)
+		free(old)
+	}
+}
+
+// Gives child `i` of `n` another key, returns the new index of the child
+fn (m &OrderedMap) fill(n mut Node, i int) int {
+	mut child := n.children[i]
+	// Borrow from the left sibling
+	if i > 0 && n.children[i - 1].len > min_keys {
+		mut left := n.children[i - 1]
+		m.shift(mut child, 0, 1)
+		child.keys[0] = n.keys[i - 1]
+		C.memcpy(m.val(child, 0), m.val(n, i - 1), m.elm_size)
+		if !child.is_leaf {
+			child.children[0] = left.children[left.len]
+		}
+		child.len++
+		n.keys[i - 1] = left.keys[left.len - 1]
+		C.memcpy(m.val(n, i - 1), m.val(left, left.len - 1), m.elm_size)
+		left.len--
+		return i
+	}
+	// Borrow from the right sibling
+	if i < n.len && n.children[i + 1].len > min_keys {
+		mut right := n.children[i + 1]
+		child.keys[child.len] = n.keys[i]
+		C.memcpy(m.val(child, child.len), m.val(n, i), m.elm_size)
+		if !child.is_leaf {
+			child.children[child.len + 1] = right.children[0]
+		}
+		child.len++
+		n.keys[i] = right.keys[0]
+		C.memcpy(m.val(n, i), m.val(right, 0), m.elm_size)
+		m.shift(mut right, 1, -1)
+		right.len--
+		return i
+	}
+	if i < n.len {
+		m.merge(mut n, i)
+		return i
+	}
+	m.merge(mut n, i - 1)
+	return i - 1
+}
+
+// Merges children `i` and `i + 1` of `n` and key `i` into child `i`
+fn (m &OrderedMap) merge(n mut Node, i int) {
+	mut left := n.children[i]
+	right := n.children[i + 1]
+	left.keys[left.len] = n.keys[i]
+	C.memcpy(m.val(left, left.len), m.val(n, i), m.elm_size)
+	for j := 0; j < right.len; j++ {
+		left.keys[left.len + 1 + j] = right.keys[j]
+	}
+	C.memcpy(m.val(left, left.len + 1), right.vals, right.len * m.elm_size)
+	if !left.is_leaf {
+		for j := 0; j <= right.len; j++ {
+			left.children[left.len + 1 + j] = right.children[j]
+		}
+	}
+	left.len += right.len + 1
+	// Remove key `i` and child `i + 1`
+	for j := i + 1; j < n.len; j++ {
+		n.keys[j - 1] = n.keys[j]
+		n.children[j] = n.children[j + 1]
+	}
+	if i + 1 < n.len {
+		C.memmove(m.val(n, i), m.val(n, i + 1), (n.len - i - 1) * m.elm_size)
+	}
+	n.len--
+	free(right.vals)
+	free(right)
+}
+
+// The smallest key
+pub fn (m &OrderedMap) first() ?string {
+	if m.size == 0 {
+		return error('empty map')
+	}
+	mut n := m.root
+	for !n.is_leaf {
+		n = n.children[0]
+	}
+	return n.keys[0]
+}
+
+// The largest key
+pub fn (m &OrderedMap) last() ?string {
+	if m.size == 0 {
+		return error('empty map')
+	}
+	mut n := m.root
+	for !n.is_leaf {
+		n = n.children[n.len]
+	}
+	return n.keys[n.len - 1]
+}
+
+// The largest key <= `key`
+pub fn (m &OrderedMap) floor(key string) ?string {
+	mut n := m.root
+	mut res := ''
+	mut ok := false
+	for !isnil(n) {
+		i, found := n.find(key)
+		if found {
+			return n.keys[i]
+		}
+		if i > 0 {
+			res = n.keys[i - 1]
+			ok = true
+		}
+		if n.is_leaf {
+			break
+		}
+		n = n.children[i]
+	}
+	if !ok {
+		return error('no key <= "$key"')
+	}
+	return res
+}
+
+// The smallest key >= `key`
+pub fn (m &OrderedMap) ceil(key string) ?string {
+	mut n := m.root
+	mut res := ''
+	mut ok := false
+	for !isnil(n) {
+		i, found := n.find(key)
+		if found {
+			return n.keys[i]
+		}
+		if i < n.len {
+			res = n.keys[i]
+			ok = true
+		}
+		if n.is_leaf {
+			break
+		}
+		n = n.children[i]
+	}
+	if !ok {
+		return error('no key >= "$key"')
+	}
+	return res
+}
+
+// All keys, sorted
+pub fn (m &OrderedMap) keys() []string {
+	mut res := []string
+	mut it := m.iter()
+	for it.next() {
+		res << it.key
+	}
+	return res
+}
+
+// Iterates over all keys in order
+pub fn (m &OrderedMap) iter() Iterator {
+	mut it := Iterator{ elm_size: m.elm_size }
+	if !isnil(m.root) {
+		it.push_leftmost(m.root)
+	}
+	return it
+}
+
+// Iterates over the keys >= `from` and < `to` in order
+pub fn (m &OrderedMap) range(from, to string) Iterator {
+	mut it := Iterator{ elm_size: m.elm_size, to: to, has_to: true }
+	mut n := m.root
+	for !isnil(n) {
+		i, _ := n.find(from)
+		it.nodes[it.depth] = n
+		it.idxs[it.depth] = i
+		it.depth++
+		if n.is_leaf {
+			break
+		}
+		n = n.children[i]
+	}
+	return it
+}
+
+fn (it mut Iterator) push_leftmost(node &Node) {
+	mut n := node
+	for {
+		it.nodes[it.depth] = n
+		it.idxs[it.depth] = 0
+		it.depth++
+		if n.is_leaf {
+			break
+		}
+		n = n.children[0]
+	}
+}
+
+// Moves to the next key, returns false at the end. `it.key` and `it.val`
+// are the current key and a pointer to its value.
+pub fn (it mut Iterator) next() bool {
+	for it.depth > 0 {
+		d := it.depth - 1
+		n := it.nodes[d]
+		i := it.idxs[d]
+		if i == n.len {
+			it.depth--
+			continue
+		}
+		if it.has_to && compare(n.keys[i], it.to) >= 0 {
+			it.depth = 0
+			return false
+		}
+		it.key = n.keys[i]
+		it.val = n.vals + i * it.elm_size
+		it.idxs[d] = i + 1
+		if !n.is_leaf {
+			it.push_leftmost(n.children[i + 1])
+		}
+		return true
+	}
+	return false
+}
+
+fn (m &OrderedMap) free_node(n &Node) {
+	if !n.is_leaf {
+		for i := 0; i <= n.len; i++ {
+			m.free_node(n.children[i])
+		}
+	}
+	free(n.vals)
+	free(n)
+}
+
+pub fn (m mut OrderedMap) free() {
+	if !isnil(m.root) {
+		m.free_node(m.root)
+	}
+	m.root = 0
+	m.size = 0
+}
@@ -0,0 +1,178 @@
+import orderedmap
+import rand
+
+fn test_set_get() {
+	mut m := orderedmap.new(sizeof(int))
+	for i, key in ['b', 'a', 'c'] {
+		m.set(key, &i)
+	}
+	assert m.size == 3
+	x := 0
+	assert m.get('c', &x)
+	assert x == 2
+	assert !m.get('d', &x)
+	assert m.exists('a')
+	y := 10
+	m.set('a', &y)
+	assert m.size == 3
+	assert m.get('a', &x)
+	assert x == 10
+	assert m.keys().join(',') == 'a,b,c'
+}
+
+fn key(i int) string {
+	n := i + 100000
+	return 'key_' + n.str()
+}
+
+fn test_many_random_keys() {
+	n := 20000
+	mut m := orderedmap.new(sizeof(int))
+	// A permutation of 0..n
+	for i := 0; i < n; i++ {
+		k := i * 7919 % n
+		m.set(key(k), &k)
+	}
+	assert m.size == n
+	keys := m.keys()
+	assert keys.len == n
+	for i := 0; i < n; i++ {
+		assert keys[i] == key(i)
+	}
+	x := 0
+	for i := 0; i < n; i++ {
+		assert m.get(key(i), &x)
+		assert x == i
+	}
+	// Delete the odd keys in random order, then everything else
+	for i := 0; i < n; i++ {
+		k := i * 7919 % n
+		if k % 2 == 1 {
+			m.delete(key(k))
+		}
+	}
+	assert m.size == n / 2
+	mut it := m.iter()
+	mut expected := 0
+	for it.next() {
+		assert it.key == key(expected)
+		val := &int(it.val)
+		assert *val == expected
+		expected += 2
+	}
+	assert expected == n
+	m.delete('missing')
+	assert m.size == n / 2
+	for i := 0; i < n; i += 2 {
+		m.delete(key(i))
+		assert !m.exists(key(i))
+	}
+	assert m.size == 0
+	assert m.keys().len == 0
+}
+
+fn test_random_ops() {
+	mut m := orderedmap.new(sizeof(int))
+	mut ref := map[string]int
+	for i := 0; i < 30000; i++ {
+		k := rand.next(3000)
+		if rand.next(3) == 0 {
+			m.delete(key(k))
+			ref.delete(key(k))
+		}
+		else {
+			m.set(key(k), &i)
+			ref[key(k)] = i
+		}
+	}
+	assert m.size == ref.size
+	mut ref_keys := ref.keys()
+	ref_keys.sort()
+	assert m.keys().join(',') == ref_keys.join(',')
+	x := 0
+	for k in ref_keys {
+		assert m.get(k, &x)
+		assert x == ref[k]
+	}
+}
+
+fn test_range_floor_ceil() {
+	mut m := orderedmap.new(sizeof(int))
+	for i := 0; i < 1000; i += 10 {
+		m.set(key(i), &i)
+	}
+	mut it := m.range(key(95), key(150))
+	mut got := []int
+	for it.next() {
+		val := &int(it.val)
+		got << *val
+	}
+	assert got.len == 5
+	assert got[0] == 100
+	assert got[4] == 140
+	it = m.range(key(2000), key(3000))
+	assert !it.next()
+	first := m.first() or { panic(err) }
+	assert first == key(0)
+	last := m.last() or { panic(err) }
+	assert last == key(990)
+	f := m.floor(key(105)) or { panic(err) }
+	assert f == key(100)
+	c := m.ceil(key(105)) or { panic(err) }
+	assert c == key(110)
+	e := m.ceil(key(110)) or { panic(err) }
+	assert e == key(110)
+	assert floor_or_empty(m, 'a') == ''
+	assert ceil_or_empty(m, 'z') == ''
+	assert ceil_or_empty(m, 'a') == key(0)
+}
+
+fn floor_or_empty(m orderedmap.OrderedMap, key string) string {
+	res := m.floor(key) or {
+		return ''
+	}
+	return res
+}
+
+fn ceil_or_empty(m orderedmap.OrderedMap, key string) string {
+	res := m.ceil(key) or {
+		return ''
+	}
+	return res
+}
+
+fn test_from_sorted() {
+	for n in [0, 1, 31, 32, 33, 1000, 1023, 1024, 1025, 40000] {
+		mut keys := []string
+		mut vals := []int
+		for i := 0; i < n; i++ {
+			keys << key(i * 2)
+			vals << i
+		}
+		mut m := orderedmap.from_sorted(keys, vals.data, sizeof(int))
+		assert m.size == n
+		assert m.keys().len == n
+		x := 0
+		for i := 0; i < n; i++ {
+			assert m.get(key(i * 2), &x)
+			assert x == i
+		}
+		// Still a valid tree
+		for i := 0; i < n; i++ {
+			k := i * 2 + 1
+			m.set(key(k), &k)
+		}
+		for i := 0; i < n; i++ {
+			m.delete(key(i * 2))
+		}
+		assert m.size == n
+		mut it := m.iter()
+		mut i := 0
+		for it.next() {
+			assert it.key == key(i * 2 + 1)
+			i++
+		}
+		assert i == n
+		m.free()
+	}
+}
@@ -0,0 +1,79 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module os
+
+import strings
+
+// A `strings.Builder` that writes what it has to a file each time it passes
+// `threshold` bytes, so that a large output doesn't have to fit in memory:
+//
+//	mut b := os.new_file_builder(f, 64 * 1024)
+//	b.write('x = ')
+//	b.write_int(x)
+//	b.flush()
+struct FileBuilder {
+	file      File
+	threshold int
+mut:
+	sb        strings.Builder
+}
+
+pub fn new_file_builder(f File, threshold int) FileBuilder {
+	return FileBuilder {
+		file: f
+		threshold: threshold
+		sb: strings.new_builder(threshold + threshold / 4)
+	}
+}
+
+pub fn (b mut FileBuilder) write(s string) {
+	b.sb.write(s)
+	b.flush_if_full()
+}
+
+pub fn (b mut FileBuilder) writeln(s string) {
+	b.sb.writeln(s)
+	b.flush_if_full()
+}
+
+pub fn (b mut FileBuilder) write_byte(c byte) {
+	b.sb.write_byte(c)
+	b.flush_if_full()
+}
+
+pub fn (b mut FileBuilder) write_int(n int) {
+	b.sb.write_int(n)
+	b.flush_if_full()
+}
+
+pub fn (b mut FileBuilder) write_u64(n u64) {
+	b.sb.write_u64(n)
+	b.flush_if_full()
+}
+
+pub fn (b mut FileBuilder) write_f64(d f64) {
+	b.sb.write_f64(d)
+	b.flush_if_full()
+}
+
+fn (b mut FileBuilder) flush_if_full() {
+	if b.sb.len >= b.threshold {
+		b.flush()
+	}
+}
+
+// Writes what is left to the file. The file isn't closed.
+pub fn (b mut FileBuilder) flush() {
+	if b.sb.len > 0 {
+		b.file.write(b.sb.str())
+		b.sb.reset()
+	}
+}
+
+// Flushes and frees the buffer
+pub fn (b mut FileBuilder) free() {
+	b.flush()
+	b.sb.free()
+}
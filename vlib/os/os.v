@@ -93,7 +93,9 @@ pub fn file_size(path string) int {
 	$if windows {
 		C._wstat(path.to_wide(), &s)
 	} $else {
-		C.stat(*char(path.str), &s)
+		cpath := path.cstr()
+		C.stat(*char(cpath), &s)
+		path.free_cstr(cpath)
 	}
 	return s.st_size
 }
@@ -102,7 +104,11 @@ pub fn mv(old, new string) {
 	$if windows {
 		C._wrename(old.to_wide(), new.to_wide())
 	} $else {
-		C.rename(*char(old.str), *char(new.str))
+		cold := old.cstr()
+		cnew := new.cstr()
+		C.rename(*char(cold), *char(cnew))
+		old.free_cstr(cold)
+		new.free_cstr(cnew)
 	}
 }
 
@@ -110,7 +116,12 @@ fn vfopen(path, mode string) *C.FILE {
 	$if windows {
 		return C._wfopen(path.to_wide(), mode.to_wide())
 	} $else {
-		return C.fopen(*char(path.str), *char(mode.str))
+		cpath := path.cstr()
+		cmode := mode.cstr()
+		f := C.fopen(*char(cpath), *char(cmode))
+		path.free_cstr(cpath)
+		mode.free_cstr(cmode)
+		return f
 	}
 }	
 
@@ -134,7 +145,7 @@ pub fn read_lines(path string) []string {
 		len := vstrlen(buf)
 		if len == buf_len - 1 && buf[len - 1] != 10 {
 			buf_len *= 2
-			buf = C.realloc(buf, buf_len)
+			buf = v_realloc(buf, buf_len)
 			if isnil(buf) {
 				panic('Could not reallocate the read buffer')
 			}
@@ -174,10 +185,11 @@ pub fn open(path string) ?File {
 			cfile: C._wfopen(wpath, mode.to_wide())
 		}
 	} $else {
-		cpath := path.str
+		cpath := path.cstr()
 		file = File {
 			cfile: C.fopen(*char(cpath), 'rb')
 		}
+		path.free_cstr(cpath)
 	}
 	if isnil(file.cfile) {
 		return error('failed to open file "$path"')
@@ -195,10 +207,11 @@ pub fn create(path string) ?File {
 			cfile: C._wfopen(wpath, mode.to_wide())
 		}
 	} $else {
-		cpath := path.str
+		cpath := path.cstr()
 		file = File {
 			cfile: C.fopen(*char(cpath), 'wb')
 		}
+		path.free_cstr(cpath)
 	}
 	if isnil(file.cfile) {
 		return error('failed to create file "$path"')
@@ -215,10 +228,11 @@ pub fn open_append(path string) ?File {
 			cfile: C._wfopen(wpath, mode.to_wide())
 		}
 	} $else {
-		cpath := path.str
+		cpath := path.cstr()
 		file = File {
 			cfile: C.fopen(*char(cpath), 'ab')
 		}
+		path.free_cstr(cpath)
 	}
 	if isnil(file.cfile) {
 		return error('failed to create(append) file "$path"')
@@ -227,8 +241,7 @@ pub fn open_append(path string) ?File {
 }
 
 pub fn (f File) write(s string) {
-	C.fputs(s.str, f.cfile)
-	// C.fwrite(s.str, 1, s.len, f.cfile)
+	C.fwrite(s.str, 1, s.len, f.cfile)
 }
 
 // convert any value to []byte (LittleEndian) and write it
@@ -245,11 +258,7 @@ pub fn (f File) write_bytes_at(data voidptr, size, pos int) {
 }
 
 pub fn (f File) writeln(s string) {
-	// C.fwrite(s.str, 1, s.len, f.cfile)
-	// ss := s.clone()
-	// TODO perf
-	C.fputs(s.str, f.cfile)
-	// ss.free()
+	C.fwrite(s.str, 1, s.len, f.cfile)
 	C.fputs('\n', f.cfile)
 }
 
@@ -269,8 +278,10 @@ fn popen(path string) *C.FILE {
 		return C._wpopen(wpath, mode.to_wide())
 	}
 	$else {
-		cpath := path.str
-		return C.popen(cpath, 'r')
+		cpath := path.cstr()
+		f := C.popen(cpath, 'r')
+		path.free_cstr(cpath)
+		return f
 	}
 }
 
@@ -336,10 +347,14 @@ pub fn exec(cmd string) ?Result {
 // `system` works like `exec()`, but only returns a return code.
 pub fn system(cmd string) int {
 	mut ret := int(0)
+	// The command writes to the same stdout
+	print_flush()
 	$if windows {
 		ret = C._wsystem(cmd.to_wide())
 	} $else {
-		ret = C.system(cmd.str)
+		ccmd := cmd.cstr()
+		ret = C.system(ccmd)
+		cmd.free_cstr(ccmd)
 	}
 	if ret == -1 {
 		print_c_errno()
@@ -399,7 +414,9 @@ pub fn getenv(key string) string {
 		}
 		return string_from_wide(s)
 	} $else {
-		s := *byte(C.getenv(key.str))
+		ckey := key.cstr()
+		s := *byte(C.getenv(ckey))
+		key.free_cstr(ckey)
 		if isnil(s) {
 			return ''
 		}
@@ -412,13 +429,18 @@ pub fn setenv(name string, value string, overwrite bool) int {
 		format := '$name=$value'
 
 		if overwrite {
-			return C._putenv(format.str)
+			return C._putenv(format.cstr())
 		}
 
 		return -1
 	}
 	$else {
-		return C.setenv(name.str, value.str, overwrite)
+		cname := name.cstr()
+		cvalue := value.cstr()
+		res := C.setenv(cname, cvalue, overwrite)
+		name.free_cstr(cname)
+		value.free_cstr(cvalue)
+		return res
 	}
 }
 
@@ -426,10 +448,13 @@ pub fn unsetenv(name string) int {
 	$if windows {
 		format := '${name}='
 		
-		return C._putenv(format.str)
+		return C._putenv(format.cstr())
 	}
 	$else {
-		return C.unsetenv(name.str)
+		cname := name.cstr()
+		res := C.unsetenv(cname)
+		name.free_cstr(cname)
+		return res
 	}
 }
 
@@ -439,7 +464,10 @@ pub fn file_exists(_path string) bool {
 		path := _path.replace('/', '\\')
 		return C._waccess(path.to_wide(), 0) != -1
 	} $else {
-		return C.access(_path.str, 0 ) != -1
+		cpath := _path.cstr()
+		res := C.access(cpath, 0 ) != -1
+		_path.free_cstr(cpath)
+		return res
 	}
 }
 
@@ -449,7 +477,9 @@ pub fn rm(path string) {
 		C._wremove(path.to_wide())
 	}
 	$else {
-		C.remove(path.str)
+		cpath := path.cstr()
+		C.remove(cpath)
+		path.free_cstr(cpath)
 	}
 	// C.unlink(path.cstr())
 }
@@ -458,7 +488,9 @@ pub fn rm(path string) {
 // rmdir removes a specified directory.
 pub fn rmdir(path string) {
 	$if !windows {
-		C.rmdir(path.str)		
+		cpath := path.cstr()
+		C.rmdir(cpath)
+		path.free_cstr(cpath)
 	}
 	$else {
 		C.RemoveDirectory(path.to_wide())
@@ -637,8 +669,8 @@ pub fn write_file(path, text string) {
 }
 
 pub fn clear() {
-	C.printf('\x1b[2J')
-	C.printf('\x1b[H')
+	print('\x1b[2J')
+	print('\x1b[H')
 }
 
 fn on_segfault(f voidptr) {
@@ -725,8 +757,10 @@ pub fn is_dir(path string) bool {
 	}
 	$else {
 		statbuf := C.stat{}
-		cstr := path.str
-		if C.stat(cstr, &statbuf) != 0 {
+		cpath := path.cstr()
+		res := C.stat(cpath, &statbuf)
+		path.free_cstr(cpath)
+		if res != 0 {
 			return false
 		}
 		// ref: https://code.woboq.org/gcc/include/sys/stat.h.html
@@ -739,7 +773,9 @@ pub fn chdir(path string) {
 		C._wchdir(path.to_wide())
 	}
 	$else {
-		C.chdir(path.str)
+		cpath := path.cstr()
+		C.chdir(cpath)
+		path.free_cstr(cpath)
 	}
 }
 
@@ -769,12 +805,14 @@ pub fn getwd() string {
 pub fn realpath(fpath string) string {
 	mut fullpath := malloc( MAX_PATH )
 	mut res := 0
+	cpath := fpath.cstr()
 	$if windows {
-		res = int( C._fullpath( fullpath, fpath.str, MAX_PATH ) )
+		res = int( C._fullpath( fullpath, cpath, MAX_PATH ) )
 	}
 	$else{
-		res = int( C.realpath( fpath.str, fullpath ) )
+		res = int( C.realpath( cpath, fullpath ) )
 	}
+	fpath.free_cstr(cpath)
 	if res != 0 {
 		return string(fullpath, vstrlen(fullpath))
 	}
@@ -812,6 +850,8 @@ fn C.fork() int
 fn C.wait() int
 
 pub fn fork() int {
+	// Or the child prints it again
+	print_flush()
 	$if !windows {
 		pid := C.fork()
 		return pid
@@ -830,7 +870,9 @@ pub fn wait() int {
 pub fn file_last_mod_unix(path string) int {
 	attr := C.stat{}
 	//# struct stat attr;
-	C.stat(path.str, &attr)
+	cpath := path.cstr()
+	C.stat(cpath, &attr)
+	path.free_cstr(cpath)
 	//# stat(path.str, &attr);
 	return attr.st_mtime
 	//# return attr.st_mtime ;
@@ -842,7 +884,7 @@ pub fn log(s string) {
 }
 
 pub fn flush_stdout() {
-	C.fflush(stdout)
+	print_flush()
 }
 
 pub fn print_backtrace() {
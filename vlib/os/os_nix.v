@@ -27,7 +27,9 @@ pub fn get_error_msg(code int) string {
 
 pub fn ls(path string) []string {
 	mut res := []string
-	dir := C.opendir(path.str)
+	cpath := path.cstr()
+	dir := C.opendir(cpath)
+	path.free_cstr(cpath)
 	if isnil(dir) {
 		println('ls() couldnt open dir "$path"')
 		print_c_errno()
@@ -49,7 +51,9 @@ pub fn ls(path string) []string {
 }
 
 pub fn dir_exists(path string) bool {
-	dir := C.opendir(path.str)
+	cpath := path.cstr()
+	dir := C.opendir(cpath)
+	path.free_cstr(cpath)
 	res := !isnil(dir)
 	if res {
 		C.closedir(dir)
@@ -59,7 +63,9 @@ pub fn dir_exists(path string) bool {
 
 // mkdir creates a new directory with the specified path.
 pub fn mkdir(path string) {
-	C.mkdir(path.str, 511)// S_IRWXU | S_IRWXG | S_IRWXO
+	cpath := path.cstr()
+	C.mkdir(cpath, 511)// S_IRWXU | S_IRWXG | S_IRWXO
+	path.free_cstr(cpath)
 }
 
 
@@ -33,6 +33,28 @@ fn test_write_and_read_string_to_file() {
   os.rm(filename)
 }
 
+fn test_file_builder() {
+  filename := './test_file_builder.txt'
+  f := os.create(filename) or {
+    panic('error creating file $filename')
+  }
+  mut b := os.new_file_builder(f, 16)
+  mut expected := ''
+  for i := 0; i < 100; i++ {
+    b.write('line ')
+    b.write_int(i)
+    b.write_byte(`\n`)
+    expected += 'line $i\n'
+  }
+  b.free()
+  f.close()
+  read := os.read_file(filename) or {
+    panic('error reading file $filename')
+  }
+  assert read == expected
+  os.rm(filename)
+}
+
 fn test_create_and_delete_folder() {
   folder := './test1'
   os.mkdir(folder)
@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module parallel
+
+#include <pthread.h>
+
+// `C.pthread_mutex_t` and `C.pthread_cond_t` are declared in builtin
+
+struct Mutex {
+	m C.pthread_mutex_t
+}
+
+struct Cond {
+	c C.pthread_cond_t
+}
+
+fn (m &Mutex) init() {
+	C.pthread_mutex_init(&m.m, 0)
+}
+
+fn (m &Mutex) lock() {
+	C.pthread_mutex_lock(&m.m)
+}
+
+fn (m &Mutex) unlock() {
+	C.pthread_mutex_unlock(&m.m)
+}
+
+fn (c &Cond) init() {
+	C.pthread_cond_init(&c.c, 0)
+}
+
+// `m` must be locked, it's unlocked while waiting
+fn (c &Cond) wait(m &Mutex) {
+	C.pthread_cond_wait(&c.c, &m.m)
+}
+
+fn (c &Cond) broadcast() {
+	C.pthread_cond_broadcast(&c.c)
+}
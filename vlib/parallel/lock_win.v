@@ -0,0 +1,40 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module parallel
+
+// `C.SRWLOCK` and `C.CONDITION_VARIABLE` are declared in builtin
+
+struct Mutex {
+	m C.SRWLOCK
+}
+
+struct Cond {
+	c C.CONDITION_VARIABLE
+}
+
+fn (m &Mutex) init() {
+	C.InitializeSRWLock(&m.m)
+}
+
+fn (m &Mutex) lock() {
+	C.AcquireSRWLockExclusive(&m.m)
+}
+
+fn (m &Mutex) unlock() {
+	C.ReleaseSRWLockExclusive(&m.m)
+}
+
+fn (c &Cond) init() {
+	C.InitializeConditionVariable(&c.c)
+}
+
+// `m` must be locked, it's unlocked while waiting
+fn (c &Cond) wait(m &Mutex) {
+	C.SleepConditionVariableSRW(&c.c, &m.m, C.INFINITE, 0)
+}
+
+fn (c &Cond) broadcast() {
+	C.WakeAllConditionVariable(&c.c)
+}
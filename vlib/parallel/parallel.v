@@ -0,0 +1,197 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module parallel
+
+/*
+Parallel versions of `map`, `filter`, `reduce`, `for` and `sort` for large
+arrays.
+
+They run on a pool of worker threads shared by the whole program, started
+the first time it's needed, with a thread per CPU (`runtime.nr_cpus()`) or
+as many as `set_threads()` was given. The calling thread works too.
+
+The indices are split into chunks, about 4 per thread so that threads that
+finish early can take more, but at least 1024 indices long. Arrays of up to
+4096 elements are done on the calling thread.
+
+Only one job runs on the pool at a time. If these functions are called
+while it's busy, e.g. from a `pfor_each()` body or from two threads at
+once, the later call runs on its own thread.
+
+The functions given to them must be safe to call from several threads at
+once.
+*/
+
+// Calls `body(ctx, start, end)` for chunks of `[0, n)` in parallel, and
+// returns when all of them are done. `body` is a
+// `fn (ctx &MyContext, start, end int)`, and `ctx` is passed as it is.
+pub fn pfor_each(n int, ctx voidptr, body voidptr) {
+	if n <= serial_cutoff {
+		b := Body{ f: body }
+		call_body(b.f, ctx, 0, n)
+		return
+	}
+	run(n, grain_for(n, nr_threads()), ctx, body)
+}
+
+struct MapCtx {
+	src &int
+	dst &int
+	f   fn (int) int
+}
+
+fn map_range(f fn (int) int, src, dst_ &int, start, end int) {
+	mut dst := dst_
+	for i := start; i < end; i++ {
+		dst[i] = f(src[i])
+	}
+}
+
+fn map_chunk(c &MapCtx, start, end int) {
+	map_range(c.f, c.src, c.dst, start, end)
+}
+
+// `[f(a[0]), f(a[1]), ...]`
+pub fn pmap(a []int, f fn (int) int) []int {
+	res := [0].repeat(a.len)
+	c := MapCtx {
+		src: &int(a.data)
+		dst: &int(res.data)
+		f: f
+	}
+	pfor_each(a.len, &c, map_chunk)
+	return res
+}
+
+struct FilterCtx {
+	src    &int
+	keep   byteptr
+	counts &int // of each chunk
+	// Where the kept elements of each chunk go in `dst`
+	offsets &int
+	grain  int
+	f      fn (int) bool
+mut:
+	dst    &int
+}
+
+fn filter_range(f fn (int) bool, src &int, keep_ byteptr, start, end int) int {
+	mut keep := keep_
+	mut n := 0
+	for i := start; i < end; i++ {
+		if f(src[i]) {
+			keep[i] = 1
+			n++
+		}
+		else {
+			keep[i] = 0
+		}
+	}
+	return n
+}
+
+fn filter_chunk(c &FilterCtx, start, end int) {
+	mut counts := c.counts
+	counts[start / c.grain] = filter_range(c.f, c.src, c.keep, start, end)
+}
+
+fn filter_copy_chunk(c &FilterCtx, start, end int) {
+	mut dst := c.dst
+	mut j := c.offsets[start / c.grain]
+	for i := start; i < end; i++ {
+		if c.keep[i] != 0 {
+			dst[j] = c.src[i]
+			j++
+		}
+	}
+}
+
+// The elements `x` of `a` for which `f(x)` is true, in the same order
+pub fn pfilter(a []int, f fn (int) bool) []int {
+	if a.len <= serial_cutoff {
+		mut res := []int
+		for x in a {
+			if f(x) {
+				res << x
+			}
+		}
+		return res
+	}
+	grain := grain_for(a.len, nr_threads())
+	nr_chunks := (a.len + grain - 1) / grain
+	keep := malloc(a.len)
+	counts := [0].repeat(nr_chunks)
+	mut offsets := [0].repeat(nr_chunks)
+	mut c := FilterCtx {
+		src: &int(a.data)
+		keep: keep
+		counts: &int(counts.data)
+		offsets: &int(offsets.data)
+		dst: 0
+		grain: grain
+		f: f
+	}
+	run(a.len, grain, &c, filter_chunk)
+	mut total := 0
+	for i := 0; i < nr_chunks; i++ {
+		offsets[i] = total
+		total += counts[i]
+	}
+	res := [0].repeat(total)
+	c.dst = &int(res.data)
+	run(a.len, grain, &c, filter_copy_chunk)
+	free(keep)
+	counts.free()
+	offsets.free()
+	return res
+}
+
+struct ReduceCtx {
+	src     &int
+	results &int // of each chunk
+	grain   int
+	f       fn (int, int) int
+}
+
+fn reduce_range(f fn (int, int) int, src &int, start, end int) int {
+	mut accum := src[start]
+	for i := start + 1; i < end; i++ {
+		accum = f(accum, src[i])
+	}
+	return accum
+}
+
+fn reduce_chunk(c &ReduceCtx, start, end int) {
+	mut results := c.results
+	results[start / c.grain] = reduce_range(c.f, c.src, start, end)
+}
+
+// `f(...f(f(accum_start, a[0]), a[1])..., a[a.len - 1])`, like
+// `a.reduce(f, accum_start)`. The chunks are reduced separately and their
+// results in order, so `f` must be associative: `f(f(x, y), z) == f(x, f(y, z))`.
+pub fn preduce(a []int, f fn (int, int) int, accum_start int) int {
+	mut accum := accum_start
+	if a.len <= serial_cutoff {
+		for x in a {
+			accum = f(accum, x)
+		}
+		return accum
+	}
+	grain := grain_for(a.len, nr_threads())
+	nr_chunks := (a.len + grain - 1) / grain
+	results := [0].repeat(nr_chunks)
+	c := ReduceCtx {
+		src: &int(a.data)
+		results: &int(results.data)
+		grain: grain
+		f: f
+	}
+	run(a.len, grain, &c, reduce_chunk)
+	for x in results {
+		accum = f(accum, x)
+	}
+	results.free()
+	return accum
+}
@@ -0,0 +1,134 @@
+import parallel
+
+fn next_rand(seed u32) u32 {
+	return seed * u32(1103515245) + u32(12345)
+}
+
+fn random_ints(n int) []int {
+	mut a := []int
+	mut seed := u32(1)
+	for i := 0; i < n; i++ {
+		seed = next_rand(seed)
+		a << int(seed >> u32(16)) % 1000
+	}
+	return a
+}
+
+fn double(x int) int {
+	return x * 2
+}
+
+fn is_even(x int) bool {
+	return x % 2 == 0
+}
+
+fn sum(a, b int) int {
+	return a + b
+}
+
+struct Counts {
+	hits []int
+}
+
+fn count_chunk(c &Counts, start, end int) {
+	mut hits := c.hits
+	for i := start; i < end; i++ {
+		hits[i]++
+	}
+}
+
+struct Pair {
+	key int
+	id  int
+}
+
+fn compare_pairs(a, b &Pair) int {
+	if a.key < b.key {
+		return -1
+	}
+	if a.key > b.key {
+		return 1
+	}
+	return 0
+}
+
+fn test_pmap_pfilter_preduce() {
+	for threads in [1, 2, 3, 4] {
+		parallel.set_threads(threads)
+		for n in [0, 1, 100, 4096, 5000, 100000] {
+			a := random_ints(n)
+			m := parallel.pmap(a, double)
+			assert m.len == n
+			mut even := []int
+			mut total := 0
+			for i, x in a {
+				assert m[i] == 2 * x
+				if is_even(x) {
+					even << x
+				}
+				total += x
+			}
+			f := parallel.pfilter(a, is_even)
+			assert f.len == even.len
+			for i, x in even {
+				assert f[i] == x
+			}
+			assert parallel.preduce(a, sum, 7) == total + 7
+		}
+	}
+}
+
+fn test_pfor_each() {
+	parallel.set_threads(4)
+	for n in [10, 100000] {
+		c := Counts{ hits: [0].repeat(n) }
+		parallel.pfor_each(n, &c, count_chunk)
+		for x in c.hits {
+			assert x == 1
+		}
+	}
+}
+
+fn test_psort() {
+	for threads in [1, 2, 3, 4, 7] {
+		parallel.set_threads(threads)
+		for n in [0, 1, 4096, 10000, 100001] {
+			mut a := random_ints(n)
+			mut b := a.clone()
+			parallel.psort(mut a)
+			b.sort()
+			assert a.len == b.len
+			for i, x in b {
+				assert a[i] == x
+			}
+		}
+	}
+}
+
+fn test_psort_with_compare() {
+	parallel.set_threads(2)
+	keys := random_ints(50000)
+	mut a := []Pair
+	for i, k in keys {
+		a << Pair{ key: k, id: i }
+	}
+	parallel.psort_with_compare(&a, compare_pairs)
+	assert a.len == keys.len
+	mut seen := [false].repeat(a.len)
+	for i, x in a {
+		if i > 0 {
+			assert a[i - 1].key <= x.key
+		}
+		assert !seen[x.id]
+		seen[x.id] = true
+	}
+	parallel.set_threads(4)
+	mut b := []Pair
+	for i, k in keys {
+		b << Pair{ key: k, id: i }
+	}
+	parallel.psort_with_compare(&b, compare_pairs)
+	for i := 1; i < b.len; i++ {
+		assert b[i - 1].key <= b[i].key
+	}
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module parallel
+
+import runtime
+
+// The worker threads, and the job they are running. There is one job at a
+// time: `[0, n)` split into chunks of `grain` indices, handed out in order.
+struct Pool {
+mut:
+	mutex      Mutex
+	work       Cond // there is a new job, or more threads may take part
+	done       Cond // the last chunk of the job is done
+	nr_threads int // including the thread that runs the job
+	nr_workers int // started so far
+	busy       bool
+	job_body   fn (voidptr, int, int)
+	job_ctx    voidptr
+	job_n      int
+	job_grain  int
+	next       int // the start of the next chunk
+	left       int // the indices that aren't done yet
+}
+
+// The body of a job is only known as a pointer, a field gives it a type
+struct Body {
+	f fn (voidptr, int, int)
+}
+
+const (
+	// Inputs smaller than this run on the calling thread
+	serial_cutoff = 4096
+	// Each chunk has at least that many indices, so handing it out (a lock
+	// and an unlock) is cheap next to the work
+	min_grain     = 1024
+	// Chunks per thread, so threads that finish early can take more
+	chunks_per_thread = 4
+)
+
+fn new_pool() &Pool {
+	p := &Pool{}
+	p.mutex.init()
+	p.work.init()
+	p.done.init()
+	return p
+}
+
+const (
+	pool = new_pool()
+)
+
+// The number of threads the functions of this module use, `runtime.nr_cpus()`
+// unless it was changed with `set_threads()`
+pub fn nr_threads() int {
+	mut p := pool
+	p.mutex.lock()
+	if p.nr_threads == 0 {
+		p.nr_threads = runtime.nr_cpus()
+	}
+	n := p.nr_threads
+	p.mutex.unlock()
+	return n
+}
+
+// Use `n` threads (at least 1, the calling thread) from now on
+pub fn set_threads(n int) {
+	mut p := pool
+	p.mutex.lock()
+	p.nr_threads = n
+	if n < 1 {
+		p.nr_threads = 1
+	}
+	p.work.broadcast()
+	p.mutex.unlock()
+}
+
+fn call_body(body fn (voidptr, int, int), ctx voidptr, start, end int) {
+	body(ctx, start, end)
+}
+
+// Takes the next chunk and runs it, `p.mutex` is locked before and after.
+// Returns false if there was nothing left to take.
+fn (p mut Pool) run_chunk() bool {
+	if !p.busy || p.next >= p.job_n {
+		return false
+	}
+	start := p.next
+	mut end := start + p.job_grain
+	if end > p.job_n {
+		end = p.job_n
+	}
+	p.next = end
+	body := p.job_body
+	ctx := p.job_ctx
+	p.mutex.unlock()
+	call_body(body, ctx, start, end)
+	p.mutex.lock()
+	p.left -= end - start
+	if p.left == 0 {
+		p.done.broadcast()
+	}
+	return true
+}
+
+// The worker with number `id` takes part in jobs while there are more
+// than `id + 1` threads
+fn worker(p_ &Pool, id int) {
+	mut p := p_
+	p.mutex.lock()
+	for {
+		for id + 1 >= p.nr_threads || !p.run_chunk() {
+			p.work.wait(p.mutex)
+		}
+	}
+}
+
+// A chunk size that gives each thread a few chunks
+fn grain_for(n, nr_threads int) int {
+	mut grain := n / (nr_threads * chunks_per_thread)
+	if grain < min_grain {
+		grain = min_grain
+	}
+	return grain
+}
+
+// Runs `body(ctx, start, end)` on the chunks of `[0, n)` in parallel, and
+// returns when they are all done. The calling thread runs chunks too. If
+// the pool is running another job (another thread's, or the job calling
+// this), the chunks are run on this thread.
+fn run(n, grain int, ctx voidptr, body_ voidptr) {
+	if n <= 0 {
+		return
+	}
+	b := Body{ f: body_ }
+	body := b.f
+	mut p := pool
+	p.mutex.lock()
+	if p.nr_threads == 0 {
+		p.nr_threads = runtime.nr_cpus()
+	}
+	if p.busy || p.nr_threads == 1 || n <= grain {
+		p.mutex.unlock()
+		// The same chunks, the bodies may depend on them
+		for start := 0; start < n; start += grain {
+			mut end := start + grain
+			if end > n {
+				end = n
+			}
+			call_body(body, ctx, start, end)
+		}
+		return
+	}
+	// Start the workers the first time they are needed
+	for p.nr_workers < p.nr_threads - 1 {
+		go worker(p, p.nr_workers)
+		p.nr_workers++
+	}
+	p.busy = true
+	p.job_body = body
+	p.job_ctx = ctx
+	p.job_n = n
+	p.job_grain = grain
+	p.next = 0
+	p.left = n
+	p.work.broadcast()
+	for p.run_chunk() {
+	}
+	for p.left > 0 {
+		p.done.wait(p.mutex)
+	}
+	p.busy = false
+	p.mutex.unlock()
+}
@@ -0,0 +1,282 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module parallel
+
+/*
+Parallel merge sort: the array is split into a run per thread, the runs are
+sorted at the same time with the sequential sorts of builtin, and merged in
+pairs until one is left.
+
+Each merge is split between the threads too: the output is cut into chunks,
+and where a chunk starts in each of the two runs is found with a binary
+search (the merge path), so every chunk is merged on its own.
+*/
+
+struct MergeCtx {
+	arr     array
+	compare voidptr
+	cmp     fn (voidptr, voidptr) int
+	size    int
+mut:
+	bounds  []int // run `i` is `[bounds[i], bounds[i + 1])`
+	nr_runs int
+	src     byteptr
+	dst     byteptr
+}
+
+// Splits `a` into a run per thread, or returns false if it should be sorted
+// on this thread
+fn new_merge_ctx(a array, compare voidptr) (MergeCtx, bool) {
+	threads := nr_threads()
+	mut c := MergeCtx {
+		arr: a
+		compare: compare
+		cmp: compare
+		size: a.element_size
+		nr_runs: threads
+		src: a.data
+		dst: 0
+	}
+	if a.len <= serial_cutoff || threads == 1 {
+		return c, false
+	}
+	for i := 0; i <= threads; i++ {
+		c.bounds << int(i64(a.len) * i64(i) / i64(threads))
+	}
+	return c, true
+}
+
+// The runs of the pair `p` of a round, `[start, mid)` and `[mid, end)`. The
+// last run is alone if there is an odd number of them, then `mid == end`.
+fn (c &MergeCtx) pair(p int) (int, int, int) {
+	start := c.bounds[2 * p]
+	if 2 * p + 1 >= c.nr_runs {
+		end := c.bounds[c.nr_runs]
+		return start, end, end
+	}
+	return start, c.bounds[2 * p + 1], c.bounds[2 * p + 2]
+}
+
+// After a round, each pair is a run
+fn (c mut MergeCtx) next_round() {
+	mut bounds := []int
+	for i := 0; i < c.nr_runs; i += 2 {
+		bounds << c.bounds[i]
+	}
+	bounds << c.bounds[c.nr_runs]
+	c.bounds.free()
+	c.bounds = bounds
+	c.nr_runs = (c.nr_runs + 1) / 2
+	src := c.src
+	c.src = c.dst
+	c.dst = src
+}
+
+// ===== []int =====
+
+fn sort_runs_ints(c &MergeCtx, start, end int) {
+	for r := start; r < end; r++ {
+		mut run := []int
+		run = c.arr.slice(c.bounds[r], c.bounds[r + 1])
+		run.sort()
+	}
+}
+
+// How many of the first `k` elements of the merge of `src[start..mid]` and
+// `src[mid..end]` come from the first run. On ties, the first run goes first.
+fn corank_ints(src &int, start, mid, end, k int) int {
+	mut lo := k - (end - mid)
+	if lo < 0 {
+		lo = 0
+	}
+	mut hi := k
+	if hi > mid - start {
+		hi = mid - start
+	}
+	for lo < hi {
+		i := (lo + hi) / 2
+		if src[mid + k - i - 1] < src[start + i] {
+			hi = i
+		}
+		else {
+			lo = i + 1
+		}
+	}
+	return lo
+}
+
+// Merges the chunk `[lo, hi)` of the output of the pair `[start, mid, end)`
+fn merge_ints(src, dst_ &int, start, mid, end, lo, hi int) {
+	mut dst := dst_
+	i0 := corank_ints(src, start, mid, end, lo - start)
+	i1 := corank_ints(src, start, mid, end, hi - start)
+	mut i := start + i0
+	mut j := mid + lo - start - i0
+	i_end := start + i1
+	j_end := mid + hi - start - i1
+	mut o := lo
+	for i < i_end && j < j_end {
+		if src[j] < src[i] {
+			dst[o] = src[j]
+			j++
+		}
+		else {
+			dst[o] = src[i]
+			i++
+		}
+		o++
+	}
+	for i < i_end {
+		dst[o] = src[i]
+		i++
+		o++
+	}
+	for j < j_end {
+		dst[o] = src[j]
+		j++
+		o++
+	}
+}
+
+fn merge_chunk_ints(c &MergeCtx, lo, hi int) {
+	for p := 0; 2 * p < c.nr_runs; p++ {
+		start, mid, end := c.pair(p)
+		if end <= lo || start >= hi {
+			continue
+		}
+		mut from := lo
+		if start > from {
+			from = start
+		}
+		mut to := hi
+		if end < to {
+			to = end
+		}
+		merge_ints(&int(c.src), &int(c.dst), start, mid, end, from, to)
+	}
+}
+
+// Sorts `a` like `a.sort()`, in parallel
+pub fn psort(a mut []int) {
+	mut c, ok := new_merge_ctx(array(*a), 0)
+	if !ok {
+		a.sort()
+		return
+	}
+	buf := malloc(a.len * sizeof(int))
+	c.dst = buf
+	run(c.nr_runs, 1, &c, sort_runs_ints)
+	grain := grain_for(a.len, nr_threads())
+	for c.nr_runs > 1 {
+		run(a.len, grain, &c, merge_chunk_ints)
+		c.next_round()
+	}
+	if c.src != a.data {
+		C.memcpy(a.data, c.src, a.len * sizeof(int))
+	}
+	free(buf)
+	c.bounds.free()
+}
+
+// ===== Any element type, with a compare function =====
+
+fn sort_runs(c &MergeCtx, start, end int) {
+	for r := start; r < end; r++ {
+		mut run := c.arr.slice(c.bounds[r], c.bounds[r + 1])
+		run.sort_with_compare(c.compare)
+	}
+}
+
+fn corank(cmp fn (voidptr, voidptr) int, src byteptr, size, start, mid, end, k int) int {
+	mut lo := k - (end - mid)
+	if lo < 0 {
+		lo = 0
+	}
+	mut hi := k
+	if hi > mid - start {
+		hi = mid - start
+	}
+	for lo < hi {
+		i := (lo + hi) / 2
+		if cmp(src + (mid + k - i - 1) * size, src + (start + i) * size) < 0 {
+			hi = i
+		}
+		else {
+			lo = i + 1
+		}
+	}
+	return lo
+}
+
+fn merge(cmp fn (voidptr, voidptr) int, src, dst byteptr, size, start, mid, end, lo, hi int) {
+	i0 := corank(cmp, src, size, start, mid, end, lo - start)
+	i1 := corank(cmp, src, size, start, mid, end, hi - start)
+	mut i := start + i0
+	mut j := mid + lo - start - i0
+	i_end := start + i1
+	j_end := mid + hi - start - i1
+	mut o := lo
+	for i < i_end && j < j_end {
+		if cmp(src + j * size, src + i * size) < 0 {
+			C.memcpy(dst + o * size, src + j * size, size)
+			j++
+		}
+		else {
+			C.memcpy(dst + o * size, src + i * size, size)
+			i++
+		}
+		o++
+	}
+	if i < i_end {
+		C.memcpy(dst + o * size, src + i * size, (i_end - i) * size)
+		o += i_end - i
+	}
+	if j < j_end {
+		C.memcpy(dst + o * size, src + j * size, (j_end - j) * size)
+	}
+}
+
+fn merge_chunk(c &MergeCtx, lo, hi int) {
+	for p := 0; 2 * p < c.nr_runs; p++ {
+		start, mid, end := c.pair(p)
+		if end <= lo || start >= hi {
+			continue
+		}
+		mut from := lo
+		if start > from {
+			from = start
+		}
+		mut to := hi
+		if end < to {
+			to = end
+		}
+		merge(c.cmp, c.src, c.dst, c.size, start, mid, end, from, to)
+	}
+}
+
+// Sorts the array `arr` points to like `a.sort_with_compare(compare)`, in
+// parallel: `psort_with_compare(&a, compare)`. Like it, the sort isn't
+// stable.
+pub fn psort_with_compare(arr voidptr, compare voidptr) {
+	mut a := &array(arr)
+	mut c, ok := new_merge_ctx(*a, compare)
+	if !ok {
+		a.sort_with_compare(compare)
+		return
+	}
+	buf := malloc(a.len * a.element_size)
+	c.dst = buf
+	run(c.nr_runs, 1, &c, sort_runs)
+	grain := grain_for(a.len, nr_threads())
+	for c.nr_runs > 1 {
+		run(a.len, grain, &c, merge_chunk)
+		c.next_round()
+	}
+	if c.src != a.data {
+		C.memcpy(a.data, c.src, a.len * a.element_size)
+	}
+	free(buf)
+	c.bounds.free()
+}
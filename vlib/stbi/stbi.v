@@ -29,7 +29,9 @@ pub fn load(path string) Image {
 		data: 0
 	}
 	flag := if ext == 'png' { C.STBI_rgb_alpha } else { 0 }
-	res.data = C.stbi_load(path.str, &res.width, &res.height,	&res.nr_channels, flag)
+	cpath := path.cstr()
+	res.data = C.stbi_load(cpath, &res.width, &res.height,	&res.nr_channels, flag)
+	path.free_cstr(cpath)
 	if isnil(res.data) {
 		println('stbi image failed to load')
 		exit(1)
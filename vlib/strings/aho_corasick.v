@@ -0,0 +1,298 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module strings
+
+/*
+`Replacer` and `MultiSearcher` find many patterns in a single pass over a
+string, with an Aho-Corasick automaton compiled once by `new_replacer()` or
+`new_multi_searcher()`.
+
+The automaton is a DFA: a dense table with a row per state and a column per
+byte class (each byte that is in a pattern has its own class, all the others
+share class 0), and the failure links are resolved when it's built, so
+reading a byte is always a single table lookup. In the root state, the bytes
+that can't start a pattern are skipped in a tight loop.
+
+Matches are leftmost-longest and don't overlap: of the matches that start
+first, the longest one wins (`new_replacer(['a', '1', 'ab', '2'])` replaces
+`abc` with `2c`). Empty patterns never match.
+
+Nothing is modified after it's built, so a `Replacer` or a `MultiSearcher`
+can be used by many threads at once.
+*/
+
+struct Automaton {
+	row_len      int
+	classes      []int // byte => class
+	// A row per state: the longest pattern that ends in the state (or -1),
+	// the length of the prefix the state stands for, and the next state
+	// for each class (the offset of its row). The root is the first row.
+	table        []int
+	pattern_lens []int
+}
+
+struct Replacer {
+	ac         Automaton
+	news       []string
+	min_len    int // of the patterns
+	max_growth int // the most a replacement is longer than its pattern
+}
+
+struct MultiSearcher {
+	ac Automaton
+pub:
+	patterns []string
+}
+
+struct MultiMatch {
+pub:
+	start   int
+	end     int // exclusive
+	pattern int // index in `MultiSearcher.patterns`
+}
+
+const (
+	row_out   = 0
+	row_depth = 1
+	row_trans = 2
+	max_len   = 2147483646 // of a string, leaving room for the 0
+)
+
+fn new_automaton(patterns []string) Automaton {
+	mut classes := [0].repeat(256)
+	mut nr_classes := 1
+	for p in patterns {
+		for c in p {
+			if classes[c] == 0 {
+				classes[c] = nr_classes
+				nr_classes++
+			}
+		}
+	}
+	row_len := nr_classes + row_trans
+	// The trie. -1 is a missing transition.
+	mut table := [-1].repeat(row_len)
+	table[row_depth] = 0
+	mut pattern_lens := []int
+	for i, p in patterns {
+		pattern_lens << p.len
+		if p.len == 0 {
+			continue
+		}
+		mut state := 0
+		for c in p {
+			t := state + row_trans + classes[c]
+			if table[t] < 0 {
+				table[t] = table.len
+				depth := table[state + row_depth] + 1
+				for j := 0; j < row_len; j++ {
+					table << -1
+				}
+				table[table.len - row_len + row_depth] = depth
+			}
+			state = table[t]
+		}
+		if table[state + row_out] < 0 {
+			table[state + row_out] = i
+		}
+	}
+	// Breadth first, so the failure link of a state (the longest proper
+	// suffix of its prefix that's in the trie) is done before the state.
+	// Missing transitions take the one of the failure link.
+	mut fail := [0].repeat(table.len / row_len)
+	mut queue := [0]
+	for q := 0; q < queue.len; q++ {
+		state := queue[q]
+		state_fail := fail[state / row_len]
+		for c := 0; c < nr_classes; c++ {
+			t := state + row_trans + c
+			next := table[t]
+			if next < 0 {
+				if state == 0 {
+					table[t] = 0
+				}
+				else {
+					table[t] = table[state_fail + row_trans + c]
+				}
+				continue
+			}
+			mut next_fail := 0
+			if state != 0 {
+				next_fail = table[state_fail + row_trans + c]
+			}
+			fail[next / row_len] = next_fail
+			if table[next + row_out] < 0 {
+				table[next + row_out] = table[next_fail + row_out]
+			}
+			queue << next
+		}
+	}
+	return Automaton {
+		row_len: row_len
+		classes: classes
+		table: table
+		pattern_lens: pattern_lens
+	}
+}
+
+// The leftmost-longest match in `s` at or after `start`, as
+// (start, pattern), or (-1, -1)
+[inline] fn (a &Automaton) find(s string, start int) (int, int) {
+	classes := &int(a.classes.data)
+	table := &int(a.table.data)
+	lens := &int(a.pattern_lens.data)
+	mut state := 0
+	mut match_start := -1
+	mut match_pattern := -1
+	mut i := start
+	for i < s.len {
+		if state == 0 {
+			// Skip the bytes that don't start a pattern
+			for i < s.len && table[row_trans + classes[s.str[i]]] == 0 {
+				i++
+			}
+			if i == s.len {
+				break
+			}
+		}
+		state = table[state + row_trans + classes[s.str[i]]]
+		i++
+		p := table[state + row_out]
+		if p >= 0 {
+			pos := i - lens[p]
+			if match_start < 0 || pos < match_start ||
+				(pos == match_start && lens[p] > lens[match_pattern]) {
+				match_start = pos
+				match_pattern = p
+			}
+		}
+		// Every match from now on starts after `match_start`
+		if match_start >= 0 && i - table[state + row_depth] > match_start {
+			break
+		}
+	}
+	return match_start, match_pattern
+}
+
+// `old_new` is a list of pairs: `new_replacer(['<', '&lt;', '>', '&gt;'])`
+pub fn new_replacer(old_new []string) Replacer {
+	if old_new.len % 2 != 0 {
+		panic('strings.new_replacer: odd number of strings')
+	}
+	mut olds := []string
+	mut news := []string
+	mut min_len := max_len
+	mut max_growth := 0
+	for i := 0; i < old_new.len; i += 2 {
+		old := old_new[i]
+		with := old_new[i + 1]
+		olds << old
+		news << with
+		if old.len > 0 && old.len < min_len {
+			min_len = old.len
+		}
+		if with.len - old.len > max_growth {
+			max_growth = with.len - old.len
+		}
+	}
+	return Replacer {
+		ac: new_automaton(olds)
+		news: news
+		min_len: min_len
+		max_growth: max_growth
+	}
+}
+
+// Replaces all the patterns in `s` in one pass. `s` is returned as it is
+// if nothing matches.
+pub fn (r &Replacer) replace(s string) string {
+	first, first_pattern := r.ac.find(s, 0)
+	if first < 0 {
+		return s
+	}
+	// Each match grows the string by `max_growth` bytes at most, so the
+	// result is allocated once. The pages past its end are never touched.
+	mut cap := i64(s.len)
+	if r.max_growth > 0 {
+		cap += i64(s.len / r.min_len) * i64(r.max_growth)
+		if cap > i64(max_len) {
+			cap = i64(max_len)
+		}
+	}
+	mut buf := malloc(int(cap) + 1)
+	news := &string(r.news.data)
+	lens := &int(r.ac.pattern_lens.data)
+	mut start := first
+	mut p := first_pattern
+	mut pos := 0 // in `s`
+	mut len := 0 // of the result
+	for {
+		C.memcpy(buf + len, s.str + pos, start - pos)
+		len += start - pos
+		with := news[p]
+		C.memcpy(buf + len, with.str, with.len)
+		len += with.len
+		pos = start + lens[p]
+		next, next_pattern := r.ac.find(s, pos)
+		if next < 0 {
+			break
+		}
+		start = next
+		p = next_pattern
+	}
+	C.memcpy(buf + len, s.str + pos, s.len - pos)
+	len += s.len - pos
+	buf[len] = `\0`
+	return tos(buf, len)
+}
+
+pub fn new_multi_searcher(patterns []string) MultiSearcher {
+	return MultiSearcher {
+		ac: new_automaton(patterns)
+		patterns: patterns
+	}
+}
+
+// The leftmost-longest match at or after `start`
+pub fn (m &MultiSearcher) find(s string, start int) ?MultiMatch {
+	pos, p := m.ac.find(s, start)
+	if pos < 0 {
+		return error('no match')
+	}
+	return MultiMatch {
+		start: pos
+		end: pos + m.ac.pattern_lens[p]
+		pattern: p
+	}
+}
+
+// All the matches, leftmost-longest and not overlapping
+pub fn (m &MultiSearcher) find_all(s string) []MultiMatch {
+	mut res := []MultiMatch
+	mut pos := 0
+	for {
+		start, p := m.ac.find(s, pos)
+		if start < 0 {
+			break
+		}
+		pos = start + m.ac.pattern_lens[p]
+		res << MultiMatch {
+			start: start
+			end: pos
+			pattern: p
+		}
+	}
+	return res
+}
+
+// The index of the first pattern in `s`, or -1
+pub fn (m &MultiSearcher) index(s string) int {
+	start, _ := m.ac.find(s, 0)
+	return start
+}
+
+pub fn (m &MultiSearcher) contains(s string) bool {
+	return m.index(s) >= 0
+}
@@ -0,0 +1,63 @@
+import strings
+
+fn test_replacer() {
+	r := strings.new_replacer(['&', '&amp;', '<', '&lt;', '>', '&gt;', '"', '&quot;'])
+	assert r.replace('<a href="x">b & c</a>') == '&lt;a href=&quot;x&quot;&gt;b &amp; c&lt;/a&gt;'
+	assert r.replace('nothing to escape') == 'nothing to escape'
+	assert r.replace('') == ''
+	assert r.replace('&') == '&amp;'
+	// Leftmost-longest
+	r2 := strings.new_replacer(['a', '1', 'ab', '2', 'bcd', '3'])
+	assert r2.replace('abcd') == '2cd'
+	assert r2.replace('xbcda') == 'x31'
+	r3 := strings.new_replacer(['he', 'x', 'she', 'y', 'hers', 'z'])
+	assert r3.replace('ushers') == 'uyrs'
+	assert r3.replace('hershe') == 'zx'
+	// Replacing with longer and shorter strings, and removing
+	r4 := strings.new_replacer(['secret', '', 'password=', 'password=***', ' ', ''])
+	assert r4.replace('user=bob password=hunter2 secret') == 'user=bobpassword=***hunter2'
+}
+
+fn test_replacer_same_as_replace() {
+	patterns := ['ab', 'ba', 'aab', 'x']
+	mut old_new := []string
+	for i, p in patterns {
+		old_new << p
+		old_new << '<$i>'
+	}
+	r := strings.new_replacer(old_new)
+	// Patterns that don't share bytes give the same result as chained `replace()`
+	s := 'abxxbaab'.repeat(100)
+	r2 := strings.new_replacer(['ab', '1', 'x', '2'])
+	assert r2.replace(s) == s.replace('ab', '1').replace('x', '2')
+	assert r.replace('aab') == '<2>'
+	assert r.replace('aaba') == '<2>a'
+	assert r.replace('bab') == '<1>b'
+}
+
+fn test_multi_searcher() {
+	m := strings.new_multi_searcher(['ERROR', 'WARN', 'FATAL'])
+	s := 'INFO ok\nWARN disk 90%\nERROR disk full\n'
+	assert m.contains(s)
+	assert !m.contains('INFO ok')
+	assert m.index(s) == 8
+	matches := m.find_all(s)
+	assert matches.len == 2
+	assert matches[0].pattern == 1
+	assert matches[0].start == 8
+	assert matches[0].end == 12
+	assert m.patterns[matches[1].pattern] == 'ERROR'
+	assert s.substr(matches[1].start, matches[1].end) == 'ERROR'
+	next := m.find(s, 9) or {
+		panic(err)
+	}
+	assert next.start == 22
+	assert first_after(m, s, 30) == -1
+}
+
+fn first_after(m strings.MultiSearcher, s string, start int) int {
+	res := m.find(s, start) or {
+		return -1
+	}
+	return res.start
+}
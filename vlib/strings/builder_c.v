@@ -30,12 +30,63 @@ pub fn (b mut Builder) writeln(s string) {
 	b.len += s.len + 1
 }
 
+pub fn (b mut Builder) write_byte(c byte) {
+	b.buf << c
+	b.len++
+}
+
+// write_int, write_u64 and write_f64 write like `n.str()`, without allocating
+// the string
+pub fn (b mut Builder) write_int(n int) {
+	if n < 0 {
+		b.write_byte(`-`)
+		// -n overflows for the smallest int
+		b.write_u64(u64(-i64(n)))
+		return
+	}
+	b.write_u64(u64(n))
+}
+
+pub fn (b mut Builder) write_u64(n u64) {
+	mut digits := [20]byte
+	i := write_dec(&digits[0], 20, n)
+	b.buf.push_many(&digits[i], 20 - i)
+	b.len += 20 - i
+}
+
+pub fn (b mut Builder) write_f64(d f64) {
+	mut buf := [32]byte
+	n := d.write_str(&buf[0])
+	b.buf.push_many(buf, n)
+	b.len += n
+}
+
+// Makes room for `n` more bytes, so that writing them doesn't reallocate
+pub fn (b mut Builder) reserve(n int) {
+	b.buf.reserve(n)
+}
+
+// The string shares the memory of the builder, with a 0 after it like the
+// other strings that aren't substrings
 pub fn (b Builder) str() string {
-	return string(b.buf, b.len)
+	if b.buf.cap > b.len {
+		mut data := &byte(b.buf.data)
+		data[b.len] = `\0`
+		return string(b.buf, b.len)
+	}
+	return string(b.buf, b.len).clone()
 }
 
 pub fn (b mut Builder) cut(n int) {
 	b.len -= n
+	b.buf.truncate(b.len)
+}
+
+// Empties the builder and keeps its memory for the next writes. The strings
+// returned by `str()` before share it, so they change too.
+pub fn (b mut Builder) reset() {
+	b.buf.truncate(0)
+	b.len = 0
 }
 
 pub fn (b mut Builder) free() {
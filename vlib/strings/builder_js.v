@@ -30,6 +30,31 @@ pub fn (b mut Builder) writeln(s string) {
 	b.len += s.len + 1
 }
 
+pub fn (b mut Builder) write_byte(c byte) {
+	b.buf << c
+	b.len++
+}
+
+pub fn (b mut Builder) write_int(n int) {
+	b.write(n.str())
+}
+
+pub fn (b mut Builder) write_u64(n u64) {
+	b.write(n.str())
+}
+
+pub fn (b mut Builder) write_f64(d f64) {
+	b.write(d.str())
+}
+
+pub fn (b mut Builder) reserve(n int) {
+}
+
+pub fn (b mut Builder) reset() {
+	b.buf = []byte
+	b.len = 0
+}
+
 pub fn (b Builder) str() string {
 	return string(b.buf, b.len)
 }
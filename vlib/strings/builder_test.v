@@ -13,3 +13,45 @@ fn test_sb() {
 	assert sb.str() == 'ab'
 }
 
+fn test_typed_writes() {
+	mut sb := strings.new_builder(4)
+	sb.write_int(0)
+	sb.write_byte(` `)
+	sb.write_int(-123)
+	sb.write_byte(` `)
+	sb.write_int(-2147483648)
+	sb.write_byte(` `)
+	sb.write_u64(u64(18446744073709551615))
+	sb.write_byte(` `)
+	sb.write_f64(1.5)
+	sb.write_byte(` `)
+	sb.write_f64(0.1)
+	sb.write_byte(` `)
+	sb.write_f64('-1e300'.f64())
+	assert sb.str() == '0 -123 -2147483648 18446744073709551615 1.5 0.1 -1e+300'
+	assert sb.len == sb.str().len
+}
+
+fn test_reserve_reset_cut() {
+	mut sb := strings.new_builder(0)
+	sb.reserve(100)
+	for i := 0; i < 10; i++ {
+		sb.write('0123456789')
+	}
+	assert sb.len == 100
+	sb.cut(5)
+	sb.write('abc')
+	assert sb.len == 98
+	assert sb.str().ends_with('01234abc')
+	sb.reset()
+	assert sb.len == 0
+	sb.writeln('x')
+	assert sb.str() == 'x\n'
+}
+
+fn test_empty() {
+	sb := strings.new_builder(0)
+	assert sb.str() == ''
+	buf := []byte
+	assert string(buf, 0) == ''
+}
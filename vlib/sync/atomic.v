@@ -0,0 +1,135 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+/*
+Atomic integers and pointers, for counters and flags shared by threads
+without a lock. All the operations are sequentially consistent. They use
+the `__atomic` builtins of GCC and Clang. tcc has none, there they are
+defined with a lock in the C headers the compiler adds.
+
+	mut hits := sync.AtomicInt{}
+	hits.fetch_add(1) // in each thread
+	println(hits.load())
+*/
+
+struct AtomicInt {
+mut:
+	val int
+}
+
+struct AtomicU64 {
+mut:
+	val u64
+}
+
+struct AtomicPtr {
+mut:
+	val voidptr
+}
+
+// `C.__atomic_load_n()`, `C.__atomic_exchange_n()` and `C.__atomic_fetch_add()`
+// are declared in builtin, with the widest type so that casts of their
+// results are plain C casts
+
+// The operations on plain ints and u64s the other types of this module are
+// built on. They return the value before the operation, like the methods.
+
+fn atomic_load(p &int) int {
+	return int(C.__atomic_load_n(p, C.__ATOMIC_SEQ_CST))
+}
+
+fn atomic_store(p &int, v int) {
+	C.__atomic_store_n(p, v, C.__ATOMIC_SEQ_CST)
+}
+
+fn atomic_swap(p &int, v int) int {
+	return int(C.__atomic_exchange_n(p, v, C.__ATOMIC_SEQ_CST))
+}
+
+fn atomic_cas(p &int, old, new int) bool {
+	expected := old
+	return C.__atomic_compare_exchange_n(p, &expected, new, false, C.__ATOMIC_SEQ_CST,
+		C.__ATOMIC_SEQ_CST)
+}
+
+fn atomic_add(p &int, d int) int {
+	return int(C.__atomic_fetch_add(p, d, C.__ATOMIC_SEQ_CST))
+}
+
+fn atomic_load_u64(p &u64) u64 {
+	return C.__atomic_load_n(p, C.__ATOMIC_SEQ_CST)
+}
+
+fn atomic_store_u64(p &u64, v u64) {
+	C.__atomic_store_n(p, v, C.__ATOMIC_SEQ_CST)
+}
+
+fn atomic_cas_u64(p &u64, old, new u64) bool {
+	expected := old
+	return C.__atomic_compare_exchange_n(p, &expected, new, false, C.__ATOMIC_SEQ_CST,
+		C.__ATOMIC_SEQ_CST)
+}
+
+pub fn (a &AtomicInt) load() int {
+	return atomic_load(&a.val)
+}
+
+pub fn (a &AtomicInt) store(v int) {
+	atomic_store(&a.val, v)
+}
+
+// Sets the value to `v`, and returns the old one
+pub fn (a &AtomicInt) swap(v int) int {
+	return atomic_swap(&a.val, v)
+}
+
+// Sets the value to `new` if it is `old`, and tells if it was
+pub fn (a &AtomicInt) cas(old, new int) bool {
+	return atomic_cas(&a.val, old, new)
+}
+
+// Adds `d` to the value, and returns the old one
+pub fn (a &AtomicInt) fetch_add(d int) int {
+	return atomic_add(&a.val, d)
+}
+
+pub fn (a &AtomicU64) load() u64 {
+	return atomic_load_u64(&a.val)
+}
+
+pub fn (a &AtomicU64) store(v u64) {
+	atomic_store_u64(&a.val, v)
+}
+
+pub fn (a &AtomicU64) swap(v u64) u64 {
+	return u64(C.__atomic_exchange_n(&a.val, v, C.__ATOMIC_SEQ_CST))
+}
+
+pub fn (a &AtomicU64) cas(old, new u64) bool {
+	return atomic_cas_u64(&a.val, old, new)
+}
+
+pub fn (a &AtomicU64) fetch_add(d u64) u64 {
+	return u64(C.__atomic_fetch_add(&a.val, d, C.__ATOMIC_SEQ_CST))
+}
+
+pub fn (a &AtomicPtr) load() voidptr {
+	return voidptr(C.__atomic_load_n(&a.val, C.__ATOMIC_SEQ_CST))
+}
+
+pub fn (a &AtomicPtr) store(v voidptr) {
+	C.__atomic_store_n(&a.val, v, C.__ATOMIC_SEQ_CST)
+}
+
+pub fn (a &AtomicPtr) swap(v voidptr) voidptr {
+	return voidptr(C.__atomic_exchange_n(&a.val, v, C.__ATOMIC_SEQ_CST))
+}
+
+pub fn (a &AtomicPtr) cas(old, new voidptr) bool {
+	expected := old
+	return C.__atomic_compare_exchange_n(&a.val, &expected, new, false, C.__ATOMIC_SEQ_CST,
+		C.__ATOMIC_SEQ_CST)
+}
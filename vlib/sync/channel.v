@@ -0,0 +1,418 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+/*
+Channels pass values from threads to threads, like Go's `chan`. The values
+of a channel have `elem_size` bytes, and are copied in and out:
+
+	ch := sync.new_channel(100, sizeof(Job))
+	// producers
+	ch.push(&job)
+	ch.close() // when they are all done
+	// consumers
+	job := Job{}
+	for ch.pop(&job) {
+		...
+	}
+
+A buffered channel is a ring of `cap` slots that any number of threads
+push to and pop from without a lock (Dmitry Vyukov's bounded MPMC queue).
+A thread claims a position with a CAS on `push_pos` or `pop_pos`, and the
+sequence number of the slot tells if it is its turn: the slot of position
+`pos` is free for a push when its number is `pos`, and holds a value for
+a pop when it is `pos + 1`. Threads only sleep, on a futex, when the
+channel is full or empty.
+
+The numbers of a ring of one slot would be the same for both, so channels
+of `cap` 0 and 1 have two slots, and a push checks that the ring is empty.
+An unbuffered channel (`cap` 0) holds one value, and `push()` also waits
+for a `pop()` to take it. `receivers` counts the threads that wait in
+`pop()` or `select_pop()` on the channel, so that `try_push()` only hands a
+value over when one of them can take it. When they all leave without
+taking it, it takes the value back itself.
+
+Waking up: a thread that is about to sleep counts itself in `pop_waiting`
+(or `push_waiting`) first, then reads the futex value, then checks the
+ring again. A thread that changes the ring checks the count after, and if
+it isn't 0, sets it to 0, changes the futex value and wakes all the
+threads that sleep on it. One of the two sees the other. Only the first
+change after a thread counts itself makes a system call, and threads
+count themselves again each time they are about to sleep. A count can be
+left over by a thread that didn't sleep, which only costs a wake-up for
+nothing. Waking up fewer threads than were counted isn't enough: a thread
+that counted itself after the count was set to 0 can take the place of
+one that is still asleep.
+*/
+
+// What a channel shares between threads
+struct ChannelState {
+	elem_size int
+	cap       int
+	nr_slots  int
+	seqs      &u64
+	data      byteptr
+mut:
+	push_pos     u64
+	pad1         [56]byte // `push_pos` and `pop_pos` are written by
+	pop_pos      u64      // different threads, in different cache lines
+	pad2         [56]byte
+	pushes       int // the futex pops sleep on, changed by pushes and close()
+	pops         int // the futex pushes sleep on
+	pop_waiting  int
+	push_waiting int
+	receivers    int // exact, unlike `pop_waiting`
+	closed       int
+}
+
+// Wakes up `select_pop()`, which can wait for any channel
+struct Selects {
+mut:
+	events  int
+	waiting int
+	next    int // the channel it tries first, so they all get a turn
+}
+
+const (
+	selects = &Selects{}
+)
+
+// A channel is a handle to its state, copies of it are the same channel
+struct Channel {
+	state &ChannelState
+}
+
+pub fn new_channel(cap, elem_size int) Channel {
+	mut nr_slots := cap
+	if cap < 2 {
+		nr_slots = 2
+	}
+	mut seqs := &u64(calloc(nr_slots * sizeof(u64)))
+	for i := 0; i < nr_slots; i++ {
+		seqs[i] = u64(i)
+	}
+	state := &ChannelState{
+		elem_size: elem_size
+		cap: cap
+		nr_slots: nr_slots
+		seqs: seqs
+		data: calloc(nr_slots * elem_size)
+	}
+	return Channel{state}
+}
+
+// Copies `val` to the channel, and waits while it's full. For an unbuffered
+// channel, it waits until a `pop()` takes it.
+pub fn (c Channel) push(val voidptr) {
+	c.state.push(val)
+}
+
+// Copies `val` to the channel if there is room, and tells if there was. For
+// an unbuffered channel, there is room when a thread waits in `pop()` or
+// `select_pop()` on it, and it returns when that thread has the value. If
+// the threads leave without taking it, it doesn't push the value.
+pub fn (c Channel) try_push(val voidptr) bool {
+	return c.state.try_push(val)
+}
+
+// Copies the oldest value of the channel to `val`, and waits while it's
+// empty. Returns false when the channel is empty and closed.
+pub fn (c Channel) pop(val voidptr) bool {
+	return c.state.pop(val)
+}
+
+// Copies the oldest value of the channel to `val` if there is one, and
+// tells if there was
+pub fn (c Channel) try_pop(val voidptr) bool {
+	return c.state.dequeue(val)
+}
+
+// The number of values in the channel. Other threads can change it right
+// after.
+pub fn (c Channel) len() int {
+	return c.state.len()
+}
+
+// No more values can be pushed. `pop()` returns the ones that are left,
+// then false.
+pub fn (c Channel) close() {
+	c.state.close()
+}
+
+pub fn (c Channel) is_closed() bool {
+	return c.state.is_closed()
+}
+
+pub fn (c Channel) free() {
+	c.state.free()
+}
+
+fn (c &ChannelState) free() {
+	free(c.seqs)
+	free(c.data)
+	free(c)
+}
+
+fn (c &ChannelState) seq(pos u64) &u64 {
+	return &u64(&byte(c.seqs) + int(pos % u64(c.nr_slots)) * sizeof(u64))
+}
+
+fn (c &ChannelState) slot(pos u64) byteptr {
+	return c.data + int(pos % u64(c.nr_slots)) * c.elem_size
+}
+
+// Copies `val` to the next free slot. Returns its position, or -1 if the
+// channel is full.
+fn (c &ChannelState) enqueue(val voidptr) i64 {
+	mut pos := atomic_load_u64(&c.push_pos)
+	for {
+		seq := atomic_load_u64(c.seq(pos))
+		if seq == pos {
+			if c.cap < 2 && i64(pos - atomic_load_u64(&c.pop_pos)) > i64(0) {
+				return i64(-1)
+			}
+			if atomic_cas_u64(&c.push_pos, pos, pos + u64(1)) {
+				break
+			}
+		}
+		else if i64(seq - pos) < i64(0) {
+			return i64(-1)
+		}
+		pos = atomic_load_u64(&c.push_pos)
+	}
+	C.memcpy(c.slot(pos), val, c.elem_size)
+	atomic_store_u64(c.seq(pos), pos + u64(1))
+	wake(&c.pop_waiting, &c.pushes)
+	sel := selects
+	wake(&sel.waiting, &sel.events)
+	return i64(pos)
+}
+
+// Copies the oldest value to `val`, if there is one
+fn (c &ChannelState) dequeue(val voidptr) bool {
+	mut pos := atomic_load_u64(&c.pop_pos)
+	for {
+		seq := atomic_load_u64(c.seq(pos))
+		if seq == pos + u64(1) {
+			if atomic_cas_u64(&c.pop_pos, pos, pos + u64(1)) {
+				break
+			}
+		}
+		else if i64(seq - (pos + u64(1))) < i64(0) {
+			return false
+		}
+		pos = atomic_load_u64(&c.pop_pos)
+	}
+	C.memcpy(val, c.slot(pos), c.elem_size)
+	atomic_store_u64(c.seq(pos), pos + u64(c.nr_slots))
+	wake(&c.push_waiting, &c.pops)
+	return true
+}
+
+// Wakes up the threads that sleep on `futex`, if `waiting` counts any
+fn wake(waiting, futex &int) {
+	if atomic_load(waiting) == 0 || atomic_swap(waiting, 0) == 0 {
+		return
+	}
+	atomic_add(futex, 1)
+	futex_wake(futex, all_waiters)
+}
+
+fn (c &ChannelState) push(val voidptr) {
+	for {
+		if atomic_load(&c.closed) != 0 {
+			panic('sync.Channel: push() on a closed channel')
+		}
+		pos := c.enqueue(val)
+		if pos >= i64(0) {
+			if c.cap == 0 {
+				c.wait_taken(u64(pos))
+			}
+			return
+		}
+		atomic_add(&c.push_waiting, 1)
+		ev := atomic_load(&c.pops)
+		if atomic_load(&c.closed) == 0 && c.is_full() {
+			futex_wait(&c.pops, ev)
+		}
+	}
+}
+
+fn (c &ChannelState) is_full() bool {
+	pos := atomic_load_u64(&c.push_pos)
+	if c.cap < 2 {
+		return i64(pos - atomic_load_u64(&c.pop_pos)) > i64(0)
+	}
+	return i64(atomic_load_u64(c.seq(pos)) - pos) < i64(0)
+}
+
+fn (c &ChannelState) wait_taken(pos u64) {
+	for atomic_load_u64(&c.pop_pos) <= pos {
+		atomic_add(&c.push_waiting, 1)
+		ev := atomic_load(&c.pops)
+		if atomic_load_u64(&c.pop_pos) > pos || atomic_load(&c.closed) != 0 {
+			return
+		}
+		futex_wait(&c.pops, ev)
+	}
+}
+
+fn (c &ChannelState) try_push(val voidptr) bool {
+	if atomic_load(&c.closed) != 0 {
+		return false
+	}
+	if c.cap == 0 && atomic_load(&c.receivers) == 0 {
+		return false
+	}
+	pos := c.enqueue(val)
+	if pos < i64(0) {
+		return false
+	}
+	if c.cap == 0 {
+		return c.wait_taken_or_withdraw(u64(pos))
+	}
+	return true
+}
+
+// Waits while a receiver can take the value at `pos`, and takes it back when
+// none is left. Tells if a receiver took it.
+fn (c &ChannelState) wait_taken_or_withdraw(pos u64) bool {
+	for {
+		if atomic_load_u64(&c.pop_pos) > pos {
+			return true
+		}
+		atomic_add(&c.push_waiting, 1)
+		ev := atomic_load(&c.pops)
+		if atomic_load_u64(&c.pop_pos) > pos {
+			return true
+		}
+		if atomic_load(&c.receivers) == 0 || atomic_load(&c.closed) != 0 {
+			if !atomic_cas_u64(&c.pop_pos, pos, pos + u64(1)) {
+				// A receiver was quicker
+				return true
+			}
+			atomic_store_u64(c.seq(pos), pos + u64(c.nr_slots))
+			wake(&c.push_waiting, &c.pops)
+			return false
+		}
+		futex_wait(&c.pops, ev)
+	}
+	return false
+}
+
+// A receiver leaves the channel. The last one wakes up `try_push()`, which
+// can be waiting for it.
+fn (c &ChannelState) leave() {
+	if atomic_add(&c.receivers, -1) == 1 {
+		wake(&c.push_waiting, &c.pops)
+	}
+}
+
+fn (c &ChannelState) pop(val voidptr) bool {
+	if c.dequeue(val) {
+		return true
+	}
+	atomic_add(&c.receivers, 1)
+	ok := c.wait_pop(val)
+	c.leave()
+	return ok
+}
+
+fn (c &ChannelState) wait_pop(val voidptr) bool {
+	for {
+		if c.dequeue(val) {
+			return true
+		}
+		atomic_add(&c.pop_waiting, 1)
+		ev := atomic_load(&c.pushes)
+		if c.dequeue(val) {
+			return true
+		}
+		if atomic_load(&c.closed) != 0 {
+			// A value can have been pushed right before `close()`
+			return c.dequeue(val)
+		}
+		futex_wait(&c.pushes, ev)
+	}
+	return false
+}
+
+fn (c &ChannelState) len() int {
+	n := i64(atomic_load_u64(&c.push_pos) - atomic_load_u64(&c.pop_pos))
+	if n < i64(0) {
+		return 0
+	}
+	return int(n)
+}
+
+fn (c &ChannelState) close() {
+	if atomic_swap(&c.closed, 1) != 0 {
+		panic('sync.Channel: close() of a closed channel')
+	}
+	atomic_add(&c.pushes, 1)
+	atomic_add(&c.pops, 1)
+	futex_wake(&c.pushes, all_waiters)
+	futex_wake(&c.pops, all_waiters)
+	sel := selects
+	atomic_add(&sel.events, 1)
+	futex_wake(&sel.events, all_waiters)
+}
+
+fn (c &ChannelState) is_closed() bool {
+	return atomic_load(&c.closed) != 0
+}
+
+// Pops a value from the first of `chans` that has one, like Go's `select`
+// with a receive in each case. Copies it to `val`, which must have room for
+// the values of all the channels, and returns the index of the channel.
+// Waits while they are all empty, and returns -1 when they are all empty
+// and closed.
+pub fn select_pop(chans []Channel, val voidptr) int {
+	if chans.len == 0 {
+		return -1
+	}
+	i := select_pop_from(chans, val)
+	for ch in chans {
+		ch.state.leave()
+	}
+	return i
+}
+
+// Counts itself as a receiver of each channel, `select_pop()` leaves them
+fn select_pop_from(chans []Channel, val voidptr) int {
+	for ch in chans {
+		atomic_add(&ch.state.receivers, 1)
+	}
+	sel := selects
+	start := (atomic_add(&sel.next, 1) & 0x7fffffff) % chans.len
+	mut ev := 0
+	mut can_sleep := false
+	for {
+		mut nr_closed := 0
+		for j := 0; j < chans.len; j++ {
+			i := (start + j) % chans.len
+			c := chans[i].state
+			closed := c.is_closed()
+			if c.dequeue(val) {
+				return i
+			}
+			if closed {
+				nr_closed++
+			}
+		}
+		if nr_closed == chans.len {
+			return -1
+		}
+		if can_sleep {
+			futex_wait(&sel.events, ev)
+		}
+		// Counted before the next look at the channels, which is the one
+		// that can sleep
+		atomic_add(&sel.waiting, 1)
+		ev = atomic_load(&sel.events)
+		can_sleep = true
+	}
+	return -1
+}
@@ -0,0 +1,145 @@
+import sync
+
+const (
+	nr_values = 10000
+)
+
+struct Msg {
+	from int
+	n    int
+}
+
+fn produce(ch sync.Channel, from int, wg &sync.WaitGroup) {
+	for i := 0; i < nr_values; i++ {
+		m := Msg{from, i}
+		ch.push(&m)
+	}
+	wg.done()
+}
+
+fn close_when_done(ch sync.Channel, wg &sync.WaitGroup) {
+	wg.wait()
+	ch.close()
+}
+
+// Each producer's values arrive in order, and they all arrive once
+fn check_channel(cap, nr_producers int) {
+	ch := sync.new_channel(cap, sizeof(Msg))
+	wg := &sync.WaitGroup{}
+	wg.add(nr_producers)
+	for i := 0; i < nr_producers; i++ {
+		go produce(ch, i, wg)
+	}
+	go close_when_done(ch, wg)
+	mut next := [0].repeat(nr_producers)
+	m := Msg{}
+	for ch.pop(&m) {
+		assert m.n == next[m.from]
+		next[m.from] = m.n + 1
+	}
+	for n in next {
+		assert n == nr_values
+	}
+	assert ch.len() == 0
+}
+
+fn test_buffered() {
+	check_channel(16, 1)
+	check_channel(16, 4)
+	check_channel(1, 3)
+}
+
+fn test_unbuffered() {
+	check_channel(0, 1)
+	check_channel(0, 3)
+}
+
+fn test_try() {
+	ch := sync.new_channel(2, sizeof(int))
+	mut x := 1
+	assert ch.try_push(&x)
+	x = 2
+	assert ch.try_push(&x)
+	assert !ch.try_push(&x)
+	assert ch.len() == 2
+	y := 0
+	assert ch.try_pop(&y)
+	assert y == 1
+	ch.close()
+	assert ch.is_closed()
+	assert ch.pop(&y)
+	assert y == 2
+	assert !ch.pop(&y)
+	assert !ch.try_pop(&y)
+	unbuffered := sync.new_channel(0, sizeof(int))
+	assert !unbuffered.try_push(&x)
+}
+
+fn select_one(ch sync.Channel, wg &sync.WaitGroup) {
+	x := 0
+	sync.select_pop([ch], &x)
+	wg.done()
+}
+
+// A receiver of another channel doesn't take the value of an unbuffered
+// channel, try_push() fails instead of waiting for one
+fn test_try_push_unbuffered() {
+	other := sync.new_channel(0, sizeof(int))
+	wg := &sync.WaitGroup{}
+	wg.add(1)
+	go select_one(other, wg)
+	ch := sync.new_channel(0, sizeof(int))
+	mut x := 1
+	for i := 0; i < 100; i++ {
+		assert !ch.try_push(&x)
+	}
+	assert ch.len() == 0
+	other.close()
+	wg.wait()
+	// It succeeds once a receiver waits on the channel
+	res := sync.new_channel(1, sizeof(int))
+	go pop_one(ch, res)
+	x = 2
+	for !ch.try_push(&x) {
+	}
+	y := 0
+	assert res.pop(&y)
+	assert y == 2
+}
+
+fn pop_one(ch, res sync.Channel) {
+	x := 0
+	ch.pop(&x)
+	res.push(&x)
+}
+
+fn test_select_pop() {
+	a := sync.new_channel(10, sizeof(int))
+	b := sync.new_channel(0, sizeof(int))
+	wga := &sync.WaitGroup{}
+	wga.add(1)
+	go produce_ints(a, wga)
+	go close_when_done(a, wga)
+	wgb := &sync.WaitGroup{}
+	wgb.add(1)
+	go produce_ints(b, wgb)
+	go close_when_done(b, wgb)
+	mut sums := [0, 0]
+	x := 0
+	for {
+		i := sync.select_pop([a, b], &x)
+		if i < 0 {
+			break
+		}
+		sums[i] += x
+	}
+	assert sums[0] == nr_values * (nr_values - 1) / 2
+	assert sums[1] == sums[0]
+}
+
+fn produce_ints(ch sync.Channel, wg &sync.WaitGroup) {
+	for i := 0; i < nr_values; i++ {
+		ch.push(&i)
+	}
+	wg.done()
+}
@@ -0,0 +1,19 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+// Sleeps until `futex_wake()` is called for `addr`, unless `*addr` isn't
+// `val` anymore. It can also return for no reason, so callers check again.
+fn futex_wait(addr &int, val int) {
+	C.syscall(C.SYS_futex, addr, C.FUTEX_WAIT_PRIVATE, val, 0, 0, 0)
+}
+
+// Wakes up to `n` of the threads sleeping in `futex_wait(addr, ...)`
+fn futex_wake(addr &int, n int) {
+	C.syscall(C.SYS_futex, addr, C.FUTEX_WAKE_PRIVATE, n, 0, 0, 0)
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+#include <pthread.h>
+
+// macOS has no futex: all the threads that wait sleep on one condition
+// variable, and each wake-up wakes them all, to check their values again.
+// `C.pthread_mutex_t` and `C.pthread_cond_t` are declared in builtin.
+struct Parking {
+	mutex C.pthread_mutex_t
+	cond  C.pthread_cond_t
+}
+
+fn new_parking() &Parking {
+	p := &Parking{}
+	C.pthread_mutex_init(&p.mutex, 0)
+	C.pthread_cond_init(&p.cond, 0)
+	return p
+}
+
+const (
+	parking = new_parking()
+)
+
+fn futex_wait(addr &int, val int) {
+	p := parking
+	C.pthread_mutex_lock(&p.mutex)
+	if atomic_load(addr) == val {
+		C.pthread_cond_wait(&p.cond, &p.mutex)
+	}
+	C.pthread_mutex_unlock(&p.mutex)
+}
+
+fn futex_wake(addr &int, n int) {
+	p := parking
+	C.pthread_mutex_lock(&p.mutex)
+	C.pthread_cond_broadcast(&p.cond)
+	C.pthread_mutex_unlock(&p.mutex)
+}
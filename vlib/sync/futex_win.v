@@ -0,0 +1,21 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+#flag windows -lsynchronization
+
+fn futex_wait(addr &int, val int) {
+	expected := val
+	C.WaitOnAddress(addr, &expected, sizeof(int), C.INFINITE)
+}
+
+fn futex_wake(addr &int, n int) {
+	if n == 1 {
+		C.WakeByAddressSingle(addr)
+	}
+	else {
+		C.WakeByAddressAll(addr)
+	}
+}
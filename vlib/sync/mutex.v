@@ -0,0 +1,114 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+/*
+Locks on futexes: taking and releasing a lock that no other thread wants
+is one atomic operation, without a system call. The zero values are
+unlocked, so they need no init:
+
+	mut m := &sync.Mutex{}
+	m.lock()
+	...
+	m.unlock()
+
+Threads share them by pointer, copies are separate locks.
+*/
+
+const (
+	spins       = 100 // before sleeping in `lock()`
+	all_waiters = 0x7fffffff
+)
+
+struct Mutex {
+mut:
+	state int // 0 unlocked, 1 locked, 2 locked and other threads wait
+}
+
+pub fn (m &Mutex) lock() {
+	if atomic_cas(&m.state, 0, 1) {
+		return
+	}
+	// The thread that has it may release it soon
+	for i := 0; i < spins; i++ {
+		if atomic_load(&m.state) == 0 && atomic_cas(&m.state, 0, 1) {
+			return
+		}
+	}
+	// Marks it as wanted, then sleeps until it's free. It stays marked when
+	// it's taken this way, as there can be other threads waiting.
+	for atomic_swap(&m.state, 2) != 0 {
+		futex_wait(&m.state, 2)
+	}
+}
+
+// Takes it if it's free, and tells if it was
+pub fn (m &Mutex) try_lock() bool {
+	return atomic_cas(&m.state, 0, 1)
+}
+
+pub fn (m &Mutex) unlock() {
+	if atomic_swap(&m.state, 0) == 2 {
+		futex_wake(&m.state, 1)
+	}
+}
+
+// A lock that many readers, or one writer, can hold. Writers that wait go
+// first: new readers wait for them.
+struct RwMutex {
+mut:
+	state   int // the readers that have it, or -1 when a writer has it
+	writers int // writers that want it
+	waiting int // threads that sleep on `state`
+}
+
+pub fn (m &RwMutex) rlock() {
+	for {
+		s := atomic_load(&m.state)
+		if s >= 0 && atomic_load(&m.writers) == 0 {
+			if atomic_cas(&m.state, s, s + 1) {
+				return
+			}
+			continue
+		}
+		m.wait(s)
+	}
+}
+
+pub fn (m &RwMutex) runlock() {
+	if atomic_add(&m.state, -1) == 1 && atomic_load(&m.waiting) > 0 {
+		futex_wake(&m.state, all_waiters)
+	}
+}
+
+pub fn (m &RwMutex) lock() {
+	if atomic_cas(&m.state, 0, -1) {
+		return
+	}
+	atomic_add(&m.writers, 1)
+	for !atomic_cas(&m.state, 0, -1) {
+		s := atomic_load(&m.state)
+		if s != 0 {
+			m.wait(s)
+		}
+	}
+	atomic_add(&m.writers, -1)
+}
+
+pub fn (m &RwMutex) unlock() {
+	atomic_store(&m.state, 0)
+	if atomic_load(&m.waiting) > 0 {
+		futex_wake(&m.state, all_waiters)
+	}
+}
+
+// Sleeps until `state` changes from `s`. Whoever changes `state` counts
+// `waiting` after it, so it can't miss this thread: either it sees it, or
+// `state` has changed before `futex_wait()` checks it.
+fn (m &RwMutex) wait(s int) {
+	atomic_add(&m.waiting, 1)
+	futex_wait(&m.state, s)
+	atomic_add(&m.waiting, -1)
+}
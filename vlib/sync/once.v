@@ -0,0 +1,33 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+const (
+	once_todo    = 0
+	once_running = 1
+	once_done    = 2
+)
+
+// Runs a function once, for the first thread that asks, e.g. to init
+// something shared lazily. The others wait until it has run.
+struct Once {
+mut:
+	state int
+}
+
+pub fn (o &Once) run(f fn ()) {
+	if atomic_load(&o.state) == once_done {
+		return
+	}
+	if atomic_cas(&o.state, once_todo, once_running) {
+		f()
+		atomic_store(&o.state, once_done)
+		futex_wake(&o.state, all_waiters)
+		return
+	}
+	for atomic_load(&o.state) != once_done {
+		futex_wait(&o.state, once_running)
+	}
+}
@@ -0,0 +1,48 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+// A counter of free resources: `wait()` takes one, and sleeps until there
+// is one, `post()` gives one back.
+struct Semaphore {
+mut:
+	count   int
+	waiting int
+}
+
+pub fn new_semaphore(count int) &Semaphore {
+	return &Semaphore{
+		count: count
+	}
+}
+
+pub fn (s &Semaphore) post() {
+	atomic_add(&s.count, 1)
+	if atomic_load(&s.waiting) > 0 {
+		futex_wake(&s.count, 1)
+	}
+}
+
+pub fn (s &Semaphore) wait() {
+	for !s.try_wait() {
+		atomic_add(&s.waiting, 1)
+		futex_wait(&s.count, 0)
+		atomic_add(&s.waiting, -1)
+	}
+}
+
+// Takes one if there is one, and tells if there was
+pub fn (s &Semaphore) try_wait() bool {
+	for {
+		count := atomic_load(&s.count)
+		if count <= 0 {
+			return false
+		}
+		if atomic_cas(&s.count, count, count - 1) {
+			return true
+		}
+	}
+	return false
+}
@@ -0,0 +1,117 @@
+import sync
+
+const (
+	nr_threads = 4
+	nr_incs    = 10000
+)
+
+struct Counter {
+mut:
+	n     int
+	m     int // changed with `n` under `rw`
+	mutex sync.Mutex
+	rw    sync.RwMutex
+	hits  sync.AtomicInt
+	big   sync.AtomicU64
+}
+
+fn inc_locked(c &Counter, wg &sync.WaitGroup) {
+	for i := 0; i < nr_incs; i++ {
+		c.mutex.lock()
+		c.n++
+		c.mutex.unlock()
+	}
+	wg.done()
+}
+
+fn test_mutex_wait_group() {
+	c := &Counter{}
+	wg := &sync.WaitGroup{}
+	wg.add(nr_threads)
+	for i := 0; i < nr_threads; i++ {
+		go inc_locked(c, wg)
+	}
+	wg.wait()
+	assert c.n == nr_threads * nr_incs
+	assert c.mutex.try_lock()
+	assert !c.mutex.try_lock()
+	c.mutex.unlock()
+}
+
+fn inc_atomic(c &Counter, wg &sync.WaitGroup) {
+	for i := 0; i < nr_incs; i++ {
+		c.hits.fetch_add(1)
+		c.big.fetch_add(u64(1) << u64(32))
+	}
+	wg.done()
+}
+
+fn test_atomics() {
+	c := &Counter{}
+	wg := &sync.WaitGroup{}
+	wg.add(nr_threads)
+	for i := 0; i < nr_threads; i++ {
+		go inc_atomic(c, wg)
+	}
+	wg.wait()
+	assert c.hits.load() == nr_threads * nr_incs
+	assert c.big.load() == u64(nr_threads * nr_incs) << u64(32)
+	assert c.hits.cas(nr_threads * nr_incs, 7)
+	assert !c.hits.cas(nr_threads * nr_incs, 8)
+	assert c.hits.swap(9) == 7
+	c.hits.store(3)
+	assert c.hits.load() == 3
+	p := sync.AtomicPtr{}
+	assert p.load() == voidptr(0)
+	assert p.cas(voidptr(0), c)
+	assert p.load() == voidptr(c)
+}
+
+fn inc_rw(c &Counter, wg &sync.WaitGroup) {
+	for i := 0; i < nr_incs; i++ {
+		if i % 10 == 0 {
+			c.rw.lock()
+			c.n++
+			c.m++
+			c.rw.unlock()
+		}
+		else {
+			c.rw.rlock()
+			if c.n != c.m {
+				panic('a reader and a writer have the lock')
+			}
+			c.rw.runlock()
+		}
+	}
+	wg.done()
+}
+
+fn test_rw_mutex() {
+	c := &Counter{}
+	wg := &sync.WaitGroup{}
+	wg.add(nr_threads)
+	for i := 0; i < nr_threads; i++ {
+		go inc_rw(c, wg)
+	}
+	wg.wait()
+	assert c.n == nr_threads * nr_incs / 10
+}
+
+fn init_once() {
+	println('init')
+}
+
+fn test_once() {
+	o := sync.Once{}
+	o.run(init_once)
+	o.run(init_once)
+}
+
+fn test_semaphore() {
+	s := sync.new_semaphore(2)
+	assert s.try_wait()
+	s.wait()
+	assert !s.try_wait()
+	s.post()
+	assert s.try_wait()
+}
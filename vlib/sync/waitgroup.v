@@ -0,0 +1,47 @@
+// Copyright (c) 2019 Alexander Medvednikov. All rights reserved.
+// Use of this source code is governed by an MIT license
+// that can be found in the LICENSE file.
+
+module sync
+
+// Waits for a number of threads to finish, which `go` can't do by itself:
+//
+//	mut wg := &sync.WaitGroup{}
+//	wg.add(nr_jobs)
+//	for i := 0; i < nr_jobs; i++ {
+//		go job(i, wg) // calls `wg.done()` at the end
+//	}
+//	wg.wait()
+struct WaitGroup {
+mut:
+	count   int
+	waiting int
+}
+
+// Adds `n` to the number of threads to wait for
+pub fn (wg &WaitGroup) add(n int) {
+	count := atomic_add(&wg.count, n) + n
+	if count < 0 {
+		panic('sync.WaitGroup: more done() than add()')
+	}
+	if count == 0 && atomic_load(&wg.waiting) > 0 {
+		futex_wake(&wg.count, all_waiters)
+	}
+}
+
+pub fn (wg &WaitGroup) done() {
+	wg.add(-1)
+}
+
+// Returns when the number of threads to wait for is 0
+pub fn (wg &WaitGroup) wait() {
+	for {
+		count := atomic_load(&wg.count)
+		if count == 0 {
+			return
+		}
+		atomic_add(&wg.waiting, 1)
+		futex_wait(&wg.count, count)
+		atomic_add(&wg.waiting, -1)
+	}
+}